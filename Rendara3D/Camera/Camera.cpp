@@ -20,6 +20,11 @@ glm::mat4 Camera::getViewMatrix() const
 	return glm::lookAt(m_eye, m_center, m_up);
 }
 
+Frustum Camera::getFrustum(const glm::mat4& projection) const
+{
+	return Frustum{ projection * getViewMatrix() };
+}
+
 
 void Camera::processCommands(Window& window)
 {
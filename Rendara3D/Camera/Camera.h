@@ -2,6 +2,7 @@
 
 #include "../Window/Window.h"
 #include "../Window/inputs.h"
+#include "Frustum.h"
 
 /* maths */
 #include <glm/glm.hpp>
@@ -38,6 +39,8 @@ public:
 	glm::vec3 getCameraX() const;
 
 	glm::mat4 getViewMatrix() const;
+	//!< Frustum seen by the camera with the given projection matrix.
+	Frustum getFrustum(const glm::mat4& projection) const;
 
 	void processCommands(Window& window);
 
@@ -0,0 +1,153 @@
+#include "Frustum.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_USE_SSE
+#include <emmintrin.h>
+#endif
+
+
+Frustum::Frustum()
+{
+	// planes that every point satisfies
+	for (unsigned int i = 0; i < NUM_PLANES; i++)
+	{
+		m_planes[i] = glm::vec4{ 0.0f, 0.0f, 0.0f, 1.0f };
+	}
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	// glm is column major: the i-th row is (m[0][i], m[1][i], m[2][i], m[3][i])
+	const glm::mat4& m = viewProjection;
+	glm::vec4 row0{ m[0][0], m[1][0], m[2][0], m[3][0] };
+	glm::vec4 row1{ m[0][1], m[1][1], m[2][1], m[3][1] };
+	glm::vec4 row2{ m[0][2], m[1][2], m[2][2], m[3][2] };
+	glm::vec4 row3{ m[0][3], m[1][3], m[2][3], m[3][3] };
+
+	m_planes[LEFT]       = row3 + row0;
+	m_planes[RIGHT]      = row3 - row0;
+	m_planes[BOTTOM]     = row3 + row1;
+	m_planes[TOP]        = row3 - row1;
+	m_planes[NEAR_PLANE] = row3 + row2;
+	m_planes[FAR_PLANE]  = row3 - row2;
+
+	// normalized planes give signed distances, needed by the sphere tests
+	for (unsigned int i = 0; i < NUM_PLANES; i++)
+	{
+		float length = glm::length(glm::vec3{ m_planes[i] });
+		if (length > 0.0f)
+		{
+			m_planes[i] /= length;
+		}
+	}
+}
+
+bool Frustum::contains(const glm::vec3& point) const
+{
+	for (unsigned int i = 0; i < NUM_PLANES; i++)
+	{
+		if (glm::dot(glm::vec3{ m_planes[i] }, point) + m_planes[i].w < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+	if (sphere.isEmpty())
+	{
+		return true;
+	}
+	for (unsigned int i = 0; i < NUM_PLANES; i++)
+	{
+		if (glm::dot(glm::vec3{ m_planes[i] }, sphere.center) + m_planes[i].w < -sphere.radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::intersects(const AABB& box) const
+{
+	if (box.isEmpty())
+	{
+		return true;
+	}
+	for (unsigned int i = 0; i < NUM_PLANES; i++)
+	{
+		// the corner of the box farthest along the normal of the plane
+		glm::vec3 normal{ m_planes[i] };
+		glm::vec3 corner{ normal.x >= 0.0f ? box.max.x : box.min.x,
+		                  normal.y >= 0.0f ? box.max.y : box.min.y,
+		                  normal.z >= 0.0f ? box.max.z : box.min.z };
+		if (glm::dot(normal, corner) + m_planes[i].w < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t Frustum::intersectSpheresScalar(const glm::vec4* spheres, size_t count, unsigned char* visible) const
+{
+	size_t numVisible = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		bool inside = intersects(BoundingSphere{ glm::vec3{ spheres[i] }, spheres[i].w });
+		visible[i] = inside ? 1 : 0;
+		numVisible += visible[i];
+	}
+	return numVisible;
+}
+
+size_t Frustum::intersectSpheres(const glm::vec4* spheres, size_t count, unsigned char* visible) const
+{
+#ifdef FRUSTUM_USE_SSE
+	// plane coefficients broadcast once, then four spheres per iteration (transposed to x, y, z, r registers)
+	__m128 planeX[NUM_PLANES], planeY[NUM_PLANES], planeZ[NUM_PLANES], planeW[NUM_PLANES];
+	for (unsigned int p = 0; p < NUM_PLANES; p++)
+	{
+		planeX[p] = _mm_set1_ps(m_planes[p].x);
+		planeY[p] = _mm_set1_ps(m_planes[p].y);
+		planeZ[p] = _mm_set1_ps(m_planes[p].z);
+		planeW[p] = _mm_set1_ps(m_planes[p].w);
+	}
+
+	const size_t batches = count / 4;
+	size_t numVisible = 0;
+	for (size_t b = 0; b < batches; b++)
+	{
+		const float* data = &spheres[4 * b].x;
+		__m128 x = _mm_loadu_ps(data);
+		__m128 y = _mm_loadu_ps(data + 4);
+		__m128 z = _mm_loadu_ps(data + 8);
+		__m128 r = _mm_loadu_ps(data + 12);
+		_MM_TRANSPOSE4_PS(x, y, z, r);
+
+		__m128 minusRadius = _mm_sub_ps(_mm_setzero_ps(), r);
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (unsigned int p = 0; p < NUM_PLANES; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+			                             _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, minusRadius));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (unsigned int k = 0; k < 4; k++)
+		{
+			// empty spheres (negative radius) are always visible, as in the scalar test
+			unsigned char isVisible = ((mask >> k) & 1) || spheres[4 * b + k].w < 0.0f;
+			visible[4 * b + k] = isVisible;
+			numVisible += isVisible;
+		}
+	}
+
+	return numVisible + intersectSpheresScalar(spheres + 4 * batches, count - 4 * batches, visible + 4 * batches);
+#else
+	return intersectSpheresScalar(spheres, count, visible);
+#endif
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+/* maths */
+#include <glm/glm.hpp>
+
+#include "../Model/Bounds.h"
+
+
+//! The six planes of a view frustum, used to discard objects that are not on screen.
+/*!
+	The planes are extracted from projection * view (Gribb-Hartmann) and point inwards: a point p is inside
+	a plane (n, d) when dot(n, p) + d >= 0. The tests are conservative: an object can be reported
+	visible while being just outside a corner of the frustum, but never the opposite.
+*/
+class Frustum
+{
+public:
+	enum Plane { LEFT = 0, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, NUM_PLANES };
+
+	//!< A frustum that contains everything.
+	Frustum();
+	explicit Frustum(const glm::mat4& viewProjection);
+
+	const glm::vec4& getPlane(unsigned int i) const { return m_planes[i]; }
+
+	bool contains(const glm::vec3& point) const;
+	bool intersects(const BoundingSphere& sphere) const;
+	bool intersects(const AABB& box) const;
+
+	//!< Tests count spheres, each packed as (center.x, center.y, center.z, radius), writing 1 (visible) or 0 in visible.
+	//!< Uses SSE four spheres at a time when available. Returns the number of visible spheres.
+	size_t intersectSpheres(const glm::vec4* spheres, size_t count, unsigned char* visible) const;
+
+private:
+	glm::vec4 m_planes[NUM_PLANES];
+
+	size_t intersectSpheresScalar(const glm::vec4* spheres, size_t count, unsigned char* visible) const;
+};
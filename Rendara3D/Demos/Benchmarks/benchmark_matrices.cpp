@@ -0,0 +1,71 @@
+#include "benchmark_matrices.h"
+
+namespace {
+
+	// best time of several repetitions, in milliseconds
+	template <class Function>
+	double bestTime(int repetitions, Function function)
+	{
+		double best = 1e30;
+		for (int r = 0; r < repetitions; r++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			function();
+			auto stop = std::chrono::steady_clock::now();
+			double elapsed = std::chrono::duration<double, std::milli>(stop - start).count();
+			best = (elapsed < best) ? elapsed : best;
+		}
+		return best;
+	}
+
+}
+
+int benchmark_matrices()
+{
+	const size_t sizes[] = { 1000, 20000, 100000 };
+	const int repetitions = 20;
+
+	std::cout << "Instance matrices (model + normal), best of " << repetitions << " runs" << std::endl;
+
+	for (size_t size : sizes)
+	{
+		TransformBatch batch;
+		batch.resize(size);
+		for (size_t i = 0; i < size; i++)
+		{
+			float t = (float)i;
+			batch.set(i, Transform{ glm::vec3{ t * 0.1f, -t * 0.2f, t * 0.05f },
+			                        glm::vec3{ t * 7.0f, t * 3.0f, -t * 5.0f },
+			                        glm::vec3{ 1.0f + 0.001f * t, 0.5f, 2.0f } });
+		}
+
+		std::vector<InstanceData> scalar(size);
+		std::vector<InstanceData> simd(size);
+
+		double scalarTime = bestTime(repetitions, [&]() { batch.computeMatricesScalar(&scalar[0].model, &scalar[0].normal, sizeof(InstanceData)); });
+		double simdTime   = bestTime(repetitions, [&]() { batch.computeMatrices(&simd[0].model, &simd[0].normal, sizeof(InstanceData)); });
+
+		// largest difference between the two paths, relative to the magnitude of the entries
+		float maxError = 0.0f;
+		for (size_t i = 0; i < size; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				for (int r = 0; r < 4; r++)
+				{
+					float e1 = std::abs(scalar[i].model[c][r] - simd[i].model[c][r]) / (1.0f + std::abs(scalar[i].model[c][r]));
+					float e2 = std::abs(scalar[i].normal[c][r] - simd[i].normal[c][r]) / (1.0f + std::abs(scalar[i].normal[c][r]));
+					maxError = std::max(maxError, std::max(e1, e2));
+				}
+			}
+		}
+
+		std::cout << "\t" << size << " instances:"
+			<< "\t scalar " << scalarTime << " ms (" << size / scalarTime / 1000.0 << " M/s)"
+			<< "\t simd "   << simdTime   << " ms (" << size / simdTime / 1000.0   << " M/s)"
+			<< "\t speed-up " << scalarTime / simdTime
+			<< "\t max error " << maxError << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../../Renderer/TransformBatch.h"
+#include "../../Renderer/InstanceData.h"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+//! Measures how many instance matrices per second the scalar (glm) and the SIMD (TransformBatch) paths compute.
+/*!
+	Runs on the CPU only, no window is opened. Both paths fill the same InstanceData array, as InstanceSet does.
+*/
+int benchmark_matrices();
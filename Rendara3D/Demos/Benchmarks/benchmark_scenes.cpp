@@ -0,0 +1,645 @@
+#include "benchmark_scenes.h"
+
+#include "../Shadows/ShadowsDemoLevel.h"
+#include "../Instancing/InstancingDemoLevel.h"
+#include "../OutBreak/OutBreakLevel.h"
+#include "../../Renderer/RenderStats.h"
+#include "../../utils/GpuProfiler.h"
+#include "../../utils/CpuProfiler.h"
+#include "../../utils/FrameArena.h"
+#include "../../utils/AllocationTracker.h"
+#include "../../Renderer/Simple3DRenderer.h"
+
+/* stl */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <map>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	double millisecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	// resident memory of the process and its peak, in MiB (0 where it is not known)
+	void memoryUsage(double& current, double& peak)
+	{
+		current = 0.0;
+		peak = 0.0;
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			current = counters.WorkingSetSize / (1024.0 * 1024.0);
+			peak = counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+		}
+#elif defined(__linux__)
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			// "VmRSS:   1234 kB"
+			if (line.compare(0, 6, "VmRSS:") == 0)
+			{
+				current = std::atof(line.c_str() + 6) / 1024.0;
+			}
+			else if (line.compare(0, 6, "VmHWM:") == 0)
+			{
+				peak = std::atof(line.c_str() + 6) / 1024.0;
+			}
+		}
+#endif
+	}
+
+	// GL_TIME_ELAPSED of each frame. A query is read LATENCY frames after it was issued, when the GPU is
+	// normally done with it, so that measuring does not make the CPU wait for the GPU.
+	class GpuFrameTimer
+	{
+	public:
+		static const size_t LATENCY = 4;
+
+		GpuFrameTimer() : m_frame(0) { GLCall(glGenQueries(LATENCY, m_queries)); }
+		~GpuFrameTimer() { GLCall(glDeleteQueries(LATENCY, m_queries)); }
+
+		void begin()
+		{
+			if (m_frame >= LATENCY)
+			{
+				collect(m_frame - LATENCY);
+			}
+			GLCall(glBeginQuery(GL_TIME_ELAPSED, m_queries[m_frame % LATENCY]));
+		}
+
+		void end()
+		{
+			GLCall(glEndQuery(GL_TIME_ELAPSED));
+			m_frame++;
+		}
+
+		//!< Milliseconds of each frame, in order. Waits for the last ones.
+		const std::vector<double>& finish()
+		{
+			for (size_t frame = (m_frame > LATENCY) ? m_frame - LATENCY : 0; frame < m_frame; frame++)
+			{
+				collect(frame);
+			}
+			return m_times;
+		}
+
+	private:
+		GLuint              m_queries[LATENCY];
+		size_t              m_frame;
+		std::vector<double> m_times;
+
+		void collect(size_t frame)
+		{
+			GLuint64 nanoseconds = 0;
+			GLCall(glGetQueryObjectui64v(m_queries[frame % LATENCY], GL_QUERY_RESULT, &nanoseconds));
+			m_times.push_back(nanoseconds / 1.0e6);
+		}
+	};
+
+	struct Distribution
+	{
+		double mean = 0.0, min = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+	};
+
+	// nearest-rank percentiles
+	Distribution distribution(std::vector<double> values)
+	{
+		Distribution result;
+		if (values.empty())
+		{
+			return result;
+		}
+		std::sort(values.begin(), values.end());
+		auto percentile = [&values](double p)
+		{
+			size_t rank = (size_t)std::ceil(p / 100.0 * values.size());
+			return values.at((rank > 0) ? rank - 1 : 0);
+		};
+		double sum = 0.0;
+		for (double value : values)
+		{
+			sum += value;
+		}
+		result.mean = sum / values.size();
+		result.min  = values.front();
+		result.p50  = percentile(50.0);
+		result.p90  = percentile(90.0);
+		result.p99  = percentile(99.0);
+		result.max  = values.back();
+		return result;
+	}
+
+	struct SceneResult
+	{
+		std::string  name;
+		double       loadMilliseconds = 0.0;
+		Distribution cpuMilliseconds;
+		Distribution gpuMilliseconds;
+		Distribution drawCalls;
+		Distribution instances;
+		Distribution triangles;
+		Distribution programBinds;
+		Distribution textureBinds;
+		Distribution uniformUploads;
+		Distribution uploadedBytes;
+		Distribution allocations;
+		Distribution allocatedBytes;
+		uint64_t     allocationViolations = 0;
+		double       memoryAfterLoad = 0.0;
+		double       memoryEnd = 0.0;
+		double       memoryPeak = 0.0;
+		std::vector<GpuPassTiming> gpuPasses;
+	};
+
+	// makeLevel(textures) loads the level, script(level, t) moves its camera and lights before the frame at time t
+	template <class MakeLevel, class Script>
+	SceneResult runScene(const std::string& name, Window& window, const SceneBenchmarkOptions& options,
+		MakeLevel makeLevel, Script script)
+	{
+		SceneResult result;
+		result.name = name;
+		std::cerr << "[benchmark] " << name << ": loading" << std::endl;
+
+		std::srand(options.seed);
+		Clock::time_point loadStart = Clock::now();
+		std::map<std::string, Texture> loadedTextures;
+		auto level = makeLevel(loadedTextures);
+		glFinish();
+		result.loadMilliseconds = millisecondsSince(loadStart);
+		double peak = 0.0;
+		memoryUsage(result.memoryAfterLoad, peak);
+
+		std::vector<double> cpuTimes, drawCalls, instances, triangles;
+		std::vector<double> programBinds, textureBinds, uniformUploads, uploadedBytes;
+		std::vector<double> allocations, allocatedBytes;
+		GpuFrameTimer gpuTimer;
+		GpuProfiler& profiler = GpuProfiler::shared();
+		profiler.setEnabled(true);
+		bool trackedAllocations = AllocationTracker::isEnabled();
+		AllocationTracker::setEnabled(AllocationTracker::isAvailable());
+		window.setFixedTimeStep(options.timeStep);
+
+		std::cerr << "[benchmark] " << name << ": running " << options.frames << " frames" << std::endl;
+		for (unsigned int frame = 0; frame < options.warmupFrames + options.frames; frame++)
+		{
+			CPU_PROFILE_SCOPE("benchmark frame");
+			window.updateTime();
+			script(*level, window.getCurrentTime());
+			memory::FrameArena::shared().beginFrame();
+			RenderStats::reset();
+			if (frame == options.warmupFrames)
+			{
+				profiler.reset();
+				// what allocates while warming up (first submissions, growing containers) is not a violation
+				AllocationTracker::reset();
+			}
+			profiler.beginFrame();
+
+			Clock::time_point frameStart = Clock::now();
+			AllocationCounters allocationsStart = AllocationTracker::getTotal();
+			gpuTimer.begin();
+			window.clearColorBufferBit(0.5f, 0.5f, 0.5f, 1.0f);
+			{
+				CPU_PROFILE_SCOPE("GameLevel::render");
+				level->render(window);
+			}
+			{
+				CPU_PROFILE_SCOPE("GameLevel::update");
+				level->update(window);
+			}
+			gpuTimer.end();
+			profiler.endFrame();
+			double cpuTime = millisecondsSince(frameStart);
+			AllocationCounters frameAllocations = AllocationTracker::getTotal() - allocationsStart;
+
+			if (frame >= options.warmupFrames)
+			{
+				const RenderCounters& counters = RenderStats::get();
+				cpuTimes.push_back(cpuTime);
+				drawCalls.push_back((double)counters.drawCalls);
+				instances.push_back((double)counters.instances);
+				triangles.push_back((double)counters.triangles);
+				programBinds.push_back((double)counters.programBinds);
+				textureBinds.push_back((double)counters.textureBinds);
+				uniformUploads.push_back((double)counters.uniformUploads);
+				uploadedBytes.push_back((double)(counters.bufferBytes + counters.textureBytes));
+				allocations.push_back((double)frameAllocations.allocations);
+				allocatedBytes.push_back((double)frameAllocations.bytes);
+			}
+
+			window.swapBuffers();
+			window.pollEvents();
+			window.updateLastFrameTime();
+		}
+
+		const std::vector<double>& gpuTimes = gpuTimer.finish();
+		std::vector<double> measuredGpuTimes(gpuTimes.begin() + std::min<size_t>(options.warmupFrames, gpuTimes.size()), gpuTimes.end());
+
+		result.cpuMilliseconds = distribution(cpuTimes);
+		result.gpuMilliseconds = distribution(measuredGpuTimes);
+		result.drawCalls = distribution(drawCalls);
+		result.instances = distribution(instances);
+		result.triangles = distribution(triangles);
+		result.programBinds = distribution(programBinds);
+		result.textureBinds = distribution(textureBinds);
+		result.uniformUploads = distribution(uniformUploads);
+		result.uploadedBytes = distribution(uploadedBytes);
+		result.allocations = distribution(allocations);
+		result.allocatedBytes = distribution(allocatedBytes);
+		result.allocationViolations = AllocationTracker::getViolationCount();
+		memoryUsage(result.memoryEnd, result.memoryPeak);
+		for (const GpuPassTiming& timing : profiler.getTimings())
+		{
+			if (timing.samples > 0)
+			{
+				result.gpuPasses.push_back(timing);
+			}
+		}
+		profiler.dump(std::cerr);
+		// counters of the last frame, per pass
+		RenderStats::dump(std::cerr);
+		AllocationTracker::dump(std::cerr);
+		AllocationTracker::reset();
+		AllocationTracker::setEnabled(trackedAllocations);
+		profiler.reset();
+		profiler.setEnabled(false);
+		window.setFixedTimeStep(0.0);
+		return result;
+	}
+
+	struct SubmissionResult
+	{
+		unsigned int objects = 0;
+		size_t       draws = 0;
+		size_t       culled = 0;
+		double       serialMilliseconds = 0.0;     // best of the repetitions
+		double       parallelMilliseconds = 0.0;
+		size_t       mismatches = 0;               // draws of the parallel queue that differ from the serial one
+	};
+
+	// submits the same objects to a renderer with submit and to another one with submitParallel, and compares the queues
+	SubmissionResult checkSubmission(const SceneBenchmarkOptions& options, const Window& window)
+	{
+		static const int REPETITIONS = 10;
+		SubmissionResult result;
+		result.objects = options.submissionObjects;
+		std::cerr << "[benchmark] submission: " << result.objects << " objects" << std::endl;
+
+		std::map<std::string, Texture> loadedTextures;
+		Model cube{ "./res/model/cube/cube.obj", glm::vec3{115.,194.,251.} / 255.0f, &loadedTextures };
+		Model sphere{ "./res/model/sphere/sphere.obj", &loadedTextures };
+		Model piramid{ "./res/model/piramid/piramid.obj", glm::vec3{255.,60.,60.} / 255.0f, &loadedTextures };
+		Shader shader{ "./res/shaders/objects_wlights.shader" };
+		Shader lampShader{ "./res/shaders/1_lamp.shader" };
+		const Model* models[] = { &cube, &sphere, &piramid };
+
+		// a cloud of objects around the camera, a part of them behind it
+		std::srand(options.seed);
+		auto random = []() { return std::rand() / (RAND_MAX + 1.0f); };
+		std::vector<RenderingSpecification> specifications;
+		specifications.reserve(result.objects);
+		for (unsigned int i = 0; i < result.objects; i++)
+		{
+			glm::vec3 position{ 40.0f * random() - 20.0f, 10.0f * random(), 40.0f * random() - 20.0f };
+			glm::vec3 rotation{ 0.0f, 360.0f * random(), 0.0f };
+			Transform transform{ position, rotation, glm::vec3{ 0.1f + 0.4f * random() } };
+			RenderPass pass = (i % 7 == 0) ? PASS_TRANSPARENT : PASS_OPAQUE;
+			specifications.push_back({ models[i % 3], transform, (i % 5 == 0) ? &lampShader : &shader, pass });
+		}
+
+		Camera camera{ glm::vec3{ -3.0f, 3.0f, 3.0f }, glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f } };
+		glm::mat4 projection = glm::perspective(glm::radians(90.0f), (float)(window.getWidth() / window.getHeight()), 0.1f, 50.0f);
+		Simple3DRenderer serial{ result.objects }, parallel{ result.objects };
+		for (Simple3DRenderer* renderer : { &serial, &parallel })
+		{
+			renderer->setViewPoint(camera.getEye(), 50.0f);
+			renderer->setFrustum(camera.getFrustum(projection));
+		}
+
+		result.serialMilliseconds = 1e30;
+		result.parallelMilliseconds = 1e30;
+		for (int r = 0; r < REPETITIONS; r++)
+		{
+			memory::FrameArena::shared().beginFrame();
+
+			Clock::time_point start = Clock::now();
+			serial.clear();
+			for (const RenderingSpecification& specification : specifications)
+			{
+				serial.submit(specification);
+			}
+			result.serialMilliseconds = std::min(result.serialMilliseconds, millisecondsSince(start));
+
+			start = Clock::now();
+			parallel.clear();
+			parallel.submitParallel(specifications.data(), specifications.size());
+			result.parallelMilliseconds = std::min(result.parallelMilliseconds, millisecondsSince(start));
+		}
+
+		const RenderQueue& expected = serial.getQueue();
+		const RenderQueue& queue = parallel.getQueue();
+		result.draws = expected.size();
+		result.culled = serial.getNumCulled();
+		if (queue.size() != expected.size() || parallel.getNumCulled() != serial.getNumCulled())
+		{
+			result.mismatches = std::max(queue.size(), expected.size());
+			return result;
+		}
+		for (size_t i = 0; i < queue.size(); i++)
+		{
+			const RenderItem& a = expected.at(i);
+			const RenderItem& b = queue.at(i);
+			bool same = expected.keyAt(i) == queue.keyAt(i) && a.mesh == b.mesh && a.shader == b.shader
+				&& a.materialID == b.materialID && a.visible == b.visible
+				&& std::memcmp(&serial.getMatrices(a), &parallel.getMatrices(b), sizeof(DrawMatrices)) == 0;
+			result.mismatches += same ? 0 : 1;
+		}
+		return result;
+	}
+
+	// camera going around center, one turn every period seconds
+	void orbit(Camera& camera, const glm::vec3& center, float radius, float height, float period, float t)
+	{
+		float angle = 2.0f * glm::pi<float>() * t / period;
+		camera.setEye(center + glm::vec3{ radius * std::cos(angle), height, radius * std::sin(angle) });
+		camera.setCenter(center);
+		camera.setUp(glm::vec3{ 0.0f, 1.0f, 0.0f });
+	}
+
+	std::string jsonString(const std::string& text)
+	{
+		std::string result = "\"";
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				result += '\\';
+			}
+			result += (c >= 0 && c < 0x20) ? ' ' : c;
+		}
+		return result + "\"";
+	}
+
+	std::string glString(GLenum name)
+	{
+		const GLubyte* value = glGetString(name);
+		return (value != nullptr) ? std::string((const char*)value) : std::string();
+	}
+
+	void writeDistribution(std::ostream& out, const char* name, const Distribution& d)
+	{
+		out << "      " << jsonString(name) << ": { \"mean\": " << d.mean << ", \"min\": " << d.min << ", \"p50\": " << d.p50
+			<< ", \"p90\": " << d.p90 << ", \"p99\": " << d.p99 << ", \"max\": " << d.max << " }";
+	}
+
+	void writeResults(std::ostream& out, const SceneBenchmarkOptions& options, const std::vector<SceneResult>& results,
+		const SubmissionResult& submission)
+	{
+		out.setf(std::ios::fixed);
+		out.precision(3);
+		out << "{\n";
+		out << "  \"renderer\": " << jsonString(glString(GL_RENDERER)) << ",\n";
+		out << "  \"version\": " << jsonString(glString(GL_VERSION)) << ",\n";
+		out << "  \"width\": " << options.width << ",\n";
+		out << "  \"height\": " << options.height << ",\n";
+		out << "  \"frames\": " << options.frames << ",\n";
+		out << "  \"warmup_frames\": " << options.warmupFrames << ",\n";
+		out << "  \"dt\": " << options.timeStep << ",\n";
+		out << "  \"seed\": " << options.seed << ",\n";
+		out << "  \"scenes\": [\n";
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const SceneResult& r = results.at(i);
+			out << "    {\n";
+			out << "      \"name\": " << jsonString(r.name) << ",\n";
+			out << "      \"load_ms\": " << r.loadMilliseconds << ",\n";
+			writeDistribution(out, "cpu_ms", r.cpuMilliseconds);   out << ",\n";
+			writeDistribution(out, "gpu_ms", r.gpuMilliseconds);   out << ",\n";
+			writeDistribution(out, "draw_calls", r.drawCalls);     out << ",\n";
+			writeDistribution(out, "instances", r.instances);      out << ",\n";
+			writeDistribution(out, "triangles", r.triangles);      out << ",\n";
+			writeDistribution(out, "program_binds", r.programBinds);     out << ",\n";
+			writeDistribution(out, "texture_binds", r.textureBinds);     out << ",\n";
+			writeDistribution(out, "uniform_uploads", r.uniformUploads); out << ",\n";
+			writeDistribution(out, "uploaded_bytes", r.uploadedBytes);   out << ",\n";
+			writeDistribution(out, "allocations", r.allocations);        out << ",\n";
+			writeDistribution(out, "allocated_bytes", r.allocatedBytes); out << ",\n";
+			out << "      \"allocation_violations\": " << r.allocationViolations << ",\n";
+			out << "      \"memory_mib\": { \"after_load\": " << r.memoryAfterLoad << ", \"end\": " << r.memoryEnd
+				<< ", \"peak\": " << r.memoryPeak << " },\n";
+			out << "      \"gpu_passes_ms\": {";
+			for (size_t p = 0; p < r.gpuPasses.size(); p++)
+			{
+				const GpuPassTiming& pass = r.gpuPasses.at(p);
+				out << ((p > 0) ? ", " : " ") << jsonString(pass.name) << ": { \"mean\": " << pass.averageMs
+					<< ", \"min\": " << pass.minMs << ", \"max\": " << pass.maxMs << " }";
+			}
+			out << " }\n";
+			out << "    }" << ((i + 1 < results.size()) ? "," : "") << "\n";
+		}
+		out << "  ],\n";
+		out << "  \"submission\": { \"objects\": " << submission.objects << ", \"draws\": " << submission.draws
+			<< ", \"culled\": " << submission.culled << ", \"serial_ms\": " << submission.serialMilliseconds
+			<< ", \"parallel_ms\": " << submission.parallelMilliseconds << ", \"mismatches\": " << submission.mismatches << " }\n";
+		out << "}\n";
+	}
+
+	bool isScene(const std::string& name)
+	{
+		return name == "shadows" || name == "instancing" || name == "outbreak";
+	}
+
+}
+
+
+int benchmark_scenes(const SceneBenchmarkOptions& options)
+{
+	for (const std::string& scene : options.scenes)
+	{
+		if (!isScene(scene))
+		{
+			std::cerr << "[benchmark] unknown scene: " << scene << std::endl;
+			return 1;
+		}
+	}
+
+	Window window{ "benchmark", (double)options.width, (double)options.height, Monitor::G_HIDDEN };
+
+	std::vector<SceneResult> results;
+	for (const std::string& scene : options.scenes)
+	{
+		if (scene == "shadows")
+		{
+			results.push_back(runScene(scene, window, options,
+				[&window](std::map<std::string, Texture>& textures)
+				{
+					return std::make_unique<ShadowsDemoLevel>(window, textures);
+				},
+				[](ShadowsDemoLevel& level, float t)
+				{
+					orbit(level.camera, glm::vec3{ 0.0f }, 4.25f, 3.0f, 12.0f, t);
+					level.pointLight.eye = glm::vec3{ std::cos(1.3f * t), 2.0f, std::sin(1.3f * t) };
+				}));
+		}
+		else if (scene == "instancing")
+		{
+			results.push_back(runScene(scene, window, options,
+				[&window](std::map<std::string, Texture>& textures)
+				{
+					return std::make_unique<InstancingDemoLevel>(window, textures);
+				},
+				[](InstancingDemoLevel& level, float t)
+				{
+					orbit(level.camera, glm::vec3{ 0.0f }, 6.0f, 3.0f, 20.0f, t);
+					level.sunAngle = -6.28f + 0.5f * t;
+				}));
+		}
+		else if (scene == "outbreak")
+		{
+			results.push_back(runScene(scene, window, options,
+				[&window](std::map<std::string, Texture>& textures)
+				{
+					std::unique_ptr<OutBreakLevel> level = std::make_unique<OutBreakLevel>(window, &textures);
+					level->load({ {2,3,2,3,2,3,2,3,2,3,2,3},
+					              {3,2,3,2,3,2,3,2,3,2,3,2},
+					              {1,1,1,0,1,1,0,1,1,0,1,1} });
+					return level;
+				},
+				[](OutBreakLevel& level, float)
+				{
+					level.followBall();
+				}));
+		}
+	}
+
+	SubmissionResult submission;
+	if (options.submissionObjects > 0)
+	{
+		submission = checkSubmission(options, window);
+	}
+
+	std::ofstream file(options.output);
+	if (!file)
+	{
+		std::cerr << "[benchmark] cannot write " << options.output << std::endl;
+		window.terminate();
+		return 1;
+	}
+	writeResults(file, options, results, submission);
+	std::cerr << "[benchmark] results written to " << options.output << std::endl;
+
+	window.terminate();
+
+	int status = 0;
+	for (const SceneResult& result : results)
+	{
+		if (options.allocationBudget >= 0 && result.allocations.max > (double)options.allocationBudget)
+		{
+			std::cerr << "[benchmark] " << result.name << ": " << result.allocations.max << " allocations in a frame, over the budget of "
+				<< options.allocationBudget << std::endl;
+			status = 2;
+		}
+	}
+	if (submission.mismatches > 0)
+	{
+		std::cerr << "[benchmark] submission: " << submission.mismatches << " of " << submission.draws
+			<< " draws recorded in parallel differ from the serial ones" << std::endl;
+		status = 3;
+	}
+	return status;
+}
+
+bool parseSceneBenchmarkOptions(int argc, char* argv[], SceneBenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = (i + 1 < argc);
+		if (argument == "--benchmark")
+		{
+			continue;
+		}
+		else if (argument == "--scenes" && hasValue)
+		{
+			options.scenes.clear();
+			std::stringstream list(argv[++i]);
+			std::string scene;
+			while (std::getline(list, scene, ','))
+			{
+				options.scenes.push_back(scene);
+			}
+		}
+		else if (argument == "--frames" && hasValue)
+		{
+			options.frames = (unsigned int)std::atoi(argv[++i]);
+		}
+		else if (argument == "--warmup" && hasValue)
+		{
+			options.warmupFrames = (unsigned int)std::atoi(argv[++i]);
+		}
+		else if (argument == "--dt" && hasValue)
+		{
+			options.timeStep = std::atof(argv[++i]);
+		}
+		else if (argument == "--size" && hasValue)
+		{
+			char separator = 0;
+			std::stringstream size(argv[++i]);
+			size >> options.width >> separator >> options.height;
+		}
+		else if (argument == "--seed" && hasValue)
+		{
+			options.seed = (unsigned int)std::atoi(argv[++i]);
+		}
+		else if (argument == "--out" && hasValue)
+		{
+			options.output = argv[++i];
+		}
+		else if (argument == "--alloc-budget" && hasValue)
+		{
+			options.allocationBudget = std::atoll(argv[++i]);
+		}
+		else if (argument == "--submission" && hasValue)
+		{
+			options.submissionObjects = (unsigned int)std::atoi(argv[++i]);
+		}
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " --benchmark [--scenes shadows,instancing,outbreak] [--frames N] "
+				"[--warmup N] [--dt seconds] [--size WxH] [--seed N] [--out file.json] [--alloc-budget N] [--submission N]" << std::endl;
+			return false;
+		}
+	}
+	if (options.timeStep <= 0.0 || options.width <= 0 || options.height <= 0 || options.frames == 0)
+	{
+		std::cerr << "[benchmark] frames, dt and size must be positive." << std::endl;
+		return false;
+	}
+	if (options.allocationBudget >= 0 && !AllocationTracker::isAvailable())
+	{
+		std::cerr << "[benchmark] --alloc-budget needs a build with ALLOCATION_TRACKING 1." << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+/* stl */
+#include <string>
+#include <vector>
+
+
+//! What benchmark_scenes runs, and where it writes the results.
+struct SceneBenchmarkOptions
+{
+	std::vector<std::string> scenes = { "shadows", "instancing", "outbreak" };
+	unsigned int frames       = 600;          // measured frames of each scene
+	unsigned int warmupFrames = 30;           // frames run before measuring
+	double       timeStep     = 1.0 / 60.0;   // simulated seconds per frame
+	int          width        = 1280;
+	int          height       = 720;
+	unsigned int seed         = 1;            // of rand, set again before loading each scene
+	std::string  output       = "benchmark.json";
+	long long    allocationBudget = -1;       // most heap allocations allowed in a measured frame, -1 for no limit
+	unsigned int submissionObjects = 20000;   // objects of the serial/parallel submission check, 0 to skip it
+};
+
+//! Runs the demo scenes in a hidden window and writes their frame times, draw counts and memory use as JSON.
+/*!
+	Every scene runs the same way at each run: a fixed time step instead of the real time (Window::setFixedTimeStep),
+	rand seeded before loading, and a scripted camera and light path instead of the keyboard.
+	For each scene the JSON has the loading time, the distribution (mean, min, p50, p90, p99, max) of the CPU time of
+	render + update and of the GPU time of the frame (GL_TIME_ELAPSED queries), the draw calls, instances, triangles,
+	program and texture binds, uniform uploads and uploaded bytes of each frame (RenderStats), the heap allocations of
+	each frame and the allocations made in allocation-free scopes (AllocationTracker), the resident memory of the
+	process after loading, at the end and at its peak, and the GPU time of each GpuProfiler scope (shadows, HDR scene,
+	tonemap) over the last GpuProfiler::STATISTICS_FRAMES frames.
+	With an allocation budget, a scene making more allocations than that in one of its measured frames fails the
+	run: the results are written anyway, and benchmark_scenes returns 2.
+	The submission check then submits the same moving objects to one Simple3DRenderer with submit and to another with
+	submitParallel: the two queues must have the same keys, items and matrices, or benchmark_scenes returns 3. The JSON
+	gets the best time of each way.
+	Nothing is shown on the screen and the vertical sync is off, so the numbers do not depend on the display; on a
+	Linux box without GPU, run it under Xvfb with Mesa's llvmpipe (LIBGL_ALWAYS_SOFTWARE=1).
+*/
+int benchmark_scenes(const SceneBenchmarkOptions& options);
+
+//!< Reads the options from the command line: --benchmark [--scenes a,b] [--frames N] [--warmup N] [--dt seconds]
+//!< [--size WxH] [--seed N] [--out file] [--alloc-budget N] [--submission N]. Prints the usage and returns false on a wrong argument.
+bool parseSceneBenchmarkOptions(int argc, char* argv[], SceneBenchmarkOptions& options);
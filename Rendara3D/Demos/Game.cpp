@@ -1,4 +1,12 @@
 #include "Game.h"
+#include "../utils/GpuProfiler.h"
+#include "../utils/CpuProfiler.h"
+#include "../Renderer/RenderStats.h"
+#include "../utils/FrameArena.h"
+#include "../utils/AllocationTracker.h"
+
+/* stl */
+#include <thread>
 
 Game::Game(GLuint widthIn, GLuint heightIn) :
 	m_window{ "game", widthIn, heightIn, Monitor::G_NOTSPECIFIED } {}
@@ -7,40 +15,175 @@ Game::Game(GLuint widthIn, GLuint heightIn) :
 void Game::execute()
 {
 	// load levels
-	load();
+	{
+		CPU_PROFILE_SCOPE("Game::load");
+		load();
+	}
 
 	while (!m_window.isClosed())
 	{
-		// ******* initialize frame
-		m_window.updateTime();
-		m_window.clearColorBufferBit(0.5f, 0.5f, 0.5f, 1.0f);
+		GameLevel& level = *m_levels.front();
+		if (m_renderThread && level.hasSnapshots())
+		{
+			// returns when the level is over or the window is closed
+			runWithRenderThread(level);
+		}
+		else
+		{
+			runFrame(level);
+		}
 
+		// ******* advance levels
+		advanceLevels();
+	}
+
+}
 
-		// ******* graphics, physics and game logic
-			// graphics
-		m_levels.front()->render(m_window);
+void Game::runFrame(GameLevel& level)
+{
+	CPU_PROFILE_SCOPE("Game::execute frame");
 
-		// game logic: commands, events
-		m_levels.front()->update(m_window);
+	// ******* initialize frame
+	m_window.updateTime();
+	beginRenderFrame();
 
-		// ******* advance levels
-		if (m_levels.front()->getState() == GAME_WIN)
+
+	// ******* graphics, physics and game logic
+		// graphics
+	{
+		CPU_PROFILE_SCOPE("GameLevel::render");
+		level.render(m_window);
+	}
+
+	// game logic: commands, events
+	{
+		CPU_PROFILE_SCOPE("GameLevel::update");
+		level.update(m_window);
+	}
+
+	// ******* last stuff to do
+	GpuProfiler::shared().endFrame();
+	// F3 logs the counters of the frame (and the allocations of the previous one)
+	if (pollStatsKey())
+	{
+		RenderStats::dump(std::cout);
+		if (AllocationTracker::isEnabled())
 		{
-			m_levels.pop_front();
-			if (m_levels.empty())
-			{
-				m_window.close();
-			}
+			AllocationTracker::dump(std::cout);
 		}
-		else if (m_levels.front()->getState() == GAME_LOST)
+	}
+	{
+		CPU_PROFILE_SCOPE("Window::swapBuffers");
+		m_window.swapBuffers();
+	}
+	m_window.pollEvents();
+	m_window.updateLastFrameTime();
+}
+
+void Game::runWithRenderThread(GameLevel& level)
+{
+	// the render thread owns the context until the level is over
+	m_snapshots.reset();
+	Window::releaseContext();
+	std::thread renderThread{ [this, &level]() { renderLoop(level); } };
+
+	// frame N+1 is updated while the render thread draws frame N (GLFW wants the events on this thread)
+	while (!m_window.isClosed() && level.getState() == GAME_ACTIVE)
+	{
+		CPU_PROFILE_SCOPE("Game::simulate frame");
+		m_window.updateTime();
 		{
-			m_window.close();
+			CPU_PROFILE_SCOPE("GameLevel::update");
+			level.update(m_window);
 		}
 
-		// ******* last stuff to do
-		m_window.swapBuffers();
+		FrameSnapshot* snapshot = nullptr;
+		{
+			CPU_PROFILE_SCOPE("Game::wait snapshot");
+			snapshot = m_snapshots.beginWrite();
+		}
+		snapshot->clear();
+		snapshot->width = (int)m_window.getWidth();
+		snapshot->height = (int)m_window.getHeight();
+		snapshot->logStats = pollStatsKey();
+		{
+			CPU_PROFILE_SCOPE("GameLevel::capture");
+			level.capture(*snapshot);
+		}
+		m_snapshots.publish();
+
 		m_window.pollEvents();
 		m_window.updateLastFrameTime();
 	}
 
-}
\ No newline at end of file
+	// the render thread draws what was published, then gives the context back
+	m_snapshots.close();
+	renderThread.join();
+	m_window.makeContextCurrent();
+}
+
+void Game::renderLoop(GameLevel& level)
+{
+	CpuProfiler::setThreadName("render");
+	m_window.makeContextCurrent();
+
+	while (const FrameSnapshot* snapshot = m_snapshots.acquire())
+	{
+		CPU_PROFILE_SCOPE("Game::render frame");
+		beginRenderFrame();
+		{
+			CPU_PROFILE_SCOPE("GameLevel::renderSnapshot");
+			level.renderSnapshot(m_window, *snapshot);
+		}
+		GpuProfiler::shared().endFrame();
+		if (snapshot->logStats)
+		{
+			RenderStats::dump(std::cout);
+			if (AllocationTracker::isEnabled())
+			{
+				AllocationTracker::dump(std::cout);
+			}
+		}
+		// everything was copied out of the snapshot: the simulation can write the next one while the driver waits
+		m_snapshots.release();
+		{
+			CPU_PROFILE_SCOPE("Window::swapBuffers");
+			m_window.swapBuffers();
+		}
+	}
+
+	Window::releaseContext();
+}
+
+void Game::beginRenderFrame()
+{
+	memory::FrameArena::shared().beginFrame();
+	RenderStats::reset();
+	AllocationTracker::beginFrame();
+	GpuProfiler::shared().beginFrame();
+	m_window.clearColorBufferBit(0.5f, 0.5f, 0.5f, 1.0f);
+}
+
+bool Game::pollStatsKey()
+{
+	bool down = (glfwGetKey(m_window.getGLFWwindow(), GLFW_KEY_F3) == GLFW_PRESS);
+	bool pressed = down && !m_statsKeyDown;
+	m_statsKeyDown = down;
+	return pressed;
+}
+
+void Game::advanceLevels()
+{
+	if (m_levels.front()->getState() == GAME_WIN)
+	{
+		m_levels.pop_front();
+		if (m_levels.empty())
+		{
+			m_window.close();
+		}
+	}
+	else if (m_levels.front()->getState() == GAME_LOST)
+	{
+		m_window.close();
+	}
+}
@@ -9,6 +9,8 @@
 // rendering engine
 #include "../Window/Window.h"
 #include "../Texture/Texture.h"
+#include "../Renderer/FrameSnapshot.h"
+#include "../utils/SnapshotBuffer.h"
 #include "GameLevel.h"
 #include "GameState.h"
 
@@ -23,10 +25,30 @@ public:
 	// and then cycling through the list of GameLevels
 	void execute();
 
+	// With true, the levels that have snapshots (see GameLevel::capture) are simulated by the thread calling execute
+	// while a render thread, owning the OpenGL context, draws the previous frame. The FrameArena, RenderStats and
+	// GpuProfiler frames then belong to the render thread. The other levels run on a single thread as before.
+	void setRenderThread(bool enabled) { m_renderThread = enabled; }
+
 protected:
 	std::map<std::string, Texture>			m_loadedTextures;
 	std::list<std::unique_ptr<GameLevel> >  m_levels;
 	Window									m_window;
 
 	virtual void load() = 0;
+
+private:
+	bool                             m_renderThread = false;
+	bool                             m_statsKeyDown = false;
+	SnapshotBuffer<FrameSnapshot, 2> m_snapshots;   // double-buffered: the simulation stays one frame ahead
+
+	// one frame of the level: render, then update
+	void runFrame(GameLevel& level);
+	// the frames of the level until it is over: update and capture here, renderSnapshot on a render thread
+	void runWithRenderThread(GameLevel& level);
+	void renderLoop(GameLevel& level);
+	void beginRenderFrame();
+	// true once per press of F3
+	bool pollStatsKey();
+	void advanceLevels();
 };
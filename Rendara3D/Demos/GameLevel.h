@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GameState.h"
+#include "../Renderer/FrameSnapshot.h"
 
 class GameLevel
 {
@@ -13,5 +14,11 @@ public:
 	virtual void render(const Window& window) = 0;
 	virtual void update(Window& window) = 0;
 
+	// Levels that can be drawn by a render thread (see Game::setRenderThread) copy in capture what they draw,
+	// and renderSnapshot draws only from the snapshot and from what update never changes (models, shaders...).
+	virtual bool hasSnapshots() const { return false; }
+	virtual void capture(FrameSnapshot& /*snapshot*/) {}
+	virtual void renderSnapshot(const Window& window, const FrameSnapshot& /*snapshot*/) { render(window); }
+
 	inline GameState getState() const { return m_state; }
-};
\ No newline at end of file
+};
@@ -1,4 +1,6 @@
 
+#pragma once
+
 #include "../Game.h"
 #include "InstancingDemoLevel.h"
 
@@ -10,6 +12,7 @@ public:
 private:
 	void load() override
 	{
-		this->m_levels.push_back(std::make_unique<InstancingDemoLevel>(InstancingDemoLevel{ this->m_window, this->m_loadedTextures }));
+		// built in place: the level keeps pointers to its own shaders and models
+		this->m_levels.push_back(std::make_unique<InstancingDemoLevel>(this->m_window, this->m_loadedTextures));
 	}
 };
\ No newline at end of file
@@ -0,0 +1,280 @@
+#include "InstancingDemoLevel.h"
+#include "demo_instancing.h"
+
+InstancingDemoLevel::InstancingDemoLevel(const Window& window, std::map<std::string, Texture>& loadedTextures) :
+	/* models */
+	cube{ "./res/model/cube/cube.obj",glm::vec3{115.,194.,251.} / 255.0f, &loadedTextures },
+	sphere{ "./res/model/sphere/sphere.obj", &loadedTextures },
+	piramid{ "./res/model/piramid/piramid.obj",glm::vec3{255.,60.,60.} / 255.0f,  &loadedTextures },
+	parquet{ "./res/model/parquet/concentric.obj", &loadedTextures },
+	quad{ "./res/model/quad/quad.obj", &loadedTextures },
+	/* shaders */
+	hdrShader{ "./res/shaders/hdr.shader" },
+	shadowShader{ "./res/shaders/depth.shader" },
+	cubeMapShader{ "./res/shaders/cubemap.shader" },
+	lampShader{ "./res/shaders/1_lamp.shader" },
+	cubeDepthShader{ "./res/shaders/cubeDepth.shader" },
+	shader{ "./res/shaders/objects_wlights.shader" },
+	debugDepth{ "./res/shaders/debugDepth.shader" },
+	instancesColoredQuadsShader{ "./res/shaders/instances_colored_quads.shader" },
+	instancesObjectsShader{ "./res/shaders/instances_objects_wlights.shader" },
+	instancesSunShadowShader{ "./res/shaders/instances_depth.shader" },
+	instancesCubeDepthShader{ "./res/shaders/instances_cubeDepth.shader" },
+	instancesCompactObjectsShader{ "./res/shaders/instances_compact_objects_wlights.shader" },
+	instancesCompactSunShadowShader{ "./res/shaders/instances_compact_depth.shader" },
+	instancesCompactCubeDepthShader{ "./res/shaders/instances_compact_cubeDepth.shader" },
+	/* instances */
+	coloredQuads{ 1024 },
+	cubesSet{ 7000 },
+	sunAngle(-6.28f),
+	backgroundColor(0.0f)
+{
+	/* game status */
+	m_state = GameState::GAME_ACTIVE;
+
+	/* camera */
+	camera = Camera{ glm::vec3{-3.0f, 3.0f, 3.0f}, glm::vec3{0.0f, 0.0f, 1.0f}, glm::vec3{0.0f, 1.0f, 0.0f} };
+	projection = glm::perspective(glm::radians(90.0f), (float)(window.getWidth() / window.getHeight()), 0.1f, 50.0f);
+
+	/* objects */
+	cubeTransform    = { { -3.5f, 0.6f, 0.0f }, glm::vec3{0.0f}, glm::vec3{1.0f} };
+	cubeTransform2   = { { -0.5f, 0.6f, 6.0f }, glm::vec3{0.0f}, glm::vec3{2.0f,1.0f,1.0f} };
+	cubeTransform3   = { { +6.5f, 0.6f, -6.0f }, glm::vec3{0.0f,45.0f,0.0f}, glm::vec3{1.0f,2.0f,1.0f} };
+	sphereTransform  = { { +0.75f, 0.25f, 0.0f }, glm::vec3{0.0f}, glm::vec3{1.0f} };
+	piramidTransform = { { -0.75f, 0.25f, 0.0f }, glm::vec3{0.0f}, glm::vec3{0.42f} };
+	parquetTransform = { { 0.0f,0.0f,0.0f }, glm::vec3{0.0f}, glm::vec3{1.25f} };
+	swarm.resize(instancingDemoParams::swarmSize);
+	move_swarm(swarm, 0.0f);
+
+	/* instancing */
+	coloredQuads.setModel(&quad);
+	simple3DRenderer.setInstancedShader(&shader, &instancesObjectsShader);
+	geometryPool.add(cube);
+	geometryPool.add(sphere);
+	geometryPool.add(piramid);
+	geometryPool.add(parquet);
+	simple3DRenderer.setGeometryPool(&geometryPool);
+	cubesSet.setModel(&cube);
+	position_cubes(cubesSet);
+
+	/* lights */
+	suns.push_back(SunLight{ glm::vec3{+4.08030128,-4.94482803,-2.77766037}, glm::vec3{0.0f,0.0f,0.0f},
+		instancingDemoParams::sunAmbient0, instancingDemoParams::sunDiffuse0, instancingDemoParams::sunSpecular });
+	for (size_t i = 0; i < suns.size(); i++)
+	{
+		sunShadows.emplace_back(ShadowMap2D{ instancingDemoParams::sun_nearPlane, instancingDemoParams::sun_farPlane,
+		                                     instancingDemoParams::sun_left,      instancingDemoParams::sun_right,
+		                                     instancingDemoParams::sun_down,      instancingDemoParams::sun_up,     1024, 1024 });
+		shadowMapNames.push_back("shadowMap[" + std::to_string(i) + "]");
+	}
+
+	pointLights.push_back(PointLight{ glm::vec3{+0.0f, 0.1f, 0.0f},
+		instancingDemoParams::pointLightAmbient,  instancingDemoParams::pointLightDiffuse, instancingDemoParams::pointLightSpecular,
+		instancingDemoParams::pointLightConstant, instancingDemoParams::pointLightLinear,  instancingDemoParams::pointLightQuadratic });
+	for (size_t i = 0; i < pointLights.size(); i++)
+	{
+		pointShadows.push_back(std::move(ShadowCubeMap(1024, 1024)));
+		cubeDepthMapNames.push_back("cubeDepthMap[" + std::to_string(i) + "]");
+	}
+
+	hdrShader.bind();
+	hdrShader.setUniformValue("exposure", 1.0f);
+	hdrShader.unbind();
+
+	/* passes */
+	buildFrameGraph(window);
+}
+
+
+void InstancingDemoLevel::render(const Window& window)
+{
+	simple3DRenderer.setViewPoint(camera.getEye());
+	simple3DRenderer.setFrustum(camera.getFrustum(projection));
+	simple3DRenderer.submit({ &cube, cubeTransform , &shader });
+	simple3DRenderer.submit({ &cube, cubeTransform2, &shader });
+	simple3DRenderer.submit({ &cube, cubeTransform3, &shader });
+
+	simple3DRenderer.submit({ &sphere, sphereTransform  , &shader });
+	simple3DRenderer.submit({ &piramid, piramidTransform, &shader });
+	simple3DRenderer.submit({ &parquet, parquetTransform, &shader });
+	for (size_t i = 0; i < pointLights.size(); i++)
+	{
+		simple3DRenderer.submit({ &cube, Transform{ pointLights.at(i).eye, glm::vec3{0.0f}, glm::vec3{.1f} }, &lampShader });
+	}
+	// the swarm changes every frame: its matrices, culling and depths are computed on the threads of the pool
+	simple3DRenderer.submitParallel(swarm.size(), [this](size_t i) -> RenderingSpecification
+	{
+		return { &piramid, swarm[i], &shader };
+	});
+
+	// shadows, hdr scene and tonemap (see buildFrameGraph)
+	frameGraph.setClearColor(hdrColor, glm::vec4{ backgroundColor, 1.0f });
+	frameGraph.execute((int)window.getWidth(), (int)window.getHeight());
+
+	simple3DRenderer.clear();
+}
+
+void InstancingDemoLevel::buildFrameGraph(const Window& window)
+{
+	const Window* target = &window;
+	std::vector<FrameGraphResource> shadowMaps;
+	for (size_t i = 0; i < sunShadows.size(); i++)
+	{
+		shadowMaps.push_back(frameGraph.importTexture("sun shadow map", sunShadows.at(i).getTextureID()));
+	}
+	for (size_t i = 0; i < pointShadows.size(); i++)
+	{
+		shadowMaps.push_back(frameGraph.importTexture("point shadow map", pointShadows.at(i).getTextureID()));
+	}
+	hdrColor = frameGraph.createTexture("hdr color", { 0, 0, GL_RGBA16 });
+	FrameGraphResource hdrDepth = frameGraph.createTexture("hdr depth", { 0, 0, GL_DEPTH_COMPONENT24 });
+
+	// the shadow maps render with their own framebuffers
+	FrameGraphPassBuilder shadows = frameGraph.addPass("shadows", [this, target](const FrameGraph&)
+	{
+		const Window& window = *target;
+		// clear shadowmaps of SunLights
+		for (size_t i = 0; i < suns.size(); i++)
+		{
+			sunShadows.at(i).clearShadows();
+		}
+		// clear shadowmaps of PointLights
+		for (size_t i = 0; i < pointLights.size(); i++)
+		{
+			pointShadows.at(i).clearShadows();
+		}
+		// SunLights
+		for (size_t i = 0; i < suns.size(); i++)
+		{
+			sunShadows.at(i).startShadows(window, shadowShader, &suns.at(i));
+			simple3DRenderer.draw(&shadowShader);
+			sunShadows.at(i).stopShadows(window, shadowShader);
+		}
+		for (size_t i = 0; i < suns.size(); i++)
+		{
+			sunShadows.at(i).startShadows(window, instancesCompactSunShadowShader, &suns.at(i));
+			cubesSet.drawInstances(instancesCompactSunShadowShader);
+			sunShadows.at(i).stopShadows(window, instancesCompactSunShadowShader);
+		}
+
+		// PointLights
+		for (size_t i = 0; i < pointLights.size(); i++)
+		{
+			pointShadows.at(i).startShadows(window, cubeDepthShader, pointLights.at(i));
+			simple3DRenderer.draw(&cubeDepthShader);
+			pointShadows.at(i).stopShadows(window, cubeDepthShader);
+		}
+		for (size_t i = 0; i < pointLights.size(); i++)
+		{
+			pointShadows.at(i).startShadows(window, instancesCompactCubeDepthShader, pointLights.at(i));
+			cubesSet.drawInstances(instancesCompactCubeDepthShader);
+			pointShadows.at(i).stopShadows(window, instancesCompactCubeDepthShader);
+		}
+	});
+
+	FrameGraphPassBuilder scene = frameGraph.addPass("hdr scene", [this](const FrameGraph&)
+	{
+		// view transformations (camera position and perspective) and lights, once for all the shaders
+		frameUniforms.setCamera(camera.getViewMatrix(), projection, camera.getEye());
+		for (size_t i = 0; i < suns.size(); i++)
+		{
+			frameUniforms.setSun(i, suns.at(i), sunShadows.at(i).getLightSpaceMatrix(suns.at(i).getViewMatrix()));
+		}
+		for (size_t i = 0; i < pointLights.size(); i++)
+		{
+			frameUniforms.setPointLight(i, pointLights.at(i));
+		}
+		frameUniforms.upload();
+
+		// shadow maps
+		shader.bind();
+		for (size_t i = 0; i < suns.size(); i++)
+		{
+			sunShadows.at(i).passUniforms(shader, shadowMapNames.at(i));
+		}
+		for (size_t i = 0; i < pointLights.size(); i++)
+		{
+			pointShadows.at(i).passUniforms(shader, cubeDepthMapNames.at(i), "farPlane");
+		}
+
+		instancesObjectsShader.bind();
+		sunShadows.at(0).passUniforms(instancesObjectsShader, "shadowMap[0]");
+		pointShadows.at(0).passUniforms(instancesObjectsShader, "cubeDepthMap[0]", "farPlane");
+
+		instancesCompactObjectsShader.bind();
+		sunShadows.at(0).passUniforms(instancesCompactObjectsShader, "shadowMap[0]");
+		pointShadows.at(0).passUniforms(instancesCompactObjectsShader, "cubeDepthMap[0]", "farPlane");
+
+		// draw stuff
+		simple3DRenderer.draw(); // they're using their own shaders
+		cubesSet.drawInstances(instancesCompactObjectsShader, camera.getFrustum(projection));
+
+		instancesColoredQuadsShader.bind();
+		instancesColoredQuadsShader.setUniformValue("brightness", 1.0f);
+		coloredQuads.drawInstances(instancesColoredQuadsShader);
+
+		// lamps's shaders
+		lampShader.bind();
+		lampShader.setUniformMatrix("view", camera.getViewMatrix(), false);
+		lampShader.setUniformMatrix("projection", projection, false);
+		lampShader.unbind();
+	});
+
+	for (FrameGraphResource shadowMap : shadowMaps)
+	{
+		shadows.write(shadowMap, GL_NONE);
+		scene.read(shadowMap);
+	}
+	scene.write(hdrColor).write(hdrDepth, GL_DEPTH_ATTACHMENT);
+
+	// render on screen
+	frameGraph.addPass("tonemap", [this](const FrameGraph& graph)
+	{
+		hdrShader.bind();
+		hdrShader.setTexture(GL_TEXTURE_2D, "hdrBuffer", graph.getTexture(hdrColor));
+		hdrQuad.draw();
+		hdrShader.unbind();
+	}).read(hdrColor).setSideEffects();
+}
+
+void InstancingDemoLevel::update(Window& window)
+{
+	float dt = window.getLastFrameTime();
+	float t = window.getCurrentTime();
+
+	// update fire's particles, and make its light flicker
+	update_fire(coloredQuads, dt);
+	move_swarm(swarm, t);
+	const glm::vec3& ambient  = instancingDemoParams::pointLightAmbient;
+	const glm::vec3& diffuse  = instancingDemoParams::pointLightDiffuse;
+	const glm::vec3& specular = instancingDemoParams::pointLightSpecular;
+	if (int(t / dt) % 10 == 0)
+	{
+		float addLight = 0.05 * ((rand() / (RAND_MAX + 1.0f)) - 0.5);
+		pointLights.at(0).ambientColor = ambient + 0.5f * addLight;
+		pointLights.at(0).specularColor = specular + 2.0f*addLight;
+		pointLights.at(0).diffuseColor = diffuse + 2.0f*addLight;
+	}
+	if (int(t / dt) % 3 == 0)
+	{
+		float addLight = 0.02 * ((rand() / (RAND_MAX + 1.0f)) - 0.5);
+		pointLights.at(0).ambientColor = ambient + 0.5f * addLight;
+		pointLights.at(0).specularColor = specular + 2.0f*addLight;
+		pointLights.at(0).diffuseColor = diffuse + 2.0f*addLight;
+		float z_shift = 0.05f*((rand() / (RAND_MAX + 1.0f)) - 0.5);
+		pointLights.at(0).eye = glm::vec3{ +0.0f, 1.1f + z_shift, 0.0f };
+	}
+
+	// moving the sun
+	float height = instancingDemoParams::sunHeight;
+	sunAngle = command_sun(sunAngle, dt, window);
+	float light = 0.5f * (glm::sin(0.25f * sunAngle)) + 0.5f;
+	suns.at(0).eye = glm::vec3{ 4.0f, height * glm::sin(0.25f*sunAngle), height * glm::cos(0.25f*sunAngle) };
+	suns.at(0).ambientColor  = light * instancingDemoParams::sunAmbient0;
+	suns.at(0).diffuseColor  = light * instancingDemoParams::sunDiffuse0;
+	suns.at(0).specularColor = light * instancingDemoParams::sunSpecular;
+	backgroundColor = sky_color(suns.at(0).eye.y, height);
+
+	// commands
+	camera.processCommands(window);
+}
@@ -1 +1,126 @@
 #pragma once
+
+/* maths */
+#include <glm/glm.hpp>
+
+/* rendering engine */
+#include "../../Window/Window.h"
+#include "../../Camera/Camera.h"
+#include "../../Model/Model.h"
+#include "../../lighting/SunLight.h"
+#include "../../lighting/PointLight.h"
+#include "../../lighting/ShadowMap2D.h"
+#include "../../lighting/ShadowCubeMap.h"
+#include "../../buffers/FrameBuffer.h"
+#include "../../buffers/GeometryPool.h"
+#include "../../Renderer/Simple3DRenderer.h"
+#include "../../Renderer/FrameUniforms.h"
+#include "../../Renderer/FrameGraph.h"
+#include "../../Renderer/InstanceSet.h"
+#include "../ParticleSystem.h"
+#include "../GameLevel.h"
+
+/* stl */
+#include <vector>
+#include <string>
+#include <map>
+
+
+
+namespace instancingDemoParams
+{
+	const float sun_nearPlane = 1.1f;
+	const float sun_farPlane = 50.0f;
+	const float sun_left = -10.0f;
+	const float sun_right = 10.0f;
+	const float sun_down = -10.0f;
+	const float sun_up = 10.0f;
+	const float sunHeight = 4.0f;
+	const glm::vec3 sunAmbient0 = 1.0f * 0.1f * glm::vec3{ 1.0f };
+	const glm::vec3 sunDiffuse0 = 1.0f * 0.8f * glm::vec3{ 1.0f };
+	const glm::vec3 sunSpecular = 1.0f * 1.0f * glm::vec3{ 1.0f, 1.0f, 1.0f };
+
+	// the fire
+	const glm::vec3 pointLightAmbient = 1.0f * 0.1f * 0.1f * glm::vec3{ 1.0f, 0.65f, 0.65f / 5.0f };
+	const glm::vec3 pointLightDiffuse = 1.0f * 1.0f * 0.8f * glm::vec3{ 1.0f, 0.65f, 0.65f / 5.0f };
+	const glm::vec3 pointLightSpecular = 1.0f * 1.0f * 1.0f * glm::vec3{ 1.0f, 0.65f, 0.65f / 5.0f };
+	const float pointLightConstant = 0.001f;
+	const float pointLightLinear = 0.05f;
+	const float pointLightQuadratic = 0.1f;
+
+	// the swarm: small pyramids circling the fire, moved every frame and submitted in parallel
+	const size_t swarmSize = 4000;
+}
+
+
+//! The instancing demo: a fire of colored quads in a ring of instanced cubes, lit by a moving sun.
+class InstancingDemoLevel : public GameLevel
+{
+public:
+	InstancingDemoLevel(const Window& window, std::map<std::string, Texture>& loadedTextures);
+	void render(const Window& window) override;
+	void update(Window& window) override;
+
+	// demo specific data
+	// Camera and view
+	Camera    camera;
+	glm::mat4 projection;
+
+	// 3D models
+	Model cube;
+	Model sphere;
+	Model piramid;
+	Model parquet;
+	Model quad;
+	Transform cubeTransform;
+	Transform cubeTransform2;
+	Transform cubeTransform3;
+	Transform sphereTransform;
+	Transform piramidTransform;
+	Transform parquetTransform;
+	std::vector<Transform> swarm;
+
+	// Shaders
+	Shader hdrShader;
+	Shader shadowShader;
+	Shader cubeMapShader;
+	Shader lampShader;
+	Shader cubeDepthShader;
+	Shader shader;
+	Shader debugDepth;
+	Shader instancesColoredQuadsShader;
+	Shader instancesObjectsShader;
+	Shader instancesSunShadowShader;
+	Shader instancesCubeDepthShader;
+	// the cubes use the compact instance format, with its own shaders
+	Shader instancesCompactObjectsShader;
+	Shader instancesCompactSunShadowShader;
+	Shader instancesCompactCubeDepthShader;
+
+	// Renderers and instances
+	GeometryPool     geometryPool;   // the models drawn by simple3DRenderer, for its multi-draws
+	Simple3DRenderer simple3DRenderer;
+	FrameUniforms    frameUniforms;
+	InstanceSetQuads<Particle>                 coloredQuads;
+	InstanceSet<Particle, CompactInstanceData> cubesSet;
+
+	// lights
+	std::vector<SunLight>      suns;
+	std::vector<ShadowMap2D>   sunShadows;
+	std::vector<PointLight>    pointLights;
+	std::vector<ShadowCubeMap> pointShadows;
+	float                      sunAngle;
+	// names of the shadow samplers, built once instead of every frame
+	std::vector<std::string>   shadowMapNames;
+	std::vector<std::string>   cubeDepthMapNames;
+
+	// passes: shadows, HDR scene and tonemap
+	FrameGraph         frameGraph;
+	FrameGraphResource hdrColor;
+	ScreenQuad         hdrQuad;
+	glm::vec3          backgroundColor;
+
+private:
+	//!< Declares the passes of the frame. The window must outlive the level.
+	void buildFrameGraph(const Window& window);
+};
@@ -17,6 +17,7 @@
 #include "../../lighting/ShadowCubeMap.h"
 #include "../../buffers/FrameBuffer.h"
 #include "../../Renderer/Simple3DRenderer.h"
+#include "../../Renderer/FrameUniforms.h"
 #include "../../Renderer/InstanceSet.h"
 #include "../ParticleSystem.h"
 
@@ -32,3 +33,10 @@
 #define FLATRAND float(rand())/(RAND_MAX + 1)
 
 int demo_instancing();
+
+// pieces of the instancing demo (see InstancingDemoLevel)
+void      position_cubes(InstanceSet<Particle, CompactInstanceData>& cubes);
+float     command_sun(float angle, float dt, Window& window);
+void      update_fire(InstanceSetQuads<Particle>& coloredQuads, float dt);
+void      move_swarm(std::vector<Transform>& swarm, float t);
+glm::vec3 sky_color(float sunHeight, float maxHeight);
@@ -1,4 +1,9 @@
 #include "OutBreak.h"
+#include "../../utils/GpuProfiler.h"
+#include "../../utils/CpuProfiler.h"
+#include "../../Renderer/RenderStats.h"
+#include "../../utils/FrameArena.h"
+#include "../../utils/AllocationTracker.h"
 
 
 
@@ -26,19 +31,32 @@ void OutBreak::execute()
 	}
 
 
+	bool statsKeyDown = false;
 	while (!window.isClosed())
 	{
+		CPU_PROFILE_SCOPE("OutBreak::execute frame");
+
 		// ******* first stuff to do
 		window.updateTime();
+		memory::FrameArena::shared().beginFrame();
+		RenderStats::reset();
+		AllocationTracker::beginFrame();
+		GpuProfiler::shared().beginFrame();
 		window.clearColorBufferBit(0.5f, 0.5f, 0.5f, 1.0f);
 
 
 		// ******* graphics, physics and game logic
 			// graphics
-		levels.front().render(window);
+		{
+			CPU_PROFILE_SCOPE("OutBreakLevel::render");
+			levels.front().render(window);
+		}
 		
 			// game logic: commands, events
-		levels.front().update(window);
+		{
+			CPU_PROFILE_SCOPE("OutBreakLevel::update");
+			levels.front().update(window);
+		}
 		
 		// ******* advance levels
 		if (levels.front().status() == GAME_WIN)
@@ -55,7 +73,22 @@ void OutBreak::execute()
 		}
 
 		// ******* last stuff to do
-		window.swapBuffers();
+		GpuProfiler::shared().endFrame();
+		// F3 logs the counters of the frame (and the allocations of the previous one)
+		bool logStats = (glfwGetKey(window.getGLFWwindow(), GLFW_KEY_F3) == GLFW_PRESS);
+		if (logStats && !statsKeyDown)
+		{
+			RenderStats::dump(std::cout);
+			if (AllocationTracker::isEnabled())
+			{
+				AllocationTracker::dump(std::cout);
+			}
+		}
+		statsKeyDown = logStats;
+		{
+			CPU_PROFILE_SCOPE("Window::swapBuffers");
+			window.swapBuffers();
+		}
 		window.pollEvents();
 		window.updateLastFrameTime();
 	}
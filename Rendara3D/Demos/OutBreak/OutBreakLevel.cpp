@@ -16,6 +16,8 @@ OutBreakLevel::OutBreakLevel(Window& window, std::map<std::string, Texture>* loa
 	pointLight{ pointLightPosition, ambient, diffuse, specular, constant, linear, quadratic },
 	pointShadow{ 1024, 1024 },
 	hdrQuad{},
+	/************ retained objects ************/
+	scene{4},
 	/************ instance sets ************/
 	bricksIron{50},
 	bricksWood{50},
@@ -37,17 +39,15 @@ OutBreakLevel::OutBreakLevel(Window& window, std::map<std::string, Texture>* loa
 	hdrShader                  = std::move(Shader{ "./res/shaders/hdr.shader"});
 	instancesObjectsShader     = std::move(Shader{ "./res/shaders/instances_objects_wlights.shader"});
 
-	// HDR framebuffer initialization
-	hdrFB.attach2DTexture(GL_COLOR_ATTACHMENT0, window.getWidth(), window.getHeight(), 4, RGBA16, GL_FLOAT);
-	hdrFB.attachRenderBuffer(GL_DEPTH_COMPONENT, window.getWidth(), window.getHeight());
-	if (!hdrFB.iscomplete())
-	{
-		std::cerr << "Framebuffer not complete!" << std::endl;
-	}
+	// identical objects drawn through simple3DRenderer are instanced with the same shader as the bricks
+	simple3DRenderer.setInstancedShader(&objectsShader, &instancesObjectsShader);
+
 	hdrShader.bind();
 	hdrShader.setUniformValue("exposure", 1.0f);
 	hdrShader.unbind();
-	
+
+	// shadows, HDR scene and tonemap
+	buildFrameGraph(window);
 }
 
 // Example for level creation:
@@ -127,6 +127,9 @@ void OutBreakLevel::load(const std::vector<std::vector<int> >& layout)
 	background.transform.position = glm::vec3{ maxCols / 2.0 - 0.5f * bricksize, 0.0f,maxCols / 2.0 - 0.5f * bricksize };
 	background.transform.rotation = glm::vec3{ 0.0f,0.0f,0.0f };
 	background.model = &parquetModel;
+	scene.clear();
+	scene.add({ background.model, background.transform, &objectsShader });
+	simple3DRenderer.setScene(&scene);
 
 	// player initialization
 	player.transform.scale = glm::vec3{0.5f,1.0f,2.0f};
@@ -156,94 +159,100 @@ void OutBreakLevel::load(const std::vector<std::vector<int> >& layout)
 void OutBreakLevel::render(Window& window)
 {
 
-	// submit to simple3Drenderer objects that do not need instancing
+	// submit to simple3Drenderer objects that do not need instancing (the background is in the scene)
+	simple3DRenderer.setViewPoint(camera.getEye());
+	simple3DRenderer.setFrustum(camera.getFrustum(projection));
 	simple3DRenderer.submit({player.model, player.transform,        &objectsShader});
 	simple3DRenderer.submit({ball.model, ball.transform,            &objectsShader});
-	simple3DRenderer.submit({background.model, background.transform,&objectsShader});
-
-	// clear shadows
-	sunShadowMap.clearShadows();
-	pointShadow.clearShadows();
-
-	// calculate sunlight's shadows
-	sunShadowMap.startShadows(window, sunShadowShader, &sun);
-	simple3DRenderer.draw(&sunShadowShader);
-	sunShadowMap.stopShadows(window, sunShadowShader);
-
-	sunShadowMap.startShadows(window, instancesSunShadowShader, &sun);
-	bricksIron.drawInstances(instancesSunShadowShader);
-	bricksWood.drawInstances(instancesSunShadowShader);
-	bricksPaper.drawInstances(instancesSunShadowShader);
-	particles.drawInstances(instancesSunShadowShader);
-	sunShadowMap.stopShadows(window, instancesSunShadowShader);
-
-	// calculate pointlight's shadows
-	pointShadow.startShadows(window, cubeDepthShader, pointLight);
-	simple3DRenderer.draw(&cubeDepthShader);
-	pointShadow.stopShadows(window, cubeDepthShader);
-
-	pointShadow.startShadows(window, instancesCubeDepthShader, pointLight);
-	bricksIron.drawInstances(instancesCubeDepthShader);
-	bricksWood.drawInstances(instancesCubeDepthShader);
-	bricksPaper.drawInstances(instancesCubeDepthShader);
-	particles.drawInstances(instancesCubeDepthShader);
-	pointShadow.stopShadows(window, instancesCubeDepthShader);
-	
-	
-	// render the scene
-	// enable HDR framebuffer
-	hdrFB.bind();
-	window.clearColorBufferBit(0.5f, 0.5f, 0.5f, 1.0f);
 
+	// shadows, hdr scene and tonemap (see buildFrameGraph)
+	frameGraph.execute((int)window.getWidth(), (int)window.getHeight());
+}
 
-	objectsShader.bind();
-	objectsShader.setUniformMatrix("view", camera.getViewMatrix(), false);
-	objectsShader.setUniformMatrix("projection", projection, false);
-	objectsShader.setUniformValue("cameraPos", camera.getEye());
-
-	// cast the light and use the shadow
-	sun.cast("sun[0]", objectsShader);
-	sunShadowMap.passUniforms(objectsShader, "shadowMap[0]", "lightSpaceMatrix[0]", sun.getViewMatrix());
-
-	pointLight.cast("pointLights[0]", objectsShader);
-	pointShadow.passUniforms(objectsShader, "cubeDepthMap[0]", "farPlane");
-
-	// now the instances
-	instancesObjectsShader.bind();
-	instancesObjectsShader.setUniformMatrix("view", camera.getViewMatrix(), false);
-	instancesObjectsShader.setUniformMatrix("projection", projection, false);
-	instancesObjectsShader.setUniformValue("cameraPos", camera.getEye());
-
-	sun.cast("sun[0]", instancesObjectsShader);
-	sunShadowMap.passUniforms(instancesObjectsShader, "shadowMap[0]", "lightSpaceMatrix[0]", sun.getViewMatrix());
-	pointLight.cast("pointLights[0]", instancesObjectsShader);
-	pointShadow.passUniforms(instancesObjectsShader, "cubeDepthMap[0]", "farPlane");
-
-	// draw new stuff renderer
-	simple3DRenderer.draw();
-	simple3DRenderer.clear();
-	
-	bricksIron.drawInstances( instancesObjectsShader);
-	bricksWood.drawInstances( instancesObjectsShader);
-	bricksPaper.drawInstances(instancesObjectsShader);
-	particles.drawInstances(instancesObjectsShader);
-
-	instancesColoredQuadsShader.bind();
-	instancesColoredQuadsShader.setUniformMatrix("view", camera.getViewMatrix(), false);
-	instancesColoredQuadsShader.setUniformMatrix("projection", projection, false);
-	instancesColoredQuadsShader.setUniformValue("brightness", 1.0f);
-	coloredQuads.drawInstances(instancesColoredQuadsShader);
+void OutBreakLevel::buildFrameGraph(const Window& window)
+{
+	const Window* target = &window;
+	FrameGraphResource sunShadowTexture   = frameGraph.importTexture("sun shadow map", sunShadowMap.getTextureID());
+	FrameGraphResource pointShadowTexture = frameGraph.importTexture("point shadow map", pointShadow.getTextureID());
+	FrameGraphResource hdrColor           = frameGraph.createTexture("hdr color", { 0, 0, GL_RGBA16 });
+	FrameGraphResource hdrDepth           = frameGraph.createTexture("hdr depth", { 0, 0, GL_DEPTH_COMPONENT24 });
+	frameGraph.setClearColor(hdrColor, glm::vec4{ 0.5f, 0.5f, 0.5f, 1.0f });
+
+	// the shadow maps render with their own framebuffers
+	frameGraph.addPass("shadows", [this, target](const FrameGraph&)
+	{
+		const Window& window = *target;
+		// clear shadows
+		sunShadowMap.clearShadows();
+		pointShadow.clearShadows();
+
+		// calculate sunlight's shadows
+		sunShadowMap.startShadows(window, sunShadowShader, &sun);
+		simple3DRenderer.draw(&sunShadowShader);
+		sunShadowMap.stopShadows(window, sunShadowShader);
+
+		sunShadowMap.startShadows(window, instancesSunShadowShader, &sun);
+		bricksIron.drawInstances(instancesSunShadowShader);
+		bricksWood.drawInstances(instancesSunShadowShader);
+		bricksPaper.drawInstances(instancesSunShadowShader);
+		particles.drawInstances(instancesSunShadowShader);
+		sunShadowMap.stopShadows(window, instancesSunShadowShader);
+
+		// calculate pointlight's shadows
+		pointShadow.startShadows(window, cubeDepthShader, pointLight);
+		simple3DRenderer.draw(&cubeDepthShader);
+		pointShadow.stopShadows(window, cubeDepthShader);
+
+		pointShadow.startShadows(window, instancesCubeDepthShader, pointLight);
+		bricksIron.drawInstances(instancesCubeDepthShader);
+		bricksWood.drawInstances(instancesCubeDepthShader);
+		bricksPaper.drawInstances(instancesCubeDepthShader);
+		particles.drawInstances(instancesCubeDepthShader);
+		pointShadow.stopShadows(window, instancesCubeDepthShader);
+	}).write(sunShadowTexture, GL_NONE).write(pointShadowTexture, GL_NONE);
 
-	// disable HDR framebuffer
-	hdrFB.unbind();
+	// render the scene
+	frameGraph.addPass("hdr scene", [this](const FrameGraph&)
+	{
+		// camera and lights, once for all the shaders
+		frameUniforms.setCamera(camera.getViewMatrix(), projection, camera.getEye());
+		frameUniforms.setSun(0, sun, sunShadowMap.getLightSpaceMatrix(sun.getViewMatrix()));
+		frameUniforms.setPointLight(0, pointLight);
+		frameUniforms.upload();
+
+		// the shadow maps
+		objectsShader.bind();
+		sunShadowMap.passUniforms(objectsShader, "shadowMap[0]");
+		pointShadow.passUniforms(objectsShader, "cubeDepthMap[0]", "farPlane");
+
+		// now the instances
+		instancesObjectsShader.bind();
+		sunShadowMap.passUniforms(instancesObjectsShader, "shadowMap[0]");
+		pointShadow.passUniforms(instancesObjectsShader, "cubeDepthMap[0]", "farPlane");
+
+		// draw new stuff renderer
+		simple3DRenderer.draw();
+		simple3DRenderer.clear();
+
+		Frustum frustum = camera.getFrustum(projection);
+		bricksIron.drawInstances( instancesObjectsShader, frustum);
+		bricksWood.drawInstances( instancesObjectsShader, frustum);
+		bricksPaper.drawInstances(instancesObjectsShader, frustum);
+		particles.drawInstances(instancesObjectsShader, frustum);
+
+		instancesColoredQuadsShader.bind();
+		instancesColoredQuadsShader.setUniformValue("brightness", 1.0f);
+		coloredQuads.drawInstances(instancesColoredQuadsShader);
+	}).read(sunShadowTexture).read(pointShadowTexture).write(hdrColor).write(hdrDepth, GL_DEPTH_ATTACHMENT);
 
 	// render on screen
-	hdrShader.bind();
-	hdrShader.setTexture(GL_TEXTURE_2D, "hdrBuffer", hdrFB.getAttachedTextureID(0));
-	hdrQuad.draw();
-	hdrShader.unbind();
-
-
+	frameGraph.addPass("tonemap", [this, hdrColor](const FrameGraph& graph)
+	{
+		hdrShader.bind();
+		hdrShader.setTexture(GL_TEXTURE_2D, "hdrBuffer", graph.getTexture(hdrColor));
+		hdrQuad.draw();
+		hdrShader.unbind();
+	}).read(hdrColor).setSideEffects();
 }
 
 void OutBreakLevel::update(Window& window)
@@ -262,15 +271,11 @@ void OutBreakLevel::update(Window& window)
 	coloredQuads.push_back(newParticle);
 	// update time of all particles and kill old particles
 
-	for (size_t i = 0; i < coloredQuads.size(); i++)
+	coloredQuads.updateElements([dt](Particle& particle)
 	{
-		Particle particle = coloredQuads.getElement(i);
 		particle.tau -= dt;
-		if (particle.tau <= 0.0f)
-			coloredQuads.deleteElement(i);
-		else
-			coloredQuads.setElement(i, particle);
-	}
+		return particle.tau > 0.0f;
+	});
 
 
 	// update position of the ball
@@ -362,6 +367,11 @@ void OutBreakLevel::processCommands(Window& window)
 
 }
 
+void OutBreakLevel::followBall()
+{
+	player.transform.position.z = ball.transform.position.z;
+}
+
 
 GameState OutBreakLevel::status()
 {
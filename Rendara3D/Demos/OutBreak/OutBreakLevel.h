@@ -14,6 +14,8 @@
 #include <string>
 
 #include "../../Renderer/Simple3DRenderer.h"
+#include "../../Renderer/FrameUniforms.h"
+#include "../../Renderer/FrameGraph.h"
 #include "./Players.h"
 
 #include "../GameState.h"
@@ -51,11 +53,14 @@ public:
 	void render(Window& window);
 	void update(Window& window);
 	GameState status();
+	//!< Moves the player under the ball: plays without the keyboard (scripted runs, see benchmark_scenes).
+	void followBall();
 private:
 	void processCommands(Window& window);
 
 private:
 	Simple3DRenderer simple3DRenderer;
+	FrameUniforms    frameUniforms;
 
 	//************* camera *************/
 	Camera camera;
@@ -68,6 +73,8 @@ private:
 
 	// background
 	GameObject background;
+	// objects that never move, drawn by simple3DRenderer without being submitted every frame
+	RenderScene scene;
 
 	// bricks
 	InstanceSet<Brick> bricksIron;
@@ -117,8 +124,10 @@ private:
 	Shader instancesCubeDepthShader;
 	Shader instancesColoredQuadsShader;
 
-	/* Framebuffers */
-	// HDR framebuffer
-	FrameBuffer hdrFB;
+	/* passes: shadows, HDR scene and tonemap */
+	FrameGraph frameGraph;
 	ScreenQuad hdrQuad;
+
+	//!< Declares the passes of the frame. The window must outlive the level.
+	void buildFrameGraph(const Window& window);
 };
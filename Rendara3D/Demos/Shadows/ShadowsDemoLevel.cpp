@@ -44,74 +44,108 @@ ShadowsDemoLevel::ShadowsDemoLevel(const Window& window, std::map<std::string, T
 						   shadowsDemoParams::pointLightQuadratic };
 	//pointLightShadow = std::move(ShadowCubeMap(1024, 1024));
 
-	/* HDR */
-	hdrFB.attach2DTexture(GL_COLOR_ATTACHMENT0, window.getWidth(), window.getHeight(), 4, RGBA16, GL_FLOAT);
-	hdrFB.attachRenderBuffer(GL_DEPTH_COMPONENT, window.getWidth(), window.getHeight());
-	if (!hdrFB.iscomplete())
-	{
-		std::cerr << "Framebuffer not complete!" << std::endl;
-		// TODO: add proper logging
-	}
-
+	/* passes */
+	buildFrameGraph(window);
 }
 
 
 void ShadowsDemoLevel::render(const Window& window)
 {
+	serialSnapshot.clear();
+	serialSnapshot.width = (int)window.getWidth();
+	serialSnapshot.height = (int)window.getHeight();
+	capture(serialSnapshot);
+	renderSnapshot(window, serialSnapshot);
+}
+
+void ShadowsDemoLevel::capture(FrameSnapshot& snapshot)
+{
+	snapshot.camera = camera;
+	snapshot.projection = projection;
+	snapshot.suns.push_back(sun);
+	snapshot.pointLights.push_back(pointLight);
+	snapshot.objects.push_back({ &cube, cubeTransform      , &shader });
+	snapshot.objects.push_back({ &sphere, sphereTransform  , &shader });
+	snapshot.objects.push_back({ &parquet, parquetTransform, &shader });
+	snapshot.objects.push_back({ &cube, Transform{ pointLight.eye, glm::vec3{0.0f}, glm::vec3{.02f} }, &lampShader });
+}
+
+void ShadowsDemoLevel::renderSnapshot(const Window& /*window*/, const FrameSnapshot& snapshot)
+{
+	frame = &snapshot;
+
 	// submit to simple renderer non instanced objects
-	simple3DRenderer.submit({ &cube, cubeTransform      , &shader });
-	simple3DRenderer.submit({ &sphere, sphereTransform  , &shader });
-	simple3DRenderer.submit({ &parquet, parquetTransform, &shader });
-	simple3DRenderer.submit({ &cube, Transform{ pointLight.eye, glm::vec3{0.0f}, glm::vec3{.02f} }, &lampShader });
-
-	// clear the shadow maps
-	sunShadow.clearShadows();
-	pointLightShadow.clearShadows();
-
-	// draw shadowmaps
-	sunShadow.startShadows(window, shadowShader, &sun);
-	simple3DRenderer.draw(&shadowShader);
-	sunShadow.stopShadows(window, shadowShader);
-
-	pointLightShadow.startShadows(window, cubeDepthShader, pointLight);
-	simple3DRenderer.draw(&cubeDepthShader);
-	pointLightShadow.stopShadows(window, cubeDepthShader);
-
-	// prepare shader for objects
-	shader.bind();
-	shader.setUniformMatrix("projection", projection, false);
-	shader.setUniformValue("cameraPos", camera.getEye());
-	shader.setUniformMatrix("view", camera.getViewMatrix(), false);
-
-	sun.cast("sun[0]", shader);
-	sunShadow.passUniforms(shader, "shadowMap[0]", "lightSpaceMatrix[0]", sun.getViewMatrix());
-	pointLight.cast("pointLights[0]", shader);
-	pointLightShadow.passUniforms(shader, "cubeDepthMap[0]", "farPlane");
-	shader.unbind();
-
-	// activate hdr framebuffer
-	hdrFB.bind();
-	window.clearColorBufferBit(0.5f, 0.5f, 0.5f, 1.0f);
-	// draw stuff
-	simple3DRenderer.draw();
-	// lamps's shaders
-	lampShader.bind();
-	lampShader.setUniformMatrix("view", camera.getViewMatrix(), false);
-	lampShader.setUniformMatrix("projection", projection, false);
-	lampShader.unbind();
-
-	// disable HDR framebuffer
-	hdrFB.unbind();
+	simple3DRenderer.setViewPoint(snapshot.camera.getEye());
+	simple3DRenderer.setFrustum(snapshot.camera.getFrustum(snapshot.projection));
+	for (size_t i = 0; i < snapshot.objects.size(); i++)
+	{
+		simple3DRenderer.submit(snapshot.objects.at(i));
+	}
 
-	// render on screen
-	hdrShader.bind();
-	hdrShader.setTexture(GL_TEXTURE_2D, "hdrBuffer", hdrFB.getAttachedTextureID(0));
-	hdrQuad.draw();
-	hdrShader.unbind();
+	// shadows, hdr scene and tonemap (see buildFrameGraph)
+	frameGraph.execute(snapshot.width, snapshot.height);
 
 	// clear renderers
 	simple3DRenderer.clear();
+	frame = nullptr;
+}
+
+void ShadowsDemoLevel::buildFrameGraph(const Window& window)
+{
+	const Window* target = &window;
+	FrameGraphResource sunShadowMap   = frameGraph.importTexture("sun shadow map", sunShadow.getTextureID());
+	FrameGraphResource pointShadowMap = frameGraph.importTexture("point shadow map", pointLightShadow.getTextureID());
+	FrameGraphResource hdrColor       = frameGraph.createTexture("hdr color", { 0, 0, GL_RGBA16 });
+	FrameGraphResource hdrDepth       = frameGraph.createTexture("hdr depth", { 0, 0, GL_DEPTH_COMPONENT24 });
+	frameGraph.setClearColor(hdrColor, glm::vec4{ 0.5f, 0.5f, 0.5f, 1.0f });
+
+	// the shadow maps render with their own framebuffers
+	frameGraph.addPass("shadows", [this, target](const FrameGraph&)
+	{
+		sunShadow.clearShadows();
+		pointLightShadow.clearShadows();
 
+		sunShadow.startShadows(*target, shadowShader, &frame->suns.at(0));
+		simple3DRenderer.draw(&shadowShader);
+		sunShadow.stopShadows(*target, shadowShader);
+
+		pointLightShadow.startShadows(*target, cubeDepthShader, frame->pointLights.at(0));
+		simple3DRenderer.draw(&cubeDepthShader);
+		pointLightShadow.stopShadows(*target, cubeDepthShader);
+	}).write(sunShadowMap, GL_NONE).write(pointShadowMap, GL_NONE);
+
+	frameGraph.addPass("hdr scene", [this](const FrameGraph&)
+	{
+		// prepare shader for objects
+		const Camera& camera = frame->camera;
+		const SunLight& sun = frame->suns.at(0);
+		frameUniforms.setCamera(camera.getViewMatrix(), frame->projection, camera.getEye());
+		frameUniforms.setSun(0, sun, sunShadow.getLightSpaceMatrix(sun.getViewMatrix()));
+		frameUniforms.setPointLight(0, frame->pointLights.at(0));
+		frameUniforms.upload();
+
+		shader.bind();
+		sunShadow.passUniforms(shader, "shadowMap[0]");
+		pointLightShadow.passUniforms(shader, "cubeDepthMap[0]", "farPlane");
+		shader.unbind();
+
+		// draw stuff
+		simple3DRenderer.draw();
+		// lamps's shaders
+		lampShader.bind();
+		lampShader.setUniformMatrix("view", camera.getViewMatrix(), false);
+		lampShader.setUniformMatrix("projection", frame->projection, false);
+		lampShader.unbind();
+	}).read(sunShadowMap).read(pointShadowMap).write(hdrColor).write(hdrDepth, GL_DEPTH_ATTACHMENT);
+
+	// render on screen
+	frameGraph.addPass("tonemap", [this, hdrColor](const FrameGraph& graph)
+	{
+		hdrShader.bind();
+		hdrShader.setTexture(GL_TEXTURE_2D, "hdrBuffer", graph.getTexture(hdrColor));
+		hdrQuad.draw();
+		hdrShader.unbind();
+	}).read(hdrColor).setSideEffects();
 }
 
 void ShadowsDemoLevel::update(Window& window)
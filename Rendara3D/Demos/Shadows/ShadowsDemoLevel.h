@@ -17,6 +17,8 @@
 #include "../../lighting/ShadowCubeMap.h"
 #include "../../buffers/FrameBuffer.h"
 #include "../../Renderer/Simple3DRenderer.h"
+#include "../../Renderer/FrameUniforms.h"
+#include "../../Renderer/FrameGraph.h"
 #include "../GameLevel.h"
 
 /* stl */
@@ -53,6 +55,10 @@ public:
 	ShadowsDemoLevel(const Window& window, std::map<std::string, Texture>& loadedTextures);
 	void render(const Window& window) override;
 	void update(Window& window) override;
+	// the level can be drawn by a render thread: the passes read the camera, the lights and the objects from the snapshot
+	bool hasSnapshots() const override { return true; }
+	void capture(FrameSnapshot& snapshot) override;
+	void renderSnapshot(const Window& window, const FrameSnapshot& snapshot) override;
 
 	// demo specific data
 	// Camera and view
@@ -78,6 +84,7 @@ public:
 
 	// Renderers
 	Simple3DRenderer simple3DRenderer;
+	FrameUniforms    frameUniforms;
 
 	// lights
 	SunLight      sun;
@@ -85,9 +92,17 @@ public:
 	PointLight    pointLight;
 	ShadowCubeMap pointLightShadow;
 
-	// HDR
-	FrameBuffer hdrFB;
-	ScreenQuad  hdrQuad;
+	// passes: shadows, HDR scene and tonemap
+	FrameGraph frameGraph;
+	ScreenQuad hdrQuad;
+
+private:
+	FrameSnapshot        serialSnapshot;   // captured by render, when the level runs on a single thread
+	const FrameSnapshot* frame = nullptr;  // drawn by the passes
+
+
+	//!< Declares the passes of the frame. The window must outlive the level.
+	void buildFrameGraph(const Window& window);
 
 
 };
@@ -0,0 +1,133 @@
+#pragma once
+
+/* stl */
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+/* maths */
+#include <glm/glm.hpp>
+
+
+//! Axis aligned bounding box. A default constructed box is empty (min > max).
+struct AABB
+{
+	AABB() : min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max()) {}
+	AABB(const glm::vec3& minIn, const glm::vec3& maxIn) : min(minIn), max(maxIn) {}
+
+	glm::vec3 min;
+	glm::vec3 max;
+
+	bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+	glm::vec3 getCenter()  const { return 0.5f * (min + max); }
+	glm::vec3 getExtents() const { return 0.5f * (max - min); }
+
+	void expand(const glm::vec3& point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	void expand(const AABB& other)
+	{
+		if (other.isEmpty()) return;
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+
+	//!< Box that contains this one after the transformation (the box of the transformed corners).
+	AABB transformed(const glm::mat4& matrix) const
+	{
+		if (isEmpty()) return *this;
+		glm::vec3 center = glm::vec3{ matrix * glm::vec4{ getCenter(), 1.0f } };
+		glm::vec3 extents = getExtents();
+		glm::vec3 newExtents{ 0.0f };
+		for (int row = 0; row < 3; row++)
+		{
+			newExtents[row] = std::abs(matrix[0][row]) * extents.x + std::abs(matrix[1][row]) * extents.y + std::abs(matrix[2][row]) * extents.z;
+		}
+		return AABB{ center - newExtents, center + newExtents };
+	}
+};
+
+
+//! Bounding sphere. A negative radius means empty.
+struct BoundingSphere
+{
+	BoundingSphere() : center(0.0f), radius(-1.0f) {}
+	BoundingSphere(const glm::vec3& centerIn, float radiusIn) : center(centerIn), radius(radiusIn) {}
+
+	glm::vec3 center;
+	float     radius;
+
+	bool isEmpty() const { return radius < 0.0f; }
+
+	//!< Sphere that contains this one after the transformation. The radius is scaled by the largest scale of the matrix.
+	BoundingSphere transformed(const glm::mat4& matrix) const
+	{
+		if (isEmpty()) return *this;
+		float scale = std::max(glm::length(glm::vec3{ matrix[0] }), std::max(glm::length(glm::vec3{ matrix[1] }), glm::length(glm::vec3{ matrix[2] })));
+		return BoundingSphere{ glm::vec3{ matrix * glm::vec4{ center, 1.0f } }, radius * scale };
+	}
+};
+
+
+//! Box and sphere of a Mesh or Model, in model space.
+/*!
+	The sphere is centered in the center of the box, with the radius reaching the farthest point
+	(not the minimal sphere, but tighter than the one enclosing the box).
+*/
+struct Bounds
+{
+	AABB           box;
+	BoundingSphere sphere;
+
+	bool isEmpty() const { return box.isEmpty(); }
+
+	//!< Bounds of a set of points, each read as 3 floats every stride floats.
+	static Bounds fromPoints(const float* points, size_t count, size_t stride)
+	{
+		Bounds bounds;
+		for (size_t i = 0; i < count; i++)
+		{
+			bounds.box.expand(glm::vec3{ points[i * stride], points[i * stride + 1], points[i * stride + 2] });
+		}
+		if (bounds.box.isEmpty()) return bounds;
+
+		glm::vec3 center = bounds.box.getCenter();
+		float radius2 = 0.0f;
+		for (size_t i = 0; i < count; i++)
+		{
+			glm::vec3 d = glm::vec3{ points[i * stride], points[i * stride + 1], points[i * stride + 2] } - center;
+			radius2 = std::max(radius2, glm::dot(d, d));
+		}
+		bounds.sphere = BoundingSphere{ center, std::sqrt(radius2) };
+		return bounds;
+	}
+
+	//!< Grows these bounds to contain the other ones.
+	void merge(const Bounds& other)
+	{
+		if (other.isEmpty()) return;
+		if (isEmpty())
+		{
+			*this = other;
+			return;
+		}
+		box.expand(other.box);
+
+		// smallest sphere containing both spheres
+		glm::vec3 d = other.sphere.center - sphere.center;
+		float distance = glm::length(d);
+		if (distance + other.sphere.radius <= sphere.radius) return;
+		if (distance + sphere.radius <= other.sphere.radius)
+		{
+			sphere = other.sphere;
+			return;
+		}
+		float radius = 0.5f * (distance + sphere.radius + other.sphere.radius);
+		sphere.center = sphere.center + d * ((radius - sphere.radius) / distance);
+		sphere.radius = radius;
+	}
+};
@@ -1,4 +1,5 @@
 #include "Mesh.h"
+#include "../Renderer/RenderStats.h"
 
 
 void Mesh::fill(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const Material& material)
@@ -130,11 +131,23 @@ void Mesh::actualDraw(const glm::vec3& scale, const glm::vec3& position, const g
 	shader.setUniformMatrix("normalMat", normalMatrix, false);
 
 
+	// the shader and the vao stay bound: drawing the next mesh with them costs no OpenGL call (see GLState)
 	m_vao.bind();
 	// draw call
 	GLCall(glDrawElements(GL_TRIANGLES, m_indices, GL_UNSIGNED_INT, 0));
-	m_vao.unbind();
-	shader.unbind();
+	RenderStats::countDraw(m_indices / 3);
+}
+
+void Mesh::drawElements() const
+{
+	GLCall(glDrawElements(GL_TRIANGLES, m_indices, GL_UNSIGNED_INT, 0));
+	RenderStats::countDraw(m_indices / 3);
+}
+
+void Mesh::drawElementsInstanced(unsigned int instances) const
+{
+	GLCall(glDrawElementsInstanced(GL_TRIANGLES, m_indices, GL_UNSIGNED_INT, 0, instances));
+	RenderStats::countInstancedDraw(m_indices / 3, instances);
 }
 
 void Mesh::draw(const glm::vec3& scale, const glm::vec3& position, const glm::vec3& radians, Shader& shader) const
@@ -166,7 +179,7 @@ void Mesh::passMaterialUniforms(Shader& shader) const
 	passMaterialUniforms(shader, this->m_material);
 }
 
-void Mesh::passMaterialUniforms(Shader& shader, Material material) const
+void Mesh::passMaterialUniforms(Shader& shader, const Material& material) const
 {
 	shader.bind();
 	material.passUniforms(shader);
@@ -187,9 +200,10 @@ ScreenQuad::ScreenQuad()
 	// setup plane VAO
 	GLCall(glGenVertexArrays(1, &quadVAOi));
 	GLCall(glGenBuffers(1, &quadVBOi));
-	GLCall(glBindVertexArray(quadVAOi));
+	GLState::bindVertexArray(quadVAOi);
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, quadVBOi));
 	GLCall(glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW));
+	RenderStats::countBufferUpload(sizeof(quadVertices));
 	GLCall(glEnableVertexAttribArray(0));
 	GLCall(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0));
 	GLCall(glEnableVertexAttribArray(1));
@@ -198,7 +212,7 @@ ScreenQuad::ScreenQuad()
 
 void ScreenQuad::draw()
 {
-	GLCall(glBindVertexArray(quadVAOi));
+	GLState::bindVertexArray(quadVAOi);
 	GLCall(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
-	GLCall(glBindVertexArray(0));
+	RenderStats::countDraw(2);
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "../buffers/VertexArray.h"
 #include "../Texture/Texture.h"
 #include "../Shader/Shader.h"
+#include "Bounds.h"
 
 struct Vertex
 {
@@ -37,7 +38,7 @@ public:
 	void unbindVao() const { m_vao.unbind(); }
 
 	void passMaterialUniforms(Shader& shader) const;
-	void passMaterialUniforms(Shader& shader, Material material) const;
+	void passMaterialUniforms(Shader& shader, const Material& material) const;
 
 
 	void draw(float scale, const glm::vec3& position, const glm::vec3& radians, Shader& shader) const;
@@ -50,11 +51,25 @@ public:
 
 
 	unsigned int getIndices() const { return m_indices; }
+	const Material& getMaterial() const { return m_material; }
+	//!< Bounds in model space. Empty for meshes not loaded by a Model.
+	const Bounds& getBounds() const { return m_bounds; }
+	void setBounds(const Bounds& bounds) { m_bounds = bounds; }
+	//!< Vertices and indices of the mesh (see GeometryPool).
+	const VertexArray& getVertexArray() const { return m_vao; }
+
+	//!< Issues only the draw call: the vao must be bound and the shader's uniforms already passed.
+	void drawElements() const;
+	//!< Same as drawElements, for the given number of instances read from the per-instance attributes.
+	void drawElementsInstanced(unsigned int instances) const;
+	//!< Points the per-instance attributes of the vao to the buffer (see VertexArray::setInstanceAttributes). The vao must be bound.
+	void setInstanceAttributes(const Buffer& buffer, size_t offset, const InstanceLayout& layout) const { m_vao.setInstanceAttributes(buffer, offset, layout); }
 
 private:
 	VertexArray  m_vao;
 	Material     m_material;
 	unsigned int m_indices;
+	Bounds       m_bounds;
 
 	void actualDraw(const glm::vec3& scale, const glm::vec3& position, const glm::vec3& radians, Shader& shader) const;
 
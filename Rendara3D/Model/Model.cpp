@@ -1,4 +1,5 @@
 #include "Model.h"
+#include "../utils/CpuProfiler.h"
 
 void Model::draw(const glm::vec3& scale, const glm::vec3& position, const glm::vec3& radians, Shader& shader) const
 {
@@ -30,6 +31,7 @@ void Model::draw(float scale, const glm::vec3& position, const glm::vec3& radian
 
 void Model::loadModel(const std::string path, std::map<std::string, Texture>* loadedTextures)
 {
+	CPU_PROFILE_SCOPE("Model::loadModel");
 	Assimp::Importer importer;
 	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_CalcTangentSpace | aiProcess_FlipUVs);
 
@@ -42,6 +44,8 @@ void Model::loadModel(const std::string path, std::map<std::string, Texture>* lo
 	//m_directory = path.substr(0, path.find_last_of('/'));
 	
 
+	// the meshes are usually referenced once each
+	m_meshes.reserve(m_meshes.size() + scene->mNumMeshes);
 	processNode(scene->mRootNode, scene, loadedTextures);
 }
 
@@ -51,6 +55,7 @@ void Model::processNode(const aiNode* node, const aiScene* scene, std::map<std::
 	{
 		aiMesh* aimesh = scene->mMeshes[node->mMeshes[i]];
 		m_meshes.push_back(processMesh(aimesh, scene, loadedTextures));
+		m_bounds.merge(m_meshes.back().getBounds());
 	}
 
 	for (size_t i = 0; i < node->mNumChildren; i++)
@@ -69,6 +74,7 @@ Mesh Model::processMesh(const aiMesh* aimesh, const aiScene* scene, std::map<std
 	float shininess; 
 
 	/* retrieve vertices */
+	vertices.reserve(aimesh->mNumVertices);
 	for (size_t i = 0; i < aimesh->mNumVertices; i++)
 	{
 		Vertex vertex;
@@ -95,9 +101,10 @@ Mesh Model::processMesh(const aiMesh* aimesh, const aiScene* scene, std::map<std
 
 
 	/* retrieve indices */
+	indices.reserve(3 * aimesh->mNumFaces); // triangulated
 	for (size_t i = 0; i < aimesh->mNumFaces; i++)
 	{
-		aiFace face = aimesh->mFaces[i];
+		const aiFace& face = aimesh->mFaces[i]; // a copy would allocate its own indices
 		for (size_t j = 0; j < face.mNumIndices; j++)
 		{
 			indices.push_back(face.mIndices[j]);
@@ -192,6 +199,10 @@ Mesh Model::processMesh(const aiMesh* aimesh, const aiScene* scene, std::map<std
 	material.fill(diffuse, specular, normal, shininess);
 	Mesh newMesh;
 	newMesh.fill(vertices, indices, material);
+	if (!vertices.empty())
+	{
+		newMesh.setBounds(Bounds::fromPoints(&vertices[0].position.x, vertices.size(), sizeof(Vertex) / sizeof(float)));
+	}
 	return newMesh;
 }
 
@@ -54,12 +54,15 @@ public:
 
 	const std::vector<Mesh>* getMeshes() const { return &m_meshes; }
 	const std::string& getPath() const { return m_path; }
+	//!< Bounds of all the meshes, in model space.
+	const Bounds& getBounds() const { return m_bounds; }
 
 
 private:
 	std::vector<Mesh> m_meshes;
 	std::string		  m_path;
 	glm::vec3         m_defaultColor;
+	Bounds            m_bounds;
 
 	bool              m_castsShadows;
 
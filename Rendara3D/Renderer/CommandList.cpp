@@ -0,0 +1,51 @@
+#include "CommandList.h"
+#include "RenderQueue.h"
+
+void CommandList::record(const RenderingSpecification& specification, const RecordingView& view)
+{
+	const Model*     model     = specification.model;
+	const Transform& transform = specification.transform;
+
+	// the matrices are computed once, and shared by all the meshes of the model and by all the draws of this frame
+	glm::mat4 modelMatrix = transform.getModelMatrix();
+	glm::mat4 normalMatrix = glm::mat3{ glm::inverse(glm::transpose(modelMatrix)) };
+	m_matrices.push_back({ modelMatrix, normalMatrix });
+	unsigned int matrixIndex = (unsigned int)(m_matrices.size() - 1);
+
+	unsigned int depth = 0;
+	if (view.hasViewPoint)
+	{
+		float distance = glm::length(transform.position - view.viewPoint);
+		depth = RenderQueue::quantizeDepth(distance, view.maxDepth, specification.pass == PASS_TRANSPARENT);
+	}
+
+	// the sphere of the whole model first, then the spheres of its meshes if it is partly visible
+	const std::vector<Mesh>* meshes = model->getMeshes();
+	bool modelVisible = !view.cullingEnabled || view.frustum.intersects(model->getBounds().sphere.transformed(modelMatrix));
+	bool testMeshes = view.cullingEnabled && modelVisible && meshes->size() > 1;
+
+	for (size_t i = 0; i < meshes->size(); i++)
+	{
+		const Mesh* mesh = &meshes->at(i);
+		bool visible = modelVisible;
+		if (testMeshes)
+		{
+			visible = view.frustum.intersects(mesh->getBounds().sphere.transformed(modelMatrix));
+		}
+		m_numCulled += visible ? 0 : 1;
+		m_packets.push_back({ mesh, specification.shader, specification.pass, depth, matrixIndex, visible });
+	}
+}
+
+void CommandList::clear()
+{
+	m_packets.clear();
+	m_matrices.clear();
+	m_numCulled = 0;
+}
+
+void CommandList::reserve(size_t packets, size_t objects)
+{
+	m_packets.reserve(packets);
+	m_matrices.reserve(objects);
+}
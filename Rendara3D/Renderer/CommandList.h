@@ -0,0 +1,74 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <cstddef>
+
+/* maths */
+#include <glm/glm.hpp>
+
+#include "Renderer.h"
+#include "../Camera/Frustum.h"
+
+
+//! Model and normal matrices of a recorded object, shared by the draws of all its meshes.
+struct DrawMatrices
+{
+	glm::mat4 model;
+	glm::mat4 normal;
+};
+
+//! A draw of a mesh recorded by a CommandList. Plain data: recording it touches neither OpenGL nor a renderer.
+struct DrawPacket
+{
+	const Mesh*  mesh;         //!< what is drawn (the material is the one of the mesh)
+	Shader*      shader;       //!< how it is drawn
+	RenderPass   pass;
+	unsigned int depth;        //!< quantized distance from the view point (see RenderQueue::quantizeDepth)
+	unsigned int matrixIndex;  //!< of the matrices in the list, set as uniforms or per-instance attributes
+	bool         visible;      //!< false if outside the view frustum when recorded
+};
+
+//! What a CommandList needs to record objects: where the depth is measured from, and what is culled.
+struct RecordingView
+{
+	glm::vec3 viewPoint{ 0.0f };
+	float     maxDepth = 100.0f;
+	bool      hasViewPoint = false;   //!< without it all the depths are 0
+	Frustum   frustum;
+	bool      cullingEnabled = false;
+};
+
+
+//! Draws recorded on any thread, to be merged into a renderer by the thread that owns the OpenGL context.
+/*!
+	record does the CPU work of a submission: it computes the matrices of the object, culls the model and its meshes
+	against the frustum of the view and quantizes their depth, then appends one DrawPacket per mesh. It only reads
+	the model, the meshes and the view, so different lists can be recorded at the same time by different threads
+	(e.g. one per chunk of a ThreadPool::parallelFor). Simple3DRenderer::submit(const CommandList&) merges a list:
+	it gives the packets their sort keys and pushes them into its queue, which is then sorted and drawn as usual.
+	clear keeps the memory, so a list recorded every frame stops allocating once it reached its largest size.
+*/
+class CommandList
+{
+public:
+	//!< Records the draws of all the meshes of the model.
+	void record(const RenderingSpecification& specification, const RecordingView& view);
+	//!< Forgets the draws, keeping the memory.
+	void clear();
+
+	void reserve(size_t packets, size_t objects);
+
+	size_t size() const  { return m_packets.size(); }
+	bool   empty() const { return m_packets.empty(); }
+	const DrawPacket&   at(size_t i) const         { return m_packets[i]; }
+	const DrawMatrices& matricesAt(size_t i) const { return m_matrices[i]; }
+	size_t getNumObjects() const { return m_matrices.size(); }
+	//!< Number of recorded meshes outside of the frustum.
+	size_t getNumCulled() const  { return m_numCulled; }
+
+private:
+	std::vector<DrawPacket>   m_packets;
+	std::vector<DrawMatrices> m_matrices;
+	size_t                    m_numCulled = 0;
+};
@@ -0,0 +1,576 @@
+#include "FrameGraph.h"
+#include "../utils/GLState.h"
+#include "../utils/GpuProfiler.h"
+
+/* stl */
+#include <iostream>
+#include <algorithm>
+
+/* maths */
+#include <glm/gtc/type_ptr.hpp>
+
+
+namespace {
+
+	const size_t NONE = (size_t)-1;
+
+	bool isDepthFormat(GLenum internalFormat)
+	{
+		return internalFormat == GL_DEPTH_COMPONENT || internalFormat == GL_DEPTH_COMPONENT16 || internalFormat == GL_DEPTH_COMPONENT24
+			|| internalFormat == GL_DEPTH_COMPONENT32 || internalFormat == GL_DEPTH_COMPONENT32F;
+	}
+
+	size_t bytesPerPixel(GLenum internalFormat)
+	{
+		switch (internalFormat)
+		{
+		case GL_RGBA32F:             return 16;
+		case GL_RGBA16:
+		case GL_RGBA16F:             return 8;
+		case GL_RGB16F:              return 6;
+		case GL_DEPTH_COMPONENT16:   return 2;
+		default:                     return 4;
+		}
+	}
+
+	bool sameDesc(const FrameGraphTextureDesc& a, const FrameGraphTextureDesc& b)
+	{
+		return a.width == b.width && a.height == b.height && a.internalFormat == b.internalFormat;
+	}
+
+	Texture makeTexture(const FrameGraphTextureDesc& desc)
+	{
+		GLenum format = isDepthFormat(desc.internalFormat) ? GL_DEPTH_COMPONENT : GL_RGBA;
+		Texture texture{ (int)desc.internalFormat, desc.width, desc.height, "nopath-FrameGraph", format, GL_FLOAT, nullptr };
+		// no mipmaps: the passes sample the level they rendered
+		texture.set2DTextureParameter(GL_TEXTURE_MIN_FILTER, (GLint)GL_LINEAR);
+		texture.set2DTextureParameter(GL_TEXTURE_MAG_FILTER, (GLint)GL_LINEAR);
+		texture.set2DTextureParameter(GL_TEXTURE_WRAP_S, (GLint)GL_CLAMP_TO_EDGE);
+		texture.set2DTextureParameter(GL_TEXTURE_WRAP_T, (GLint)GL_CLAMP_TO_EDGE);
+		return texture;
+	}
+
+}
+
+
+FrameGraphPassBuilder& FrameGraphPassBuilder::read(FrameGraphResource resource)
+{
+	m_graph.m_passes.at(m_pass).reads.push_back(resource);
+	m_graph.m_compiled = false;
+	return *this;
+}
+
+FrameGraphPassBuilder& FrameGraphPassBuilder::write(FrameGraphResource resource, GLenum attachment)
+{
+	m_graph.m_passes.at(m_pass).writes.push_back({ resource, attachment });
+	m_graph.m_compiled = false;
+	return *this;
+}
+
+FrameGraphPassBuilder& FrameGraphPassBuilder::setSideEffects()
+{
+	m_graph.m_passes.at(m_pass).sideEffects = true;
+	m_graph.m_compiled = false;
+	return *this;
+}
+
+
+FrameGraph::FrameGraph() : m_compiled(false), m_width(0), m_height(0)
+{
+}
+
+FrameGraph::~FrameGraph()
+{
+	for (auto& framebuffer : m_framebuffers)
+	{
+		GLCall(glDeleteFramebuffers(1, &framebuffer.second));
+		GLState::forgetFramebuffer(framebuffer.second);
+	}
+}
+
+FrameGraphResource FrameGraph::createTexture(const std::string& name, const FrameGraphTextureDesc& desc)
+{
+	m_resources.push_back({ name, desc, false, 0, glm::vec4{ 0.0f }, false, NONE });
+	m_compiled = false;
+	return (FrameGraphResource)(m_resources.size() - 1);
+}
+
+FrameGraphResource FrameGraph::importTexture(const std::string& name, unsigned int texture, int width, int height)
+{
+	m_resources.push_back({ name, { width, height, GL_NONE }, true, texture, glm::vec4{ 0.0f }, false, NONE });
+	m_compiled = false;
+	return (FrameGraphResource)(m_resources.size() - 1);
+}
+
+void FrameGraph::setClearColor(FrameGraphResource resource, const glm::vec4& color)
+{
+	m_resources.at(resource).clearColor = color;
+}
+
+void FrameGraph::markOutput(FrameGraphResource resource)
+{
+	m_resources.at(resource).output = true;
+	m_compiled = false;
+}
+
+FrameGraphPassBuilder FrameGraph::addPass(const std::string& name, Execute execute)
+{
+	Pass pass;
+	pass.name = name;
+	pass.execute = std::move(execute);
+	pass.sideEffects = false;
+	pass.culled = false;
+	pass.framebuffer = 0;
+	pass.width = 0;
+	pass.height = 0;
+	m_passes.push_back(std::move(pass));
+	m_compiled = false;
+	return FrameGraphPassBuilder{ *this, m_passes.size() - 1 };
+}
+
+void FrameGraph::clear()
+{
+	m_resources.clear();
+	m_passes.clear();
+	m_order.clear();
+	m_compiled = false;
+}
+
+unsigned int FrameGraph::getTexture(FrameGraphResource resource) const
+{
+	const Resource& r = m_resources.at(resource);
+	if (r.imported)
+	{
+		return r.texture;
+	}
+	return (r.pooled == NONE) ? 0 : m_pool.at(r.pooled).texture.getID();
+}
+
+FrameGraphTextureDesc FrameGraph::resolve(const FrameGraphTextureDesc& desc) const
+{
+	FrameGraphTextureDesc resolved = desc;
+	resolved.width = (desc.width > 0) ? desc.width : m_width;
+	resolved.height = (desc.height > 0) ? desc.height : m_height;
+	return resolved;
+}
+
+void FrameGraph::execute(int width, int height)
+{
+	if (!m_compiled || width != m_width || height != m_height)
+	{
+		compile(width, height);
+	}
+
+	for (size_t p : m_order)
+	{
+		const Pass& pass = m_passes[p];
+		GpuScope scope{ pass.name };
+
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+		if (pass.framebuffer != 0)
+		{
+			GLState::viewport(0, 0, pass.width, pass.height);
+		}
+		else
+		{
+			GLState::viewport(0, 0, width, height);
+		}
+
+		// the depth mask must be on (as it is outside of the passes) for the depth to be cleared
+		for (const Attachment& clear : pass.clears)
+		{
+			if (clear.attachment == GL_DEPTH_ATTACHMENT)
+			{
+				const GLfloat depth = 1.0f;
+				GLCall(glClearBufferfv(GL_DEPTH, 0, &depth));
+			}
+			else
+			{
+				GLCall(glClearBufferfv(GL_COLOR, clear.attachment - GL_COLOR_ATTACHMENT0, glm::value_ptr(m_resources[clear.resource].clearColor)));
+			}
+		}
+
+		pass.execute(*this);
+	}
+
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::viewport(0, 0, width, height);
+}
+
+void FrameGraph::compile(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	cull();
+	sortPasses();
+	allocateTextures();
+	createFramebuffers();
+	m_compiled = true;
+}
+
+void FrameGraph::cull()
+{
+	// from the passes that must run, to the passes writing what they read
+	std::vector<size_t> needed;
+	for (size_t p = 0; p < m_passes.size(); p++)
+	{
+		Pass& pass = m_passes[p];
+		pass.culled = !pass.sideEffects;
+		for (const Attachment& write : pass.writes)
+		{
+			pass.culled = pass.culled && !m_resources.at(write.resource).output;
+		}
+		if (!pass.culled)
+		{
+			needed.push_back(p);
+		}
+	}
+
+	while (!needed.empty())
+	{
+		size_t p = needed.back();
+		needed.pop_back();
+		for (FrameGraphResource read : m_passes[p].reads)
+		{
+			for (size_t q = 0; q < m_passes.size(); q++)
+			{
+				Pass& writer = m_passes[q];
+				if (!writer.culled)
+				{
+					continue;
+				}
+				for (const Attachment& write : writer.writes)
+				{
+					if (write.resource == read)
+					{
+						writer.culled = false;
+						needed.push_back(q);
+						break;
+					}
+				}
+			}
+		}
+	}
+}
+
+void FrameGraph::sortPasses()
+{
+	auto writesResource = [this](size_t p, FrameGraphResource resource)
+	{
+		for (const Attachment& write : m_passes[p].writes)
+		{
+			if (write.resource == resource)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	// p runs after q if it reads what q writes, or if both write the same texture and q was declared first
+	auto dependsOn = [this, &writesResource](size_t p, size_t q)
+	{
+		for (FrameGraphResource read : m_passes[p].reads)
+		{
+			if (writesResource(q, read))
+			{
+				return true;
+			}
+		}
+		if (q < p)
+		{
+			for (const Attachment& write : m_passes[p].writes)
+			{
+				if (writesResource(q, write.resource))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	};
+
+	m_order.clear();
+	std::vector<bool> placed(m_passes.size(), false);
+	size_t numKept = 0;
+	for (size_t p = 0; p < m_passes.size(); p++)
+	{
+		numKept += m_passes[p].culled ? 0 : 1;
+	}
+
+	// the first pass in declaration order whose dependencies already run, until none is left
+	while (m_order.size() < numKept)
+	{
+		size_t next = NONE;
+		for (size_t p = 0; p < m_passes.size() && next == NONE; p++)
+		{
+			if (m_passes[p].culled || placed[p])
+			{
+				continue;
+			}
+			bool ready = true;
+			for (size_t q = 0; q < m_passes.size() && ready; q++)
+			{
+				ready = (q == p) || m_passes[q].culled || placed[q] || !dependsOn(p, q);
+			}
+			next = ready ? p : NONE;
+		}
+
+		if (next == NONE)
+		{
+			std::cerr << "[FrameGraph] the passes depend on each other: running them in declaration order" << std::endl;
+			m_order.clear();
+			for (size_t p = 0; p < m_passes.size(); p++)
+			{
+				if (!m_passes[p].culled)
+				{
+					m_order.push_back(p);
+				}
+			}
+			return;
+		}
+		placed[next] = true;
+		m_order.push_back(next);
+	}
+}
+
+void FrameGraph::allocateTextures()
+{
+	// lifetime of each texture of the graph, in positions of m_order
+	std::vector<size_t> first(m_resources.size(), NONE);
+	std::vector<size_t> last(m_resources.size(), NONE);
+	auto use = [&](FrameGraphResource resource, size_t position)
+	{
+		if (m_resources.at(resource).imported)
+		{
+			return;
+		}
+		first[resource] = std::min(first[resource], position);
+		last[resource] = (last[resource] == NONE) ? position : std::max(last[resource], position);
+	};
+	for (size_t position = 0; position < m_order.size(); position++)
+	{
+		const Pass& pass = m_passes[m_order[position]];
+		for (FrameGraphResource read : pass.reads)
+		{
+			use(read, position);
+		}
+		for (const Attachment& write : pass.writes)
+		{
+			use(write.resource, position);
+		}
+	}
+
+	// a texture of the pool is taken at the first use of a resource and given back after its last one
+	std::vector<bool> busy(m_pool.size(), false);
+	std::vector<bool> used(m_pool.size(), false);
+	for (Resource& resource : m_resources)
+	{
+		resource.pooled = NONE;
+	}
+	for (size_t position = 0; position < m_order.size(); position++)
+	{
+		for (size_t r = 0; r < m_resources.size(); r++)
+		{
+			if (first[r] != position)
+			{
+				continue;
+			}
+			FrameGraphTextureDesc desc = resolve(m_resources[r].desc);
+			size_t k = 0;
+			while (k < m_pool.size() && (busy[k] || !sameDesc(m_pool[k].desc, desc)))
+			{
+				k++;
+			}
+			if (k == m_pool.size())
+			{
+				m_pool.push_back(PooledTexture{ desc, makeTexture(desc) });
+				busy.push_back(false);
+				used.push_back(false);
+			}
+			busy[k] = true;
+			used[k] = true;
+			m_resources[r].pooled = k;
+		}
+		for (size_t r = 0; r < m_resources.size(); r++)
+		{
+			if (last[r] == position)
+			{
+				busy[m_resources[r].pooled] = false;
+			}
+		}
+	}
+
+	// the textures no resource uses anymore (old sizes, removed passes) are released
+	std::vector<size_t> remap(m_pool.size(), NONE);
+	std::vector<PooledTexture> pool;
+	for (size_t k = 0; k < m_pool.size(); k++)
+	{
+		if (used[k])
+		{
+			remap[k] = pool.size();
+			pool.push_back(std::move(m_pool[k]));
+		}
+	}
+	m_pool = std::move(pool);
+	for (Resource& resource : m_resources)
+	{
+		if (resource.pooled != NONE)
+		{
+			resource.pooled = remap[resource.pooled];
+		}
+	}
+}
+
+void FrameGraph::createFramebuffers()
+{
+	std::map<std::vector<unsigned int>, unsigned int> framebuffers;
+	std::vector<bool> written(m_resources.size(), false);
+
+	for (size_t p : m_order)
+	{
+		Pass& pass = m_passes[p];
+		pass.framebuffer = 0;
+		pass.width = 0;
+		pass.height = 0;
+		pass.clears.clear();
+
+		std::vector<unsigned int> key;
+		for (const Attachment& write : pass.writes)
+		{
+			if (write.attachment == GL_NONE)
+			{
+				continue;
+			}
+			const Resource& resource = m_resources.at(write.resource);
+			FrameGraphTextureDesc desc = resource.imported ? resource.desc : m_pool.at(resource.pooled).desc;
+			key.push_back(write.attachment);
+			key.push_back(getTexture(write.resource));
+			pass.width = desc.width;
+			pass.height = desc.height;
+
+			// the first pass writing a texture of the graph clears it
+			if (!resource.imported && !written[write.resource])
+			{
+				pass.clears.push_back(write);
+			}
+			written[write.resource] = true;
+		}
+		if (key.empty())
+		{
+			continue;
+		}
+
+		auto existing = framebuffers.find(key);
+		if (existing == framebuffers.end())
+		{
+			auto previous = m_framebuffers.find(key);
+			if (previous != m_framebuffers.end())
+			{
+				existing = framebuffers.insert(*previous).first;
+				m_framebuffers.erase(previous);
+			}
+		}
+		if (existing != framebuffers.end())
+		{
+			pass.framebuffer = existing->second;
+			continue;
+		}
+
+		unsigned int framebuffer = 0;
+		GLCall(glGenFramebuffers(1, &framebuffer));
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		GLenum drawBuffers[16];
+		GLsizei numDrawBuffers = 0;
+		for (size_t i = 0; i < key.size(); i += 2)
+		{
+			GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, key[i], GL_TEXTURE_2D, key[i + 1], 0));
+			if (key[i] >= GL_COLOR_ATTACHMENT0 && key[i] < GL_COLOR_ATTACHMENT0 + 16)
+			{
+				GLsizei index = key[i] - GL_COLOR_ATTACHMENT0;
+				for (GLsizei b = numDrawBuffers; b <= index; b++)
+				{
+					drawBuffers[b] = GL_NONE;
+				}
+				numDrawBuffers = std::max(numDrawBuffers, index + 1);
+				drawBuffers[index] = key[i];
+			}
+		}
+		if (numDrawBuffers > 0)
+		{
+			GLCall(glDrawBuffers(numDrawBuffers, drawBuffers));
+		}
+		else
+		{
+			GLCall(glDrawBuffer(GL_NONE));
+			GLCall(glReadBuffer(GL_NONE));
+		}
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cerr << "[FrameGraph] framebuffer of the pass " << pass.name << " not complete!" << std::endl;
+		}
+		framebuffers.insert({ key, framebuffer });
+		pass.framebuffer = framebuffer;
+	}
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// the framebuffers of passes that are not run anymore, or of released textures
+	for (auto& framebuffer : m_framebuffers)
+	{
+		GLCall(glDeleteFramebuffers(1, &framebuffer.second));
+		GLState::forgetFramebuffer(framebuffer.second);
+	}
+	m_framebuffers = std::move(framebuffers);
+
+	// passes culled, or without attachments, bind the default framebuffer
+	for (Pass& pass : m_passes)
+	{
+		if (pass.culled)
+		{
+			pass.framebuffer = 0;
+			pass.clears.clear();
+		}
+	}
+}
+
+size_t FrameGraph::getPooledBytes() const
+{
+	size_t bytes = 0;
+	for (const PooledTexture& pooled : m_pool)
+	{
+		bytes += (size_t)pooled.desc.width * pooled.desc.height * bytesPerPixel(pooled.desc.internalFormat);
+	}
+	return bytes;
+}
+
+void FrameGraph::dump(std::ostream& out) const
+{
+	out << "frame graph: " << m_order.size() << " of " << m_passes.size() << " passes, " << m_pool.size()
+		<< " textures (" << getPooledBytes() << " bytes)\n";
+	for (size_t p : m_order)
+	{
+		const Pass& pass = m_passes[p];
+		out << "  " << pass.name << ":";
+		for (FrameGraphResource read : pass.reads)
+		{
+			out << " reads " << m_resources[read].name;
+		}
+		for (const Attachment& write : pass.writes)
+		{
+			const Resource& resource = m_resources[write.resource];
+			out << " writes " << resource.name;
+			if (resource.pooled != NONE)
+			{
+				out << " (texture " << resource.pooled << ")";
+			}
+		}
+		out << "\n";
+	}
+	for (const Pass& pass : m_passes)
+	{
+		if (pass.culled)
+		{
+			out << "  culled: " << pass.name << "\n";
+		}
+	}
+	out.flush();
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+/* stl */
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <ostream>
+
+/* maths */
+#include <glm/glm.hpp>
+
+#include "../Texture/Texture.h"
+
+
+//! Size and format of a texture owned by the frame graph.
+struct FrameGraphTextureDesc
+{
+	int    width;           //!< in pixels, 0 for the width given to FrameGraph::execute
+	int    height;          //!< in pixels, 0 for the height given to FrameGraph::execute
+	GLenum internalFormat;  //!< e.g. GL_RGBA16, GL_RGBA16F, GL_DEPTH_COMPONENT24
+};
+
+//! Handle of a texture of the frame graph (see FrameGraph::createTexture and importTexture).
+typedef unsigned int FrameGraphResource;
+
+class FrameGraph;
+
+
+//! Declares what a pass reads and writes. Returned by FrameGraph::addPass.
+class FrameGraphPassBuilder
+{
+public:
+	//!< The pass samples the texture: it runs after the passes that write it.
+	FrameGraphPassBuilder& read(FrameGraphResource resource);
+	//!< The pass renders into the texture, attached to the framebuffer the graph binds for the pass.
+	//!< With GL_NONE the texture is not attached: the pass renders into it with its own framebuffer (e.g. ShadowMap2D).
+	FrameGraphPassBuilder& write(FrameGraphResource resource, GLenum attachment = GL_COLOR_ATTACHMENT0);
+	//!< Keeps the pass even if nothing reads what it writes, e.g. when it draws on the screen.
+	FrameGraphPassBuilder& setSideEffects();
+
+private:
+	friend class FrameGraph;
+	FrameGraphPassBuilder(FrameGraph& graph, size_t pass) : m_graph(graph), m_pass(pass) {}
+
+	FrameGraph& m_graph;
+	size_t      m_pass;
+};
+
+
+//! Passes of a frame, with the textures they read and write.
+/*!
+	The passes and the textures are declared once (usually by the level's constructor), and execute runs them every
+	frame: the unused passes are culled, and the textures whose lifetimes do not overlap share the same OpenGL texture.
+*/
+class FrameGraph
+{
+public:
+	//!< Draws the pass. The textures of the graph are read with getTexture.
+	typedef std::function<void(const FrameGraph&)> Execute;
+
+	FrameGraph();
+	~FrameGraph();
+
+	FrameGraph(const FrameGraph&) = delete;
+	FrameGraph& operator=(const FrameGraph&) = delete;
+
+	//!< Texture owned by the graph, allocated only while a pass uses it.
+	FrameGraphResource createTexture(const std::string& name, const FrameGraphTextureDesc& desc);
+	//!< Texture owned by someone else (e.g. a shadow map), made known to the graph to order the passes using it.
+	//!< It is never cleared nor aliased.
+	//!< Its size is only needed to attach it (see FrameGraphPassBuilder::write).
+	FrameGraphResource importTexture(const std::string& name, unsigned int texture, int width = 0, int height = 0);
+	//!< Color the texture is cleared to in its first pass (black by default). Can be changed every frame.
+	void setClearColor(FrameGraphResource resource, const glm::vec4& color);
+	//!< The passes writing the texture are kept, even if no pass reads it.
+	void markOutput(FrameGraphResource resource);
+
+	//!< Adds a pass: declare what it reads and writes with the returned builder.
+	FrameGraphPassBuilder addPass(const std::string& name, Execute execute);
+
+	//!< Runs the passes that are kept, in order. width and height are the size of the default framebuffer.
+	//!< A pass renders into a framebuffer of the textures it writes (with their viewport), or into the default one,
+	//!< inside a GpuProfiler scope named after it. Compiles the graph first if it or the size changed; executing a
+	//!< compiled graph does not allocate.
+	void execute(int width, int height);
+
+	//!< OpenGL texture of the resource. For the textures of the graph, only valid during the passes that use it.
+	unsigned int getTexture(FrameGraphResource resource) const;
+
+	//!< Forgets the passes and the resources (the OpenGL textures are kept until the next compilation).
+	void clear();
+
+	//!< Number of passes run by execute, and of OpenGL textures (and their bytes) allocated for the textures of the graph.
+	size_t getNumExecutedPasses() const { return m_order.size(); }
+	size_t getNumPooledTextures() const { return m_pool.size(); }
+	size_t getPooledBytes() const;
+	//!< Writes the passes in their order, the culled ones, and the texture each resource is aliased to.
+	void dump(std::ostream& out) const;
+
+private:
+	friend class FrameGraphPassBuilder;
+
+	struct Resource
+	{
+		std::string           name;
+		FrameGraphTextureDesc desc;
+		bool                  imported;
+		unsigned int          texture;     // if imported
+		glm::vec4             clearColor;
+		bool                  output;
+		size_t                pooled;      // index in m_pool, for the textures of the graph used by an executed pass
+	};
+
+	struct Attachment
+	{
+		FrameGraphResource resource;
+		GLenum             attachment;
+	};
+
+	struct Pass
+	{
+		std::string                     name;
+		Execute                         execute;
+		std::vector<FrameGraphResource> reads;
+		std::vector<Attachment>         writes;
+		bool                            sideEffects;
+		// set by compile
+		bool                            culled;
+		unsigned int                    framebuffer;  // 0 if the pass attaches nothing
+		int                             width;        // of its attachments
+		int                             height;
+		std::vector<Attachment>         clears;
+	};
+
+	struct PooledTexture
+	{
+		FrameGraphTextureDesc desc;   // with the actual size
+		Texture               texture;
+	};
+
+	std::vector<Resource>      m_resources;
+	std::vector<Pass>          m_passes;
+	std::vector<size_t>        m_order;      // of the executed passes
+	std::vector<PooledTexture> m_pool;
+	// framebuffers by their attachments: (attachment, texture) pairs
+	std::map<std::vector<unsigned int>, unsigned int> m_framebuffers;
+
+	bool m_compiled;
+	int  m_width;
+	int  m_height;
+
+	//!< Culls, orders, and gives textures to the passes. The textures of the graph are kept from one compilation to
+	//!< the next, and the ones not used anymore are released.
+	void compile(int width, int height);
+	//!< Keeps the passes with side effects, the passes writing an output, and the passes writing what those read.
+	void cull();
+	//!< A pass runs after the passes writing the textures it reads, otherwise in declaration order.
+	void sortPasses();
+	//!< Each texture is alive from its first to its last pass. Textures of the same size and format whose lifetimes
+	//!< do not overlap share an OpenGL texture.
+	void allocateTextures();
+	//!< Framebuffer of each pass; the first pass writing a texture of the graph clears it (to its clear color, or depth 1).
+	void createFramebuffers();
+	FrameGraphTextureDesc resolve(const FrameGraphTextureDesc& desc) const;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+/* stl */
+#include <vector>
+
+/* maths */
+#include <glm/glm.hpp>
+
+#include "Renderer.h"
+#include "../Camera/Camera.h"
+#include "../lighting/SunLight.h"
+#include "../lighting/PointLight.h"
+
+
+//! What a frame draws, copied from the simulation so that a render thread can draw it while the next frame is simulated.
+/*!
+	GameLevel::capture fills it and GameLevel::renderSnapshot draws it (see Game::setRenderThread). The models and
+	shaders the objects point to belong to the level, which never changes them after loading.
+*/
+struct FrameSnapshot
+{
+	// filled by Game
+	int  width  = 0;     //!< of the window, in pixels
+	int  height = 0;
+	bool logStats = false;  //!< the render thread prints the counters of the frame (F3)
+
+	// filled by the level
+	Camera    camera;
+	glm::mat4 projection{ 1.0f };
+	std::vector<SunLight>               suns;
+	std::vector<PointLight>             pointLights;
+	std::vector<RenderingSpecification> objects;  //!< models and their transforms, submitted to the renderer
+
+	//!< Keeps the memory of the containers, so the snapshots stop allocating after the first frames.
+	void clear()
+	{
+		suns.clear();
+		pointLights.clear();
+		objects.clear();
+		logStats = false;
+	}
+};
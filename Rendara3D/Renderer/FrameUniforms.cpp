@@ -0,0 +1,76 @@
+#include "FrameUniforms.h"
+#include "RenderStats.h"
+
+/* stl */
+#include <cstring>
+#include <stdexcept>
+
+
+namespace {
+
+	// the lights block starts at the first offset after the camera block that can be bound
+	size_t lightsBlockOffset()
+	{
+		GLint alignment = 0;
+		GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+		size_t a = (alignment > 0) ? (size_t)alignment : 256;
+		return (sizeof(CameraBlock) + a - 1) / a * a;
+	}
+
+}
+
+
+FrameUniforms::FrameUniforms() : m_camera{}, m_lights{}, m_lightsOffset(lightsBlockOffset()),
+	m_ring(m_lightsOffset + sizeof(LightsBlock))
+{
+}
+
+void FrameUniforms::setCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos)
+{
+	m_camera.view       = view;
+	m_camera.projection = projection;
+	m_camera.cameraPos  = cameraPos;
+}
+
+void FrameUniforms::setSun(size_t i, const SunLight& sun, const glm::mat4& lightSpaceMatrix)
+{
+	if (i >= MAX_SUNS)
+	{
+		throw std::out_of_range("FrameUniforms: more suns than MAX_SUNS.");
+	}
+	SunBlock& block = m_lights.sun[i];
+	block.direction = sun.center - sun.eye;
+	block.ambient   = sun.ambientColor;
+	block.diffuse   = sun.diffuseColor;
+	block.specular  = sun.specularColor;
+	m_lights.lightSpaceMatrix[i] = lightSpaceMatrix;
+}
+
+void FrameUniforms::setPointLight(size_t i, const PointLight& pointLight)
+{
+	if (i >= MAX_POINT_LIGHTS)
+	{
+		throw std::out_of_range("FrameUniforms: more point lights than MAX_POINT_LIGHTS.");
+	}
+	PointLightBlock& block = m_lights.pointLights[i];
+	block.position      = pointLight.eye;
+	block.positionWorld = pointLight.eye;
+	block.constant      = pointLight.attenuation.constant;
+	block.linear        = pointLight.attenuation.linear;
+	block.quadratic     = pointLight.attenuation.quadratic;
+	block.ambient       = pointLight.ambientColor;
+	block.diffuse       = pointLight.diffuseColor;
+	block.specular      = pointLight.specularColor;
+}
+
+void FrameUniforms::upload()
+{
+	char* region = m_ring.beginFrame();
+	std::memcpy(region, &m_camera, sizeof(CameraBlock));
+	std::memcpy(region + m_lightsOffset, &m_lights, sizeof(LightsBlock));
+	m_ring.endFrame();
+	RenderStats::countBufferUpload(sizeof(CameraBlock) + sizeof(LightsBlock));
+
+	m_ring.bindRange(CAMERA_BLOCK_BINDING, 0, sizeof(CameraBlock));
+	m_ring.bindRange(LIGHTS_BLOCK_BINDING, m_lightsOffset, sizeof(LightsBlock));
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+/* maths */
+#include <glm/glm.hpp>
+
+#include "../Shader/UniformBlocks.h"
+#include "../buffers/UniformRingBuffer.h"
+#include "../lighting/SunLight.h"
+#include "../lighting/PointLight.h"
+
+
+//! Camera and lights of a frame, sent once to all the programs through the shared uniform blocks.
+/*!
+	The setters only fill the CPU copies of the Camera and Lights blocks (UniformBlocks.h). upload, once per
+	frame before drawing, writes both blocks in the next region of a UniformRingBuffer and binds them to
+	CAMERA_BLOCK_BINDING and LIGHTS_BLOCK_BINDING, where every program declaring them reads them.
+	This replaces the view, projection, cameraPos, sun[i], pointLights[i] and lightSpaceMatrix[i] uniforms
+	that used to be set on each shader.
+*/
+class FrameUniforms
+{
+public:
+	FrameUniforms();
+
+	void setCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos);
+	//!< lightSpaceMatrix is the one used for the shadow map of the sun (see ShadowMap2D::getLightSpaceMatrix).
+	void setSun(size_t i, const SunLight& sun, const glm::mat4& lightSpaceMatrix);
+	void setPointLight(size_t i, const PointLight& pointLight);
+
+	//!< Writes the blocks for this frame and binds them.
+	void upload();
+
+private:
+	CameraBlock       m_camera;
+	LightsBlock       m_lights;
+	size_t            m_lightsOffset; // of the lights block in a region of the ring
+	UniformRingBuffer m_ring;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+
+/* maths */
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "../buffers/InstanceLayout.h"
+#include "Transform.h"
+#include "TransformBatch.h"
+
+
+//! Per-instance data read by the instanced object shaders (e.g. instances_objects_wlights.shader).
+/*!
+	The model matrix goes to the locations 4-7, the normal matrix to 8-11.
+*/
+struct InstanceData
+{
+	glm::mat4 model;
+	glm::mat4 normal;
+
+	//!< Fills the instance from a single transform (see computeBatch for many).
+	void set(const Transform& transform)
+	{
+		model = transform.getModelMatrix();
+		normal = glm::mat4{ glm::mat3{ glm::inverse(glm::transpose(model)) } };
+	}
+
+	glm::mat4 getModelMatrix() const { return model; }
+
+	//!< Fills batch.size() instances from the transforms of the batch, with the SIMD kernel.
+	static void computeBatch(const TransformBatch& batch, InstanceData* instances)
+	{
+		batch.computeMatrices(&instances->model, &instances->normal, sizeof(InstanceData));
+	}
+
+	static const InstanceLayout& layout()
+	{
+		static const InstanceLayout instanceLayout = []()
+		{
+			InstanceLayout l{ sizeof(InstanceData), {} };
+			l.addMat4(4, offsetof(InstanceData, model));
+			l.addMat4(8, offsetof(InstanceData, normal));
+			return l;
+		}();
+		return instanceLayout;
+	}
+};
+
+
+//! Compact alternative to InstanceData: rotation quaternion, position and scale (40 bytes instead of 128).
+/*!
+	Read by the instances_compact_*.shader shaders: the rotation goes to the location 4, the position to 5 and the scale to 6.
+	The shaders rebuild the normal matrix as R * S^-1, so the scale must not have zero components.
+*/
+struct CompactInstanceData
+{
+	glm::quat rotation;
+	glm::vec3 position;
+	glm::vec3 scale;
+
+	void set(const Transform& transform)
+	{
+		// same order as Transform::getModelMatrix: rotations around z, then y, then x
+		glm::vec3 radians = glm::radians(transform.rotation);
+		rotation = glm::angleAxis(radians.z, glm::vec3{ 0.0f, 0.0f, 1.0f })
+		         * glm::angleAxis(radians.y, glm::vec3{ 0.0f, 1.0f, 0.0f })
+		         * glm::angleAxis(radians.x, glm::vec3{ 1.0f, 0.0f, 0.0f });
+		position = transform.position;
+		scale = transform.scale;
+	}
+
+	glm::mat4 getModelMatrix() const
+	{
+		return glm::translate(glm::mat4{ 1.0f }, position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4{ 1.0f }, scale);
+	}
+
+	//!< Fills batch.size() instances from the transforms of the batch. No matrices are involved, so there is no SIMD path.
+	static void computeBatch(const TransformBatch& batch, CompactInstanceData* instances)
+	{
+		for (size_t i = 0; i < batch.size(); i++)
+		{
+			instances[i].set(batch.get(i));
+		}
+	}
+
+	static const InstanceLayout& layout()
+	{
+		static const InstanceLayout instanceLayout{ sizeof(CompactInstanceData), {
+			{ 4, 4, offsetof(CompactInstanceData, rotation) },
+			{ 5, 3, offsetof(CompactInstanceData, position) },
+			{ 6, 3, offsetof(CompactInstanceData, scale) } } };
+		return instanceLayout;
+	}
+};
+
+
+//! Per-instance data read by the instanced quads shaders (e.g. instances_colored_quads.shader).
+/*!
+	The model matrix goes to the locations 4-7, the color to 8.
+*/
+struct InstanceQuadData
+{
+	glm::mat4 model;
+	glm::vec4 color;
+
+	//!< Fills the model matrices of batch.size() instances with the SIMD kernel. The colors are left untouched.
+	static void computeBatch(const TransformBatch& batch, InstanceQuadData* instances)
+	{
+		batch.computeMatrices(&instances->model, nullptr, sizeof(InstanceQuadData));
+	}
+
+	static const InstanceLayout& layout()
+	{
+		static const InstanceLayout instanceLayout = []()
+		{
+			InstanceLayout l{ sizeof(InstanceQuadData), {} };
+			l.addMat4(4, offsetof(InstanceQuadData, model));
+			l.attributes.push_back({ 8, 4, offsetof(InstanceQuadData, color) });
+			return l;
+		}();
+		return instanceLayout;
+	}
+};
@@ -2,88 +2,118 @@
 
 #include "../Model/Model.h"
 #include "../utils/SwapArray.h"
+#include "../utils/SoASwapArray.h"
+#include "../utils/DirtyRanges.h"
+#include "../utils/SlotMap.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/CpuProfiler.h"
+#include "../utils/AllocationTracker.h"
+#include "../Camera/Frustum.h"
+#include "InstanceData.h"
+#include "TransformBatch.h"
 
 
 //! Class that owns a collection of objects that will be drawn identically but at different positions using instancing.
-template <class HasTransform>
+/*!
+	The matrices of the instances live in a buffer owned by the set, allocated for maxElements at the first draw.
+	At the first draw after a change only the modified elements are uploaded (see memory::DirtyRanges), and the
+	buffer is reused as it is by all the following draws (e.g. the depth, cube-depth and colour passes of a frame).
+	The attribute layout is recorded in the vaos of the meshes, which only re-specify it when they were used with
+	a different instance buffer in between.
+	InstanceFormat is the per-instance data sent to the GPU: InstanceData (model and normal matrices) by default,
+	or CompactInstanceData with the instances_compact_*.shader shaders.
+	Changing an element does not compute its matrices: all the changed elements are recomputed together before
+	the next draw, as ranges of a TransformBatch (SIMD).
+	updateElements changes every element in place and recomputes them right away, in chunks spread over the
+	threads of ThreadPool::shared().
+	Deleting an element moves the last one into its place, so positions change; push_back returns a handle
+	that keeps referring to the same element until it is deleted (see memory::HandleTable).
+*/
+template <class HasTransform, class InstanceFormat = InstanceData>
 class InstanceSet
 {
 	size_t m_numberOfMeshes;
 	Model* m_model;
-	//memory::SwapArray< std::pair<  std::pair<glm::mat4, glm::mat4>, HasTransform>  >  instances;
 
 	memory::SwapArray<HasTransform>    m_objects;
-	memory::SwapArray<glm::mat4>       m_modelMatrices;
-	memory::SwapArray<glm::mat4>       m_normalMatrices;
-
+	memory::HandleTable                m_handles;
+	memory::SwapArray<InstanceFormat>  m_instances;
+	memory::SwapArray<glm::vec4>       m_spheres; // world space bounding spheres (center, radius)
+
+	Buffer              m_instanceBuffer;
+	memory::DirtyRanges m_stale; // elements whose instance data has to be recomputed
+	memory::DirtyRanges m_dirty; // elements changed since the last upload
+	TransformBatch      m_batch;
+
+	// storage of updateElements: one batch per chunk, and whether each element is kept
+	std::vector<TransformBatch>        m_chunkBatches;
+	std::vector<unsigned char>         m_keep;
+
+	// storage of the culled draws
+	std::vector<unsigned char>         m_visible;
+	std::vector<InstanceFormat>        m_visibleInstances;
+	Buffer                             m_visibleBuffer;
+
+	// dirty ranges closer than this (in elements) are uploaded together
+	static const size_t UPLOAD_MERGE_GAP = 16;
+	// elements per chunk of updateElements. A multiple of 64 elements is a whole number of cache lines whatever
+	// the element size, so two threads never write the same line (past the start of the arrays)
+	static const size_t PARALLEL_CHUNK = 1024;
 
 public:
 
 	void drawInstances(Shader& shader)
 	{
-		const std::vector<Mesh>* meshes = this->m_model->getMeshes();
-	
-		for (size_t i = 0; i < meshes->size(); i++)
+		CPU_PROFILE_SCOPE("InstanceSet::drawInstances");
+		ALLOCATION_FREE_SCOPE("InstanceSet::drawInstances");
+		if (m_objects.size() == 0)
 		{
-			const Mesh* mesh = &meshes->at(i);
-	
-			mesh->passMaterialUniforms(shader);
-	
-			// prepare the attributes and then draw
-			unsigned int bufferModelMatrix;
-			glGenBuffers(1, &bufferModelMatrix);
-			glBindBuffer(GL_ARRAY_BUFFER, bufferModelMatrix);
-			glBufferData(GL_ARRAY_BUFFER, m_objects.size() * sizeof(glm::mat4), m_modelMatrices.getPointerToFirst(), GL_STATIC_DRAW);
-	
-			// bind vao and enable vertex attributes (specifying the layout)
-			mesh->bindVao();
-			glEnableVertexAttribArray(4);
-			glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)0);
-			glEnableVertexAttribArray(5);
-			glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4)));
-			glEnableVertexAttribArray(6);
-			glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(2 * sizeof(glm::vec4)));
-			glEnableVertexAttribArray(7);
-			glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(3 * sizeof(glm::vec4)));
-
-			glVertexAttribDivisor(4, 1);
-			glVertexAttribDivisor(5, 1);
-			glVertexAttribDivisor(6, 1);
-			glVertexAttribDivisor(7, 1);
-
-			unsigned int bufferNormalMatrix;
-			glGenBuffers(1, &bufferNormalMatrix);
-			glBindBuffer(GL_ARRAY_BUFFER, bufferNormalMatrix);
-			glBufferData(GL_ARRAY_BUFFER, m_objects.size() * sizeof(glm::mat4), m_normalMatrices.getPointerToFirst(), GL_STATIC_DRAW);
-
-
-			glEnableVertexAttribArray(8);
-			glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)0);
-			glEnableVertexAttribArray(9);
-			glVertexAttribPointer(9, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4)));
-			glEnableVertexAttribArray(10);
-			glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(2 * sizeof(glm::vec4)));
-			glEnableVertexAttribArray(11);
-			glVertexAttribPointer(11, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(3 * sizeof(glm::vec4)));
-
-			glVertexAttribDivisor(8, 1);
-			glVertexAttribDivisor(9, 1);
-			glVertexAttribDivisor(10, 1);
-			glVertexAttribDivisor(11, 1);
-
-			glDrawElementsInstanced(GL_TRIANGLES, mesh->getIndices(), GL_UNSIGNED_INT, 0, m_objects.size());
-
-			glBindVertexArray(0);
-			glDeleteBuffers(1, &bufferModelMatrix);
-			glDeleteBuffers(1, &bufferNormalMatrix);
+			return;
+		}
+		recompute();
+		upload();
+		drawBuffer(shader, m_instanceBuffer, m_objects.size());
+	}
 
+	//!< Draws only the instances whose bounding spheres intersect the frustum. The spheres are tested four at a time (see Frustum::intersectSpheres).
+	void drawInstances(Shader& shader, const Frustum& frustum)
+	{
+		CPU_PROFILE_SCOPE("InstanceSet::drawInstances (culled)");
+		ALLOCATION_FREE_SCOPE("InstanceSet::drawInstances (culled)");
+		recompute();
+
+		size_t count = m_objects.size();
+		m_visible.resize(count);
+		size_t numVisible = frustum.intersectSpheres(m_spheres.getPointerToFirst(), count, m_visible.data());
+		if (numVisible == count)
+		{
+			drawInstances(shader);
+			return;
+		}
+		if (numVisible == 0)
+		{
+			return;
+		}
+
+		m_visibleInstances.resize(numVisible);
+		size_t v = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (m_visible[i])
+			{
+				m_visibleInstances[v++] = m_instances.at(i);
+			}
 		}
-	
+		m_visibleBuffer.setData(m_visibleInstances.data(), numVisible * sizeof(InstanceFormat), GL_STREAM_DRAW);
+		m_visibleBuffer.unbind();
+		drawBuffer(shader, m_visibleBuffer, numVisible);
 	}
 
-	InstanceSet(size_t maxElements) : m_objects{ maxElements }, m_modelMatrices(maxElements), m_normalMatrices(maxElements), m_model(nullptr) {}
+	InstanceSet(size_t maxElements) : m_objects{ maxElements }, m_handles(maxElements), m_instances(maxElements), m_spheres(maxElements), m_model(nullptr),
+		m_instanceBuffer(GL_ARRAY_BUFFER), m_stale(maxElements), m_dirty(maxElements), m_visibleBuffer(GL_ARRAY_BUFFER) {}
 
-	InstanceSet(size_t maxElements, Model* modelIn) : m_objects{ maxElements }, m_modelMatrices(maxElements), m_normalMatrices(maxElements), m_model(modelIn)
+	InstanceSet(size_t maxElements, Model* modelIn) : m_objects{ maxElements }, m_handles(maxElements), m_instances(maxElements), m_spheres(maxElements), m_model(modelIn),
+		m_instanceBuffer(GL_ARRAY_BUFFER), m_stale(maxElements), m_dirty(maxElements), m_visibleBuffer(GL_ARRAY_BUFFER)
 	{
 		m_numberOfMeshes = m_model->getMeshes()->size();
 	}
@@ -95,73 +125,229 @@ public:
 
 	void deleteElement(size_t i)
 	{
-		m_objects.deleteElement(i);
-		m_modelMatrices.deleteElement(i);
-		m_normalMatrices.deleteElement(i);
+		eraseAt(i);
+		// the last element was moved into the hole (its data may be stale)
+		if (i < m_objects.size())
+		{
+			m_stale.mark(i);
+		}
+	}
+
+	//!< Deletes the element of handle; returns false if it was already deleted.
+	bool deleteElement(memory::Handle handle)
+	{
+		if (!m_handles.contains(handle))
+		{
+			return false;
+		}
+		deleteElement(m_handles.indexOf(handle));
+		return true;
 	}
 
-	void push_back(const HasTransform& h)
+	memory::Handle push_back(const HasTransform& h)
 	{
+		memory::Handle handle = m_handles.insert();
 		m_objects.addBackElement();
-		m_modelMatrices.addBackElement();
-		m_normalMatrices.addBackElement();
-		
-		// fill the last 
+		m_instances.addBackElement();
+		m_spheres.addBackElement();
+
+		// fill the last
 		m_objects.back() = h;
-		recomputeMatrices(m_objects.size() - 1);
+		m_stale.mark(m_objects.size() - 1);
+		return handle;
 	}
 
 	void setModel(Model* modelIn)
-	{ 
+	{
 		m_model = modelIn;
 		m_numberOfMeshes = modelIn->getMeshes()->size();
+
+		// the bounding spheres depend on the model
+		m_stale.markRange(0, m_objects.size());
 	}
 
 
 	const HasTransform& getElement(size_t i) const { return m_objects.at(i); }
 	void setElement(size_t i, const HasTransform& hasTransform)
-	{ 
+	{
 		m_objects.at(i) = hasTransform;
-		recomputeMatrices(i);
+		m_stale.mark(i);
+	}
+
+	bool                contains(memory::Handle handle) const { return m_handles.contains(handle); }
+	size_t              indexOf(memory::Handle handle) const  { return m_handles.indexOf(handle); }
+	memory::Handle      getHandle(size_t i) const             { return m_handles.handleAt(i); }
+	const HasTransform& getElement(memory::Handle handle) const { return m_objects.at(m_handles.indexOf(handle)); }
+	void setElement(memory::Handle handle, const HasTransform& hasTransform) { setElement(m_handles.indexOf(handle), hasTransform); }
+
+	//!< Calls function(element) on every element, in parallel, and recomputes their instance data in the same pass.
+	//!< The function returns false to delete the element. It runs on several threads at once: it must only touch
+	//!< the element it is given.
+	template <class Function>
+	void updateElements(Function function)
+	{
+		size_t count = m_objects.size();
+		if (count == 0)
+		{
+			return;
+		}
+		size_t numChunks = (count + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+		if (m_chunkBatches.size() < numChunks)
+		{
+			m_chunkBatches.resize(numChunks);
+		}
+		m_keep.resize(count);
+
+		HasTransform* objects = m_objects.getPointerToFirst();
+		ThreadPool::shared().parallelFor(count, PARALLEL_CHUNK, [this, objects, &function](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				m_keep[i] = function(objects[i]) ? 1 : 0;
+			}
+			recomputeRange(m_chunkBatches[begin / PARALLEL_CHUNK], begin, end);
+		});
+		m_stale.clear();
+		m_dirty.markRange(0, count);
+
+		// from the back: the element moved into a hole was already visited, and its data is up to date
+		for (size_t i = count; i-- > 0;)
+		{
+			if (!m_keep[i])
+			{
+				eraseAt(i);
+			}
+		}
 	}
 
 private:
 
-	void recomputeMatrices(size_t i)
+	//!< Removes the element at i from all the arrays, moving the last one into its place.
+	void eraseAt(size_t i)
 	{
-		Transform& transform = m_objects.at(i).transform;
+		m_handles.eraseAt(i);
+		m_objects.deleteElement(i);
+		m_instances.deleteElement(i);
+		m_spheres.deleteElement(i);
+	}
 
-		glm::mat4 modelMatrix{ 1.0 };
-		modelMatrix = glm::translate(modelMatrix, transform.position);
-		//modelMatrix = glm::rotate(modelMatrix, glm::radians(0.0f), glm::vec3{ 0.0f,0.0f,1.0f });
-		modelMatrix = glm::rotate(modelMatrix, glm::radians(transform.rotation.z), glm::vec3{ 0.0f,0.0f,1.0f });
-		modelMatrix = glm::rotate(modelMatrix, glm::radians(transform.rotation.y), glm::vec3{ 0.0f,1.0f,0.0f });
-		modelMatrix = glm::rotate(modelMatrix, glm::radians(transform.rotation.x), glm::vec3{ 1.0f,0.0f,0.0f });
-		modelMatrix = glm::scale(modelMatrix, transform.scale);
+	//!< Recomputes the instance data and the bounding spheres of the changed elements.
+	void recompute()
+	{
+		if (!m_stale.any())
+		{
+			return;
+		}
+		m_stale.forEachRange(m_objects.size(), 0, [this](size_t begin, size_t end)
+		{
+			recomputeRange(m_batch, begin, end);
+			m_dirty.markRange(begin, end);
+		});
+		m_stale.clear();
+	}
 
-		glm::mat3 normalMatrix = glm::inverse(glm::transpose(modelMatrix));
+	void recomputeRange(TransformBatch& batch, size_t begin, size_t end)
+	{
+		batch.resize(end - begin);
+		for (size_t i = begin; i < end; i++)
+		{
+			batch.set(i - begin, m_objects.at(i).transform);
+		}
+		InstanceFormat::computeBatch(batch, &m_instances.at(begin));
 
-		m_modelMatrices.at(i) = modelMatrix;
-		m_normalMatrices.at(i) = normalMatrix;
+		for (size_t i = begin; i < end; i++)
+		{
+			BoundingSphere sphere = (m_model != nullptr) ? m_model->getBounds().sphere.transformed(m_instances.at(i).getModelMatrix()) : BoundingSphere{};
+			m_spheres.at(i) = glm::vec4{ sphere.center, sphere.radius };
+		}
+	}
+
+	void upload()
+	{
+		if (m_instanceBuffer.getSize() == 0)
+		{
+			// storage for all the elements the set can hold: it is never reallocated
+			m_instanceBuffer.setData(nullptr, m_instances.capacity() * sizeof(InstanceFormat), GL_DYNAMIC_DRAW);
+			m_dirty.markRange(0, m_objects.size());
+		}
+		if (!m_dirty.any())
+		{
+			return;
+		}
+
+		const InstanceFormat* instances = m_instances.getPointerToFirst();
+		Buffer& buffer = m_instanceBuffer;
+		m_dirty.forEachRange(m_objects.size(), UPLOAD_MERGE_GAP, [instances, &buffer](size_t begin, size_t end)
+		{
+			buffer.setSubData(begin * sizeof(InstanceFormat), instances + begin, (end - begin) * sizeof(InstanceFormat));
+		});
+		m_instanceBuffer.unbind();
+		m_dirty.clear();
+	}
+
+	void drawBuffer(Shader& shader, const Buffer& buffer, size_t count)
+	{
+		const std::vector<Mesh>* meshes = this->m_model->getMeshes();
+
+		for (size_t i = 0; i < meshes->size(); i++)
+		{
+			const Mesh* mesh = &meshes->at(i);
+
+			mesh->passMaterialUniforms(shader);
+
+			mesh->bindVao();
+			mesh->setInstanceAttributes(buffer, 0, InstanceFormat::layout());
+			mesh->drawElementsInstanced(count);
+		}
 	}
 
 };
 
 //! Class that owns a collection of Quads that will be drawn (each with different color and position) using instancing.
+/*!
+	Same buffer handling as InstanceSet, but the set grows: the elements and their instance data are the columns of
+	a memory::SoASwapArray, which adds a chunk when it is full, and the buffer is reallocated at the next draw.
+	updateElements and the handles work as in InstanceSet.
+*/
 template <class HasTransformHasColor>
 class InstanceSetQuads
 {
+	typedef memory::SoASwapArray<HasTransformHasColor, InstanceQuadData> Elements;
+	static const size_t OBJECT   = 0; // columns of m_elements
+	static const size_t INSTANCE = 1;
+
 	Model* m_model;
 
-	memory::SwapArray<HasTransformHasColor>    m_objects;
-	memory::SwapArray<glm::mat4>       m_modelMatrices;
-	memory::SwapArray<glm::vec4>       m_colors;
+	Elements                                   m_elements;
+	memory::HandleTable                        m_handles;
+
+	Buffer              m_instanceBuffer;
+	memory::DirtyRanges m_stale; // elements whose instance data has to be recomputed
+	memory::DirtyRanges m_dirty; // elements changed since the last upload
+	TransformBatch      m_batch;
+
+	// storage of updateElements: one batch per chunk, and whether each element is kept
+	std::vector<TransformBatch> m_chunkBatches;
+	std::vector<unsigned char>  m_keep;
 
+	// dirty ranges closer than this (in elements) are uploaded together
+	static const size_t UPLOAD_MERGE_GAP = 16;
+	// elements per chunk of updateElements: one chunk of m_elements, whose columns are contiguous
+	static const size_t PARALLEL_CHUNK = Elements::CHUNK_SIZE;
 
 public:
 
 	void drawInstances(Shader& shader)
 	{
+		CPU_PROFILE_SCOPE("InstanceSetQuads::drawInstances");
+		ALLOCATION_FREE_SCOPE("InstanceSetQuads::drawInstances");
+		if (m_elements.size() == 0)
+		{
+			return;
+		}
+		recompute();
+		upload();
+
 		const std::vector<Mesh>* meshes = this->m_model->getMeshes();
 
 		for (size_t i = 0; i < meshes->size(); i++)
@@ -170,74 +356,66 @@ public:
 
 			mesh->passMaterialUniforms(shader);
 
-			// prepare the attributes and then draw
-			unsigned int bufferModelMatrix;
-			GLCall(glGenBuffers(1, &bufferModelMatrix));
-			GLCall(glBindBuffer(GL_ARRAY_BUFFER, bufferModelMatrix));
-			GLCall(glBufferData(GL_ARRAY_BUFFER, m_objects.size() * sizeof(glm::mat4), m_modelMatrices.getPointerToFirst(), GL_STATIC_DRAW));
-
-			// bind vao and enable vertex attributes (specifying the layout)
 			mesh->bindVao();
-			GLCall(glEnableVertexAttribArray(4));
-			GLCall(glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)0));
-			GLCall(glEnableVertexAttribArray(5));
-			GLCall(glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4))));
-			GLCall(glEnableVertexAttribArray(6));
-			GLCall(glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(2 * sizeof(glm::vec4))));
-			GLCall(glEnableVertexAttribArray(7));
-			GLCall(glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(3 * sizeof(glm::vec4))));
-
-			GLCall(glVertexAttribDivisor(4, 1));
-			GLCall(glVertexAttribDivisor(5, 1));
-			GLCall(glVertexAttribDivisor(6, 1));
-			GLCall(glVertexAttribDivisor(7, 1));
-
-			unsigned int bufferColor;
-			GLCall(glGenBuffers(1, &bufferColor));
-			GLCall(glBindBuffer(GL_ARRAY_BUFFER, bufferColor));
-			GLCall(glBufferData(GL_ARRAY_BUFFER, m_objects.size() * sizeof(glm::mat4), m_colors.getPointerToFirst(), GL_STATIC_DRAW));
-
-			GLCall(glEnableVertexAttribArray(8));
-			GLCall(glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0));
-			GLCall(glVertexAttribDivisor(8, 1));
-
-			GLCall(glDrawElementsInstanced(GL_TRIANGLES, mesh->getIndices(), GL_UNSIGNED_INT, 0, m_objects.size()));
-
-			GLCall(glBindVertexArray(0));
-			GLCall(glDeleteBuffers(1, &bufferModelMatrix));
-			GLCall(glDeleteBuffers(1, &bufferColor));
-
+			mesh->setInstanceAttributes(m_instanceBuffer, 0, InstanceQuadData::layout());
+			mesh->drawElementsInstanced(m_elements.size());
 		}
 
 	}
 
-	InstanceSetQuads(size_t maxElements) : m_objects{ maxElements }, m_modelMatrices(maxElements), m_colors(maxElements), m_model(nullptr) {}
+	//!< reservedElements are allocated right away; the set grows past them when needed.
+	InstanceSetQuads(size_t reservedElements) : InstanceSetQuads(reservedElements, nullptr) {}
 
-	InstanceSetQuads(size_t maxElements, Model* modelIn) : m_objects{ maxElements }, m_modelMatrices(maxElements), m_colors(maxElements), m_model(modelIn)
+	InstanceSetQuads(size_t reservedElements, Model* modelIn) : m_model(modelIn), m_elements(reservedElements), m_handles(m_elements.capacity()),
+		m_instanceBuffer(GL_ARRAY_BUFFER), m_stale(m_elements.capacity()), m_dirty(m_elements.capacity())
 	{
 	}
 
 	size_t size() const
 	{
-		return m_objects.size();
+		return m_elements.size();
+	}
+
+	size_t capacity() const
+	{
+		return m_elements.capacity();
 	}
 
 	void deleteElement(size_t i)
 	{
-		m_objects.deleteElement(i);
-		m_modelMatrices.deleteElement(i);
-		m_colors.deleteElement(i);
+		eraseAt(i);
+		// the last element was moved into the hole (its data may be stale)
+		if (i < m_elements.size())
+		{
+			m_stale.mark(i);
+		}
 	}
 
-	void push_back(const HasTransformHasColor& h)
+	//!< Deletes the element of handle; returns false if it was already deleted.
+	bool deleteElement(memory::Handle handle)
 	{
-		m_objects.addBackElement();
-		m_modelMatrices.addBackElement();
-		m_colors.addBackElement();
+		if (!m_handles.contains(handle))
+		{
+			return false;
+		}
+		deleteElement(m_handles.indexOf(handle));
+		return true;
+	}
 
-		// fill the last 
-		m_objects.back() = h;
-		recomputeMatrices(m_objects.size() - 1);
+	memory::Handle push_back(const HasTransformHasColor& h)
+	{
+		if (m_elements.size() == m_elements.capacity())
+		{
+			// a new chunk: the elements already there do not move
+			m_elements.reserve(m_elements.size() + 1);
+			m_handles.reserve(m_elements.capacity());
+			m_stale.reserve(m_elements.capacity());
+			m_dirty.reserve(m_elements.capacity());
+		}
+		memory::Handle handle = m_handles.insert();
+		size_t i = m_elements.push_back(h, InstanceQuadData{});
+		m_stale.mark(i);
+		return handle;
 	}
 
 	void setModel(Model* modelIn)
@@ -246,30 +424,141 @@ public:
 	}
 
 
-	const HasTransformHasColor& getElement(size_t i) const { return m_objects.at(i); }
+	const HasTransformHasColor& getElement(size_t i) const { return m_elements.template at<OBJECT>(i); }
 	void setElement(size_t i, const HasTransformHasColor& hasTransform)
 	{
-		m_objects.at(i) = hasTransform;
-		recomputeMatrices(i);
+		m_elements.template at<OBJECT>(i) = hasTransform;
+		m_stale.mark(i);
+	}
+
+	bool                        contains(memory::Handle handle) const { return m_handles.contains(handle); }
+	size_t                      indexOf(memory::Handle handle) const  { return m_handles.indexOf(handle); }
+	memory::Handle              getHandle(size_t i) const             { return m_handles.handleAt(i); }
+	const HasTransformHasColor& getElement(memory::Handle handle) const { return getElement(m_handles.indexOf(handle)); }
+	void setElement(memory::Handle handle, const HasTransformHasColor& hasTransform) { setElement(m_handles.indexOf(handle), hasTransform); }
+
+	//!< Calls function(element) on every element, in parallel, and recomputes their matrices and colors in the
+	//!< same pass. The function returns false to delete the element, and must only touch the element it is given.
+	template <class Function>
+	void updateElements(Function function)
+	{
+		size_t count = m_elements.size();
+		if (count == 0)
+		{
+			return;
+		}
+		size_t numChunks = (count + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+		if (m_chunkBatches.size() < numChunks)
+		{
+			m_chunkBatches.resize(numChunks);
+		}
+		m_keep.resize(count);
+
+		ThreadPool::shared().parallelFor(count, PARALLEL_CHUNK, [this, &function](size_t begin, size_t end)
+		{
+			HasTransformHasColor* objects = m_elements.template column<OBJECT>(begin / PARALLEL_CHUNK);
+			for (size_t i = begin; i < end; i++)
+			{
+				m_keep[i] = function(objects[i - begin]) ? 1 : 0;
+			}
+			recomputeRange(m_chunkBatches[begin / PARALLEL_CHUNK], begin, end);
+		});
+		m_stale.clear();
+		m_dirty.markRange(0, count);
+
+		// from the back: the element moved into a hole was already visited, and its data is up to date
+		for (size_t i = count; i-- > 0;)
+		{
+			if (!m_keep[i])
+			{
+				eraseAt(i);
+			}
+		}
 	}
 
 private:
 
+	//!< Removes the element at i from the arrays, moving the last one into its place.
+	void eraseAt(size_t i)
+	{
+		m_handles.eraseAt(i);
+		m_elements.deleteElement(i);
+	}
+
+	//!< Calls function(begin, end) for the parts of [begin, end) that lie in a single chunk of m_elements.
+	template <class Function>
+	static void forEachChunkPart(size_t begin, size_t end, Function function)
+	{
+		while (begin < end)
+		{
+			size_t chunkEnd = (begin / Elements::CHUNK_SIZE + 1) * Elements::CHUNK_SIZE;
+			size_t partEnd = (chunkEnd < end) ? chunkEnd : end;
+			function(begin, partEnd);
+			begin = partEnd;
+		}
+	}
+
+	//!< Recomputes the matrices and colors of the changed elements.
+	void recompute()
+	{
+		if (!m_stale.any())
+		{
+			return;
+		}
+		m_stale.forEachRange(m_elements.size(), 0, [this](size_t begin, size_t end)
+		{
+			forEachChunkPart(begin, end, [this](size_t partBegin, size_t partEnd)
+			{
+				recomputeRange(m_batch, partBegin, partEnd);
+			});
+			m_dirty.markRange(begin, end);
+		});
+		m_stale.clear();
+	}
 
-	void recomputeMatrices(size_t i)
+	//!< [begin, end) must be in a single chunk of m_elements.
+	void recomputeRange(TransformBatch& batch, size_t begin, size_t end)
 	{
-		Transform& transform = m_objects.at(i).transform;
+		size_t chunk = begin / Elements::CHUNK_SIZE;
+		size_t first = begin - chunk * Elements::CHUNK_SIZE;
+		const HasTransformHasColor* objects = m_elements.template column<OBJECT>(chunk) + first;
+		InstanceQuadData* instances = m_elements.template column<INSTANCE>(chunk) + first;
 
-		glm::mat4 modelMatrix{ 1.0 };
-		modelMatrix = glm::translate(modelMatrix, transform.position);
-		modelMatrix = glm::rotate(modelMatrix, glm::radians(0.0f), glm::vec3{ 0.0f,0.0f,1.0f });
-		modelMatrix = glm::rotate(modelMatrix, glm::radians(transform.rotation.z), glm::vec3{ 0.0f,0.0f,1.0f });
-		modelMatrix = glm::rotate(modelMatrix, glm::radians(transform.rotation.y), glm::vec3{ 0.0f,1.0f,0.0f });
-		modelMatrix = glm::rotate(modelMatrix, glm::radians(transform.rotation.x), glm::vec3{ 1.0f,0.0f,0.0f });
-		modelMatrix = glm::scale(modelMatrix, transform.scale);
+		batch.resize(end - begin);
+		for (size_t i = 0; i < end - begin; i++)
+		{
+			batch.set(i, objects[i].transform);
+			instances[i].color = objects[i].color;
+		}
+		InstanceQuadData::computeBatch(batch, instances);
+	}
 
+	void upload()
+	{
+		if (m_instanceBuffer.getSize() < m_elements.capacity() * sizeof(InstanceQuadData))
+		{
+			// storage for all the elements the set can hold: reallocated only when the set grew
+			m_instanceBuffer.setData(nullptr, m_elements.capacity() * sizeof(InstanceQuadData), GL_DYNAMIC_DRAW);
+			m_dirty.markRange(0, m_elements.size());
+		}
+		if (!m_dirty.any())
+		{
+			return;
+		}
 
-		m_modelMatrices.at(i) = modelMatrix;
-		m_colors.at(i) = m_objects.at(i).color;
+		Elements& elements = m_elements;
+		Buffer& buffer = m_instanceBuffer;
+		m_dirty.forEachRange(m_elements.size(), UPLOAD_MERGE_GAP, [&elements, &buffer](size_t begin, size_t end)
+		{
+			// the instance data is contiguous within a chunk only
+			forEachChunkPart(begin, end, [&elements, &buffer](size_t partBegin, size_t partEnd)
+			{
+				size_t chunk = partBegin / Elements::CHUNK_SIZE;
+				const InstanceQuadData* instances = elements.template column<INSTANCE>(chunk) + (partBegin - chunk * Elements::CHUNK_SIZE);
+				buffer.setSubData(partBegin * sizeof(InstanceQuadData), instances, (partEnd - partBegin) * sizeof(InstanceQuadData));
+			});
+		});
+		m_instanceBuffer.unbind();
+		m_dirty.clear();
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,140 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+uint64_t RenderQueue::makeKey(unsigned int pass, unsigned int shaderID, unsigned int materialID, unsigned int meshID, unsigned int depth)
+{
+	const uint64_t passMask     = (uint64_t(1) << PASS_BITS) - 1;
+	const uint64_t shaderMask   = (uint64_t(1) << SHADER_BITS) - 1;
+	const uint64_t materialMask = (uint64_t(1) << MATERIAL_BITS) - 1;
+	const uint64_t meshMask     = (uint64_t(1) << MESH_BITS) - 1;
+	const uint64_t depthMask    = (uint64_t(1) << DEPTH_BITS) - 1;
+
+	uint64_t key = pass & passMask;
+	if (pass == PASS_TRANSPARENT)
+	{
+		// blended draws must be back to front whatever their state: the depth comes right after the pass
+		key = (key << DEPTH_BITS)    | (depth & depthMask);
+		key = (key << SHADER_BITS)   | (shaderID & shaderMask);
+		key = (key << MATERIAL_BITS) | (materialID & materialMask);
+		key = (key << MESH_BITS)     | (meshID & meshMask);
+		return key;
+	}
+	key = (key << SHADER_BITS)   | (shaderID & shaderMask);
+	key = (key << MATERIAL_BITS) | (materialID & materialMask);
+	key = (key << MESH_BITS)     | (meshID & meshMask);
+	key = (key << DEPTH_BITS)    | (depth & depthMask);
+	return key;
+}
+
+unsigned int RenderQueue::quantizeDepth(float depth, float maxDepth, bool reversed)
+{
+	const unsigned int maxValue = (1u << DEPTH_BITS) - 1;
+	float normalized = (maxDepth > 0.0f) ? depth / maxDepth : 0.0f;
+	if (normalized < 0.0f) normalized = 0.0f;
+	if (normalized > 1.0f) normalized = 1.0f;
+
+	unsigned int quantized = (unsigned int)(normalized * maxValue);
+	return reversed ? maxValue - quantized : quantized;
+}
+
+RenderQueue::RenderQueue(memory::FrameArena* arena)
+	: m_items(memory::FrameAllocator<RenderItem>(arena)), m_entries(memory::FrameAllocator<SortEntry>(arena)),
+	m_scratch(memory::FrameAllocator<SortEntry>(arena)), m_sorted(true)
+{
+}
+
+void RenderQueue::reserve(size_t size)
+{
+	m_items.reserve(size);
+	m_entries.reserve(size);
+	m_scratch.reserve(size);
+}
+
+void RenderQueue::renew(size_t reserved)
+{
+	memory::renewFrameVector(m_items, reserved);
+	memory::renewFrameVector(m_entries, reserved);
+	// the scratch buffer only holds something during sort
+	m_scratch = memory::FrameVector<SortEntry>(m_scratch.get_allocator());
+	m_scratch.reserve(reserved);
+}
+
+void RenderQueue::push(uint64_t key, const RenderItem& item)
+{
+	m_entries.push_back({ key, (uint32_t)m_items.size() });
+	m_items.push_back(item);
+	m_sorted = false;
+}
+
+void RenderQueue::clear()
+{
+	m_items.clear();
+	m_entries.clear();
+	m_sorted = true;
+}
+
+void RenderQueue::sort()
+{
+	if (m_sorted)
+	{
+		return;
+	}
+	m_sorted = true;
+
+	const size_t count = m_entries.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	// one histogram per byte of the key, all filled with a single read of the keys
+	static const unsigned int NUM_DIGITS = sizeof(uint64_t);
+	size_t histograms[NUM_DIGITS][256] = {};
+	for (size_t i = 0; i < count; i++)
+	{
+		uint64_t key = m_entries[i].key;
+		for (unsigned int d = 0; d < NUM_DIGITS; d++)
+		{
+			histograms[d][(key >> (8 * d)) & 0xFF]++;
+		}
+	}
+
+	m_scratch.resize(count);
+	SortEntry* source      = m_entries.data();
+	SortEntry* destination = m_scratch.data();
+
+	for (unsigned int d = 0; d < NUM_DIGITS; d++)
+	{
+		size_t* histogram = histograms[d];
+		const unsigned int shift = 8 * d;
+
+		// all the keys share this digit: the pass would not move anything
+		if (histogram[(source[0].key >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		// turn counts into starting offsets
+		size_t offset = 0;
+		for (unsigned int b = 0; b < 256; b++)
+		{
+			size_t bucketSize = histogram[b];
+			histogram[b] = offset;
+			offset += bucketSize;
+		}
+
+		// stable scatter
+		for (size_t i = 0; i < count; i++)
+		{
+			destination[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+		}
+		std::swap(source, destination);
+	}
+
+	// the sorted sequence ended up in the scratch buffer
+	if (source != m_entries.data())
+	{
+		m_entries.swap(m_scratch);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <cstdint>
+
+#include "Renderer.h"
+#include "../Model/Mesh.h"
+#include "../utils/FrameArena.h"
+
+
+//! A single draw of a mesh, as stored in the RenderQueue.
+struct RenderItem
+{
+	const Mesh*   mesh;
+	Shader*       shader;
+	unsigned int  materialID;  //!< equal IDs mean equal textures and shininess
+	unsigned int  matrixIndex; //!< index of the model/normal matrices owned by the renderer
+	bool          visible;     //!< false if outside the view frustum at submission
+};
+
+
+//! Queue of draws ordered by a 64-bit sort key.
+/*!
+	Each pushed RenderItem comes with a key that packs (from the most significant bits):
+	pass | shader | material | mesh | quantized depth, or pass | depth | shader | material | mesh for PASS_TRANSPARENT.
+	After sorting, consecutive opaque items share as much state as possible, so that a renderer walking
+	the queue only needs to bind a shader, a material or a vao when the corresponding bits change; transparent
+	items are in depth order first (back to front with reversed depths, see quantizeDepth), whatever their state.
+	The keys are sorted with a LSD radix sort once per frame.
+	Given a FrameArena, the queue keeps its items in frame memory: call renew at the start of each frame.
+*/
+class RenderQueue
+{
+public:
+	static const unsigned int PASS_BITS     = 4;
+	static const unsigned int SHADER_BITS   = 10;
+	static const unsigned int MATERIAL_BITS = 14;
+	static const unsigned int MESH_BITS     = 16;
+	static const unsigned int DEPTH_BITS    = 20;
+
+	//!< Packs the fields into a sort key. Fields wider than their bits are wrapped (which only affects the order, not the correctness).
+	static uint64_t makeKey(unsigned int pass, unsigned int shaderID, unsigned int materialID, unsigned int meshID, unsigned int depth);
+	//!< Quantizes a depth in [0, maxDepth] to DEPTH_BITS. With reversed = true, far objects get smaller keys (back to front drawing).
+	static unsigned int quantizeDepth(float depth, float maxDepth, bool reversed);
+	//!< Pass packed in the key.
+	static unsigned int passOf(uint64_t key) { return (unsigned int)(key >> (SHADER_BITS + MATERIAL_BITS + MESH_BITS + DEPTH_BITS)); }
+
+	explicit RenderQueue(memory::FrameArena* arena = nullptr);
+
+	void reserve(size_t size);
+	//!< Moves the items to memory of the current frame of the arena, with room for reserved items.
+	void renew(size_t reserved);
+	void push(uint64_t key, const RenderItem& item);
+	//!< Radix sorts the keys. Does nothing if the queue is already sorted.
+	void sort();
+	void clear();
+
+	size_t size() const { return m_entries.size(); }
+	bool   empty() const { return m_entries.empty(); }
+
+	//!< i-th item in key order (requires sort() to have been called after the last push)
+	const RenderItem& at(size_t i) const { return m_items[m_entries[i].index]; }
+	uint64_t       keyAt(size_t i) const { return m_entries[i].key; }
+	//!< Order in which the i-th item in key order was pushed.
+	uint32_t     indexAt(size_t i) const { return m_entries[i].index; }
+	//!< i-th item in key order, to change what the key does not depend on (e.g. the visibility).
+	RenderItem&       at(size_t i)       { return m_items[m_entries[i].index]; }
+
+private:
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t index;
+	};
+
+	memory::FrameVector<RenderItem> m_items;
+	memory::FrameVector<SortEntry>  m_entries;
+	memory::FrameVector<SortEntry>  m_scratch;
+	bool                            m_sorted;
+};
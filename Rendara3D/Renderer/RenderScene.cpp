@@ -0,0 +1,87 @@
+#include "RenderScene.h"
+
+/* stl */
+#include <stdexcept>
+
+RenderScene::RenderScene(size_t maxObjects) : m_handles(maxObjects), m_version(0)
+{
+	m_objects.reserve(maxObjects);
+	m_matrices.reserve(maxObjects);
+	m_isChanged.reserve(maxObjects);
+}
+
+memory::Handle RenderScene::add(const RenderingSpecification& specification)
+{
+	// the draws of a scene are sorted once, without depth: blended objects would not be drawn back to front
+	if (specification.pass == PASS_TRANSPARENT)
+	{
+		throw std::invalid_argument("RenderScene: transparent objects must be submitted every frame.");
+	}
+	memory::Handle handle = m_handles.insert();
+	m_objects.push_back(specification);
+	m_matrices.push_back({});
+	m_isChanged.push_back(0);
+	computeMatrices(m_objects.size() - 1);
+	structureChanged();
+	return handle;
+}
+
+void RenderScene::update(memory::Handle handle, const Transform& transform)
+{
+	size_t i = m_handles.indexOf(handle);
+	m_objects[i].transform = transform;
+	computeMatrices(i);
+	if (!m_isChanged[i])
+	{
+		m_isChanged[i] = 1;
+		m_changed.push_back((uint32_t)i);
+	}
+}
+
+void RenderScene::remove(memory::Handle handle)
+{
+	if (!m_handles.contains(handle))
+	{
+		return;
+	}
+	// the last object moves into the hole, as in the handle table
+	size_t i = m_handles.indexOf(handle);
+	m_handles.eraseAt(i);
+	m_objects[i] = m_objects.back();
+	m_matrices[i] = m_matrices.back();
+	m_objects.pop_back();
+	m_matrices.pop_back();
+	m_isChanged.pop_back();
+	structureChanged();
+}
+
+void RenderScene::clear()
+{
+	while (m_handles.size() > 0)
+	{
+		m_handles.eraseAt(m_handles.size() - 1);
+	}
+	m_objects.clear();
+	m_matrices.clear();
+	m_isChanged.clear();
+	structureChanged();
+}
+
+void RenderScene::computeMatrices(size_t i)
+{
+	glm::mat4 modelMatrix = m_objects[i].transform.getModelMatrix();
+	m_matrices[i] = { modelMatrix, glm::mat4{ glm::mat3{ glm::inverse(glm::transpose(modelMatrix)) } } };
+}
+
+void RenderScene::structureChanged()
+{
+	m_version++;
+	for (size_t c = 0; c < m_changed.size(); c++)
+	{
+		if (m_changed[c] < m_isChanged.size())
+		{
+			m_isChanged[m_changed[c]] = 0;
+		}
+	}
+	m_changed.clear();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <cstddef>
+
+#include "Renderer.h"
+#include "CommandList.h"
+#include "../utils/SlotMap.h"
+
+
+//! Objects that stay from one frame to the next, drawn by a Simple3DRenderer without being submitted again.
+/*!
+	The renderer keeps the sorted draw list and the uploaded matrices of the scene across frames (see
+	Simple3DRenderer::setScene), so objects that never move cost nothing per frame. A scene is drawn by a single renderer.
+*/
+class RenderScene
+{
+public:
+	explicit RenderScene(size_t maxObjects);
+
+	RenderScene(const RenderScene&) = delete;
+	RenderScene& operator=(const RenderScene&) = delete;
+
+	//!< Adds an object, drawn every frame until removed. Its matrices are computed here and by update only.
+	//!< Only opaque objects: the scene is not depth sorted, so PASS_TRANSPARENT throws std::invalid_argument.
+	memory::Handle add(const RenderingSpecification& specification);
+	//!< Moves the object. Only its own draws are refreshed and uploaded by the next draw.
+	void update(memory::Handle handle, const Transform& transform);
+	//!< Removes the object: the handle becomes invalid. Does nothing if it already is.
+	//!< The last object moves into its place, and the next draw rebuilds the draw list of the whole scene.
+	void remove(memory::Handle handle);
+	//!< Removes all the objects.
+	void clear();
+
+	bool   contains(memory::Handle handle) const { return m_handles.contains(handle); }
+	size_t size() const { return m_objects.size(); }
+	const RenderingSpecification& get(memory::Handle handle) const { return m_objects[m_handles.indexOf(handle)]; }
+
+	// used by the renderer drawing the scene
+	//!< Object at position i, and its matrices.
+	const RenderingSpecification& at(size_t i) const  { return m_objects[i]; }
+	const DrawMatrices&           matricesAt(size_t i) const { return m_matrices[i]; }
+	//!< Changes when objects are added or removed.
+	size_t getVersion() const { return m_version; }
+	//!< Calls function(i) for the position i of each object updated since the last call, then forgets them.
+	template <class Function>
+	void consumeChanges(Function function)
+	{
+		for (size_t c = 0; c < m_changed.size(); c++)
+		{
+			function((size_t)m_changed[c]);
+			m_isChanged[m_changed[c]] = 0;
+		}
+		m_changed.clear();
+	}
+
+private:
+	memory::HandleTable                 m_handles;
+	std::vector<RenderingSpecification> m_objects;
+	std::vector<DrawMatrices>           m_matrices;
+	std::vector<uint32_t>               m_changed;    // positions of the objects updated since the last draw
+	std::vector<unsigned char>          m_isChanged;  // per position, to list an object once
+	size_t                              m_version;
+
+	void computeMatrices(size_t i);
+	//!< The renderer rebuilds everything: the pending changes are not needed anymore.
+	void structureChanged();
+};
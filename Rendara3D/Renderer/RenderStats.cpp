@@ -0,0 +1,163 @@
+#include "RenderStats.h"
+
+/* stl */
+#include <iomanip>
+#include <unordered_map>
+
+
+namespace {
+
+	RenderCounters                          s_counters;
+	std::vector<RenderPassCounters>         s_passes;
+	std::unordered_map<std::string, size_t> s_passIndex;
+	std::vector<size_t>                     s_openPasses;
+	RenderCounters*                         s_pass = nullptr;   // innermost open pass
+
+	// counters of the frame and of the innermost pass
+	template <typename Function>
+	void count(Function function)
+	{
+		function(s_counters);
+		if (s_pass != nullptr)
+		{
+			function(*s_pass);
+		}
+	}
+
+	void updateCurrentPass()
+	{
+		s_pass = s_openPasses.empty() ? nullptr : &s_passes.at(s_openPasses.back()).counters;
+	}
+
+	void writeRow(std::ostream& out, const std::string& name, const RenderCounters& c)
+	{
+		out << std::left << std::setw(24) << name << std::right
+			<< std::setw(8) << c.drawCalls << std::setw(10) << c.instancedDraws << std::setw(10) << c.instances
+			<< std::setw(10) << c.indirectDraws << std::setw(11) << c.triangles << std::setw(9) << c.programBinds
+			<< std::setw(10) << c.textureBinds << std::setw(6) << c.framebufferBinds << std::setw(10) << c.uniformUploads
+			<< std::setw(12) << c.bufferBytes << std::setw(12) << c.textureBytes << "\n";
+	}
+
+}
+
+
+void RenderStats::countDraw(size_t triangles)
+{
+	count([triangles](RenderCounters& c) { c.drawCalls++; c.instances++; c.triangles += triangles; });
+}
+
+void RenderStats::countInstancedDraw(size_t trianglesPerInstance, size_t instances)
+{
+	count([trianglesPerInstance, instances](RenderCounters& c)
+	{
+		c.drawCalls++;
+		c.instancedDraws++;
+		c.instances += instances;
+		c.triangles += trianglesPerInstance * instances;
+	});
+}
+
+void RenderStats::countMultiDraw(size_t draws, size_t instances, size_t triangles)
+{
+	count([draws, instances, triangles](RenderCounters& c)
+	{
+		c.drawCalls++;
+		c.indirectDraws += draws;
+		c.instances += instances;
+		c.triangles += triangles;
+	});
+}
+
+void RenderStats::countProgramBind()
+{
+	count([](RenderCounters& c) { c.programBinds++; });
+}
+
+void RenderStats::countTextureBind()
+{
+	count([](RenderCounters& c) { c.textureBinds++; });
+}
+
+void RenderStats::countFramebufferBind()
+{
+	count([](RenderCounters& c) { c.framebufferBinds++; });
+}
+
+void RenderStats::countUniformUpload()
+{
+	count([](RenderCounters& c) { c.uniformUploads++; });
+}
+
+void RenderStats::countBufferUpload(size_t bytes)
+{
+	count([bytes](RenderCounters& c) { c.bufferUploads++; c.bufferBytes += bytes; });
+}
+
+void RenderStats::countTextureUpload(size_t bytes)
+{
+	count([bytes](RenderCounters& c) { c.textureUploads++; c.textureBytes += bytes; });
+}
+
+void RenderStats::beginPass(const std::string& name)
+{
+	auto it = s_passIndex.find(name);
+	size_t index;
+	if (it != s_passIndex.end())
+	{
+		index = it->second;
+	}
+	else
+	{
+		RenderPassCounters pass;
+		pass.name = name;
+		pass.depth = (int)s_openPasses.size();
+		s_passes.push_back(pass);
+		index = s_passes.size() - 1;
+		s_passIndex[name] = index;
+	}
+	s_openPasses.push_back(index);
+	updateCurrentPass();
+}
+
+void RenderStats::endPass()
+{
+	if (!s_openPasses.empty())
+	{
+		s_openPasses.pop_back();
+	}
+	updateCurrentPass();
+}
+
+const RenderCounters& RenderStats::get()
+{
+	return s_counters;
+}
+
+const std::vector<RenderPassCounters>& RenderStats::getPasses()
+{
+	return s_passes;
+}
+
+void RenderStats::dump(std::ostream& out)
+{
+	out << std::left << std::setw(24) << "pass" << std::right
+		<< std::setw(8) << "draws" << std::setw(10) << "instanced" << std::setw(10) << "instances"
+		<< std::setw(10) << "indirect" << std::setw(11) << "triangles" << std::setw(9) << "programs"
+		<< std::setw(10) << "textures" << std::setw(6) << "fbos" << std::setw(10) << "uniforms"
+		<< std::setw(12) << "buffer B" << std::setw(12) << "texture B" << "\n";
+	writeRow(out, "total", s_counters);
+	for (const RenderPassCounters& pass : s_passes)
+	{
+		writeRow(out, std::string(2 * (pass.depth + 1), ' ') + pass.name, pass.counters);
+	}
+	out.flush();
+}
+
+void RenderStats::reset()
+{
+	s_counters = RenderCounters{};
+	for (RenderPassCounters& pass : s_passes)
+	{
+		pass.counters = RenderCounters{};
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+/* stl */
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <ostream>
+
+
+//! Work submitted to OpenGL: draw calls and what they drew, state changes and uploads.
+struct RenderCounters
+{
+	size_t drawCalls = 0;
+	size_t instancedDraws = 0;   // included in drawCalls
+	size_t instances = 0;        // every non-instanced draw counts as one instance
+	size_t indirectDraws = 0;    // draws of the glMultiDraw*Indirect calls, each call counted once in drawCalls
+	size_t triangles = 0;
+	size_t programBinds = 0;
+	size_t textureBinds = 0;
+	size_t framebufferBinds = 0;
+	size_t uniformUploads = 0;   // glUniform* calls
+	size_t bufferUploads = 0;
+	size_t bufferBytes = 0;      // glBufferData / glBufferSubData with data, and writes to mapped uniform buffers
+	size_t textureUploads = 0;
+	size_t textureBytes = 0;     // glTexImage2D with data
+};
+
+//! Counters of the work done inside a pass.
+struct RenderPassCounters
+{
+	std::string    name;
+	int            depth;        // 0 for the passes opened outside any other
+	RenderCounters counters;
+};
+
+//! Counts the draw calls, state changes and uploads of the engine.
+/*!
+	Every draw call of the engine (Mesh, ScreenQuad, shadow map debug quad, the multi-draws of Simple3DRenderer) adds
+	itself to the counters, and so do the program, texture and framebuffer binds that reach OpenGL through GLState,
+	the uniforms set by Shader and the uploads of Buffer, Texture and FrameUniforms. Game code has nothing to call besides reset.
+	The work is also added to the innermost open pass. The passes are the scopes of GpuProfiler (it calls
+	beginPass and endPass whether it is enabled or not), so "frame" holds what is not in a narrower pass.
+	Nothing resets the counters on its own: read them with get and call reset at the start of what is measured,
+	usually a frame. Like the OpenGL calls it counts, it must be used from the thread owning the context.
+*/
+class RenderStats
+{
+public:
+	//!< Adds a draw call of one instance of triangles triangles.
+	static void countDraw(size_t triangles);
+	//!< Adds an instanced draw call of instances instances of trianglesPerInstance triangles.
+	static void countInstancedDraw(size_t trianglesPerInstance, size_t instances);
+	//!< Adds a multi-draw call of draws draws, with instances instances and triangles triangles in all.
+	static void countMultiDraw(size_t draws, size_t instances, size_t triangles);
+	static void countProgramBind();
+	static void countTextureBind();
+	static void countFramebufferBind();
+	static void countUniformUpload();
+	static void countBufferUpload(size_t bytes);
+	static void countTextureUpload(size_t bytes);
+
+	//!< Work counted until the matching endPass also goes to the pass name (summed over the passes with that name).
+	static void beginPass(const std::string& name);
+	static void endPass();
+
+	//!< Counters of the whole frame.
+	static const RenderCounters& get();
+	//!< Counters of every pass seen so far, in the order they first appeared.
+	static const std::vector<RenderPassCounters>& getPasses();
+	//!< Writes a table of the counters, total and per pass.
+	static void dump(std::ostream& out);
+	//!< Sets the counters to zero (the pass names stay).
+	static void reset();
+};
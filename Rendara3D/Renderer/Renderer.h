@@ -3,12 +3,20 @@
 #include "../Renderer/Transform.h"
 #include "../Model/Model.h"
 
+// Passes are drawn in this order. Opaque objects are drawn front to back, transparent ones back to front.
+enum RenderPass
+{
+	PASS_OPAQUE      = 0,
+	PASS_TRANSPARENT = 1
+};
+
 // Specifies the information needed for drawing a 3D model on the screen 
 struct RenderingSpecification
 {
 	const Model* model;     // what to draw
 	Transform    transform;	// where to draw
 	Shader*      shader;	// how to draw
+	RenderPass   pass = PASS_OPAQUE; // when to draw
 };
 
 
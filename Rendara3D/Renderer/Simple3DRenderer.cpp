@@ -0,0 +1,605 @@
+#include "Simple3DRenderer.h"
+#include "../utils/AllocationTracker.h"
+#include "RenderStats.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/CpuProfiler.h"
+
+/* stl */
+#include <algorithm>
+
+Simple3DRenderer::Simple3DRenderer(size_t reservedSize, memory::FrameArena& arena)
+	: m_arena(&arena), m_arenaFrame((size_t)-1), m_reservedSize(reservedSize), m_queue(&arena),
+	m_matrices(memory::FrameAllocator<DrawMatrices>(&arena)),
+	m_instancingThreshold(8), m_instanceData(memory::FrameAllocator<InstanceData>(&arena)),
+	m_instanceBuffer(GL_ARRAY_BUFFER), m_instancesUploaded(false),
+	m_pool(nullptr), m_commands(memory::FrameAllocator<DrawElementsIndirectCommand>(&arena)),
+	m_batches(memory::FrameAllocator<DrawBatch>(&arena)), m_commandBuffer(GL_DRAW_INDIRECT_BUFFER),
+	m_numCulled(0), m_scene(nullptr), m_sceneVersion((size_t)-1), m_sceneInstanceBuffer(GL_ARRAY_BUFFER), m_sceneDirty(0),
+	m_sceneCulling(false)
+{
+	m_immediate.reserve(16, 1);
+}
+
+void Simple3DRenderer::renewFrame()
+{
+	if (m_arenaFrame == m_arena->getFrame())
+	{
+		return;
+	}
+	m_arenaFrame = m_arena->getFrame();
+	// usually empty: the level cleared the renderer at the end of the previous frame
+	m_queue.renew(m_reservedSize);
+	memory::renewFrameVector(m_matrices, m_reservedSize);
+	memory::renewFrameVector(m_instanceData, 0);
+	memory::renewFrameVector(m_commands, 0);
+	memory::renewFrameVector(m_batches, 0);
+}
+
+void Simple3DRenderer::setViewPoint(const glm::vec3& eye, float maxDepth)
+{
+	m_view.viewPoint = eye;
+	m_view.maxDepth = maxDepth;
+	m_view.hasViewPoint = true;
+}
+
+void Simple3DRenderer::setFrustum(const Frustum& frustum)
+{
+	m_view.frustum = frustum;
+	m_view.cullingEnabled = true;
+}
+
+void Simple3DRenderer::setInstancedShader(const Shader* shader, Shader* instancedShader)
+{
+	if (instancedShader == nullptr)
+	{
+		m_instancedShaders.erase(shader);
+	}
+	else
+	{
+		m_instancedShaders[shader] = instancedShader;
+	}
+}
+
+Shader* Simple3DRenderer::getInstancedShader(const Shader* shader) const
+{
+	auto it = m_instancedShaders.find(shader);
+	return (it == m_instancedShaders.end()) ? nullptr : it->second;
+}
+
+void Simple3DRenderer::submit(RenderingSpecification renderingSpecification)
+{
+	ALLOCATION_FREE_SCOPE("Simple3DRenderer::submit");
+	m_immediate.clear();
+	m_immediate.record(renderingSpecification, m_view);
+	submit(m_immediate);
+}
+
+void Simple3DRenderer::submit(const CommandList& list)
+{
+	renewFrame();
+
+	unsigned int firstMatrix = (unsigned int)m_matrices.size();
+	for (size_t i = 0; i < list.getNumObjects(); i++)
+	{
+		m_matrices.push_back(list.matricesAt(i));
+	}
+
+	// the IDs are looked up again only when the mesh or the shader changes: the meshes of a model come one after the other
+	const Mesh*   lastMesh   = nullptr;
+	const Shader* lastShader = nullptr;
+	unsigned int  meshID = 0, materialID = 0, shaderID = 0;
+	for (size_t i = 0; i < list.size(); i++)
+	{
+		const DrawPacket& packet = list.at(i);
+		if (packet.mesh != lastMesh)
+		{
+			lastMesh = packet.mesh;
+			meshID = getMeshID(packet.mesh);
+			materialID = getMaterialID(packet.mesh->getMaterial());
+		}
+		if (packet.shader != lastShader)
+		{
+			lastShader = packet.shader;
+			shaderID = getShaderID(packet.shader);
+		}
+		uint64_t key = RenderQueue::makeKey(packet.pass, shaderID, materialID, meshID, packet.depth);
+		m_queue.push(key, { packet.mesh, packet.shader, materialID, firstMatrix + packet.matrixIndex, packet.visible });
+	}
+	m_numCulled += list.getNumCulled();
+	m_instancesUploaded = false;
+}
+
+void Simple3DRenderer::submitParallel(const RenderingSpecification* specifications, size_t count)
+{
+	submitParallel(count, [specifications](size_t i) { return specifications[i]; });
+}
+
+void Simple3DRenderer::submitParallel(size_t count, const std::function<RenderingSpecification(size_t)>& specification)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	size_t numChunks = (count + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+	if (m_chunkLists.size() < numChunks)
+	{
+		m_chunkLists.resize(numChunks);
+	}
+
+	{
+		CPU_PROFILE_SCOPE("Simple3DRenderer::submitParallel (record)");
+		const RecordingView& view = m_view;
+		ThreadPool::shared().parallelFor(count, PARALLEL_CHUNK, [this, &view, &specification](size_t begin, size_t end)
+		{
+			CommandList& list = m_chunkLists[begin / PARALLEL_CHUNK];
+			list.clear();
+			for (size_t i = begin; i < end; i++)
+			{
+				list.record(specification(i), view);
+			}
+		});
+	}
+
+	// merged in chunk order: the same queue as submitting the objects one by one
+	CPU_PROFILE_SCOPE("Simple3DRenderer::submitParallel (merge)");
+	ALLOCATION_FREE_SCOPE("Simple3DRenderer::submitParallel");
+	for (size_t c = 0; c < numChunks; c++)
+	{
+		submit(m_chunkLists[c]);
+	}
+}
+
+void Simple3DRenderer::clear()
+{
+	renewFrame();
+	m_queue.clear();
+	m_matrices.clear();
+	m_instanceData.clear();
+	m_commands.clear();
+	m_batches.clear();
+	m_instancesUploaded = false;
+	m_numCulled = 0;
+}
+
+void Simple3DRenderer::draw()
+{
+	drawQueue(nullptr);
+}
+
+void Simple3DRenderer::draw(Shader* shader)
+{
+	drawQueue(shader);
+}
+
+void Simple3DRenderer::uploadInstances()
+{
+	if (m_instancesUploaded)
+	{
+		return;
+	}
+	m_instancesUploaded = true;
+
+	// the instances of a run are contiguous in key order, so each run reads a slice of the buffer
+	m_instanceData.resize(m_queue.size());
+	for (size_t i = 0; i < m_queue.size(); i++)
+	{
+		const DrawMatrices& matrices = m_matrices[m_queue.at(i).matrixIndex];
+		m_instanceData[i] = { matrices.model, matrices.normal };
+	}
+	// a new store each frame: the driver does not have to wait for the draws of the previous frame
+	m_instanceBuffer.setData(m_instanceData.data(), m_instanceData.size() * sizeof(InstanceData), GL_STREAM_DRAW);
+	m_instanceBuffer.unbind();
+}
+
+void Simple3DRenderer::setScene(RenderScene* scene)
+{
+	m_scene = scene;
+	m_sceneVersion = (size_t)-1;
+	m_sceneQueue.clear();
+}
+
+void Simple3DRenderer::prepareInstances(const DrawList& list)
+{
+	// the instances of the scene are kept up to date by syncScene
+	if (!list.scene)
+	{
+		uploadInstances();
+	}
+}
+
+const DrawMatrices& Simple3DRenderer::matricesOf(const DrawList& list, const RenderItem& item) const
+{
+	return list.scene ? m_scene->matricesAt(item.matrixIndex) : m_matrices[item.matrixIndex];
+}
+
+void Simple3DRenderer::syncScene()
+{
+	if (m_scene == nullptr)
+	{
+		return;
+	}
+
+	if (m_sceneVersion != m_scene->getVersion())
+	{
+		rebuildScene();
+	}
+	else
+	{
+		// only the meshes of the moved objects
+		m_scene->consumeChanges([this](size_t object)
+		{
+			for (uint32_t item = m_sceneFirstItem[object]; item < m_sceneFirstItem[object + 1]; item++)
+			{
+				refreshSceneItem(m_scenePositions[item]);
+			}
+		});
+	}
+
+	// the visibility of all the meshes changes with the frustum only
+	bool frustumChanged = (m_view.cullingEnabled != m_sceneCulling);
+	for (unsigned int p = 0; p < Frustum::NUM_PLANES && m_view.cullingEnabled && !frustumChanged; p++)
+	{
+		frustumChanged = (m_view.frustum.getPlane(p) != m_sceneFrustum.getPlane(p));
+	}
+	if (frustumChanged)
+	{
+		m_sceneCulling = m_view.cullingEnabled;
+		m_sceneFrustum = m_view.frustum;
+		for (size_t i = 0; i < m_sceneQueue.size(); i++)
+		{
+			m_sceneQueue.at(i).visible = !m_sceneCulling || m_sceneFrustum.intersects(m_sceneSpheres[i]);
+		}
+	}
+
+	// dirty ranges closer than this (in instances) are uploaded together
+	const size_t UPLOAD_MERGE_GAP = 16;
+	m_sceneDirty.forEachRange(m_sceneInstances.size(), UPLOAD_MERGE_GAP, [this](size_t begin, size_t end)
+	{
+		m_sceneInstanceBuffer.setSubData(begin * sizeof(InstanceData), m_sceneInstances.data() + begin, (end - begin) * sizeof(InstanceData));
+	});
+	m_sceneDirty.clear();
+	m_sceneInstanceBuffer.unbind();
+}
+
+void Simple3DRenderer::rebuildScene()
+{
+	CPU_PROFILE_SCOPE("Simple3DRenderer::rebuildScene");
+	m_sceneVersion = m_scene->getVersion();
+	m_scene->consumeChanges([](size_t) {});
+
+	// the draws of the scene are ordered by state only: their depth would change with every move of the camera
+	m_sceneQueue.clear();
+	m_sceneFirstItem.resize(m_scene->size() + 1);
+	for (size_t object = 0; object < m_scene->size(); object++)
+	{
+		const RenderingSpecification& specification = m_scene->at(object);
+		m_sceneFirstItem[object] = (uint32_t)m_sceneQueue.size();
+		unsigned int shaderID = getShaderID(specification.shader);
+		const std::vector<Mesh>* meshes = specification.model->getMeshes();
+		for (size_t m = 0; m < meshes->size(); m++)
+		{
+			const Mesh* mesh = &meshes->at(m);
+			unsigned int materialID = getMaterialID(mesh->getMaterial());
+			uint64_t key = RenderQueue::makeKey(specification.pass, shaderID, materialID, getMeshID(mesh), 0);
+			m_sceneQueue.push(key, { mesh, specification.shader, materialID, (unsigned int)object, true });
+		}
+	}
+	m_sceneFirstItem[m_scene->size()] = (uint32_t)m_sceneQueue.size();
+	m_sceneQueue.sort();
+
+	size_t count = m_sceneQueue.size();
+	m_scenePositions.resize(count);
+	m_sceneInstances.resize(count);
+	m_sceneSpheres.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		m_scenePositions[m_sceneQueue.indexAt(i)] = (uint32_t)i;
+	}
+	m_sceneDirty.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		refreshSceneItem(i);
+	}
+	// all of it, in a new store only when the scene outgrew the current one
+	m_sceneDirty.clear();
+	if (count * sizeof(InstanceData) > m_sceneInstanceBuffer.getSize())
+	{
+		m_sceneInstanceBuffer.setData(m_sceneInstances.data(), count * sizeof(InstanceData), GL_DYNAMIC_DRAW);
+	}
+	else if (count > 0)
+	{
+		m_sceneInstanceBuffer.setSubData(0, m_sceneInstances.data(), count * sizeof(InstanceData));
+	}
+	m_sceneInstanceBuffer.unbind();
+	m_sceneCulling = !m_view.cullingEnabled;
+}
+
+void Simple3DRenderer::refreshSceneItem(size_t i)
+{
+	RenderItem& item = m_sceneQueue.at(i);
+	const DrawMatrices& matrices = m_scene->matricesAt(item.matrixIndex);
+	m_sceneInstances[i] = { matrices.model, matrices.normal };
+	m_sceneSpheres[i] = item.mesh->getBounds().sphere.transformed(matrices.model);
+	item.visible = !m_sceneCulling || m_sceneFrustum.intersects(m_sceneSpheres[i]);
+	m_sceneDirty.mark(i);
+}
+
+void Simple3DRenderer::drawQueue(Shader* overrideShader)
+{
+	// rebuilding the scene after objects were added or removed grows its containers: not part of the scope below
+	syncScene();
+
+	ALLOCATION_FREE_SCOPE("Simple3DRenderer::draw");
+	renewFrame();
+	m_queue.sort();
+
+	DrawList lists[2] = { { &m_sceneQueue, &m_sceneInstanceBuffer, true }, { &m_queue, &m_instanceBuffer, false } };
+	size_t   begins[2] = { 0, 0 };
+
+	// pass by pass: the objects of the scene, then the submitted ones
+	while (begins[0] < m_sceneQueue.size() || begins[1] < m_queue.size())
+	{
+		unsigned int pass = ~0u;
+		for (size_t l = 0; l < 2; l++)
+		{
+			if (begins[l] < lists[l].queue->size())
+			{
+				pass = std::min(pass, RenderQueue::passOf(lists[l].queue->keyAt(begins[l])));
+			}
+		}
+		for (size_t l = 0; l < 2; l++)
+		{
+			const RenderQueue& queue = *lists[l].queue;
+			size_t end = begins[l];
+			while (end < queue.size() && RenderQueue::passOf(queue.keyAt(end)) == pass)
+			{
+				end++;
+			}
+			if (end == begins[l])
+			{
+				continue;
+			}
+			if (usesMultiDrawIndirect())
+			{
+				drawRangeIndirect(lists[l], begins[l], end, overrideShader);
+			}
+			else
+			{
+				drawRange(lists[l], begins[l], end, overrideShader);
+			}
+			begins[l] = end;
+		}
+	}
+}
+
+void Simple3DRenderer::drawRange(const DrawList& list, size_t begin, size_t end, Shader* overrideShader)
+{
+	const RenderQueue& queue = *list.queue;
+
+	// the culled items are only skipped by the passes that use the submitted shaders
+	const bool cull = (overrideShader == nullptr);
+
+	const Shader* boundShader   = nullptr;
+	const Mesh*   boundMesh     = nullptr;
+	unsigned int  boundMaterial = 0;
+	bool          materialBound = false;
+
+	size_t i = begin;
+	while (i < end)
+	{
+		const RenderItem& item = queue.at(i);
+		if (cull && !item.visible)
+		{
+			i++;
+			continue;
+		}
+		Shader* shader = (overrideShader != nullptr) ? overrideShader : item.shader;
+
+		// run of draws that differ only by their matrices
+		size_t runEnd = i + 1;
+		while (runEnd < end)
+		{
+			const RenderItem& next = queue.at(runEnd);
+			Shader* nextShader = (overrideShader != nullptr) ? overrideShader : next.shader;
+			if (next.mesh != item.mesh || next.materialID != item.materialID || nextShader != shader || (cull && !next.visible))
+			{
+				break;
+			}
+			runEnd++;
+		}
+
+		Shader* instancedShader = nullptr;
+		if (runEnd - i >= m_instancingThreshold)
+		{
+			instancedShader = getInstancedShader(shader);
+		}
+		Shader* runShader = (instancedShader != nullptr) ? instancedShader : shader;
+
+		if (runShader != boundShader)
+		{
+			runShader->bind();
+			boundShader = runShader;
+			// texture units belong to the program: the material has to be passed again
+			materialBound = false;
+		}
+
+		if (!materialBound || item.materialID != boundMaterial)
+		{
+			item.mesh->getMaterial().passUniforms(*runShader);
+			boundMaterial = item.materialID;
+			materialBound = true;
+		}
+
+		if (instancedShader != nullptr)
+		{
+			prepareInstances(list);
+		}
+
+		if (item.mesh != boundMesh)
+		{
+			item.mesh->bindVao();
+			boundMesh = item.mesh;
+		}
+
+		if (instancedShader != nullptr)
+		{
+			item.mesh->setInstanceAttributes(*list.instanceBuffer, i * sizeof(InstanceData), InstanceData::layout());
+			item.mesh->drawElementsInstanced(runEnd - i);
+		}
+		else
+		{
+			for (size_t j = i; j < runEnd; j++)
+			{
+				const DrawMatrices& matrices = matricesOf(list, queue.at(j));
+				runShader->setUniformMatrix("model", matrices.model, false);
+				runShader->setUniformMatrix("normalMat", matrices.normal, false);
+				item.mesh->drawElements();
+			}
+		}
+
+		i = runEnd;
+	}
+
+	// the last vao and shader stay bound (see GLState)
+}
+
+void Simple3DRenderer::drawRangeIndirect(const DrawList& list, size_t begin, size_t end, Shader* overrideShader)
+{
+	const RenderQueue& queue = *list.queue;
+	const bool cull = (overrideShader == nullptr);
+
+	// the commands of the whole range first, so that they are uploaded at once
+	m_commands.clear();
+	m_batches.clear();
+	size_t i = begin;
+	while (i < end)
+	{
+		const RenderItem& item = queue.at(i);
+		if (cull && !item.visible)
+		{
+			i++;
+			continue;
+		}
+		Shader* shader = (overrideShader != nullptr) ? overrideShader : item.shader;
+
+		size_t runEnd = i + 1;
+		while (runEnd < end)
+		{
+			const RenderItem& next = queue.at(runEnd);
+			Shader* nextShader = (overrideShader != nullptr) ? overrideShader : next.shader;
+			if (next.mesh != item.mesh || next.materialID != item.materialID || nextShader != shader || (cull && !next.visible))
+			{
+				break;
+			}
+			runEnd++;
+		}
+
+		Shader* instancedShader = getInstancedShader(shader);
+		const GeometryRange* range = m_pool->find(item.mesh);
+		if (instancedShader == nullptr || range == nullptr)
+		{
+			m_batches.push_back({ shader, &item, false, 0, i, runEnd - i, 0, 0 });
+			i = runEnd;
+			continue;
+		}
+
+		// the instances of the run are the items i to runEnd of the instance buffer
+		size_t instances = runEnd - i;
+		m_commands.push_back({ range->indexCount, (GLuint)instances, range->firstIndex, range->baseVertex, (GLuint)i });
+		DrawBatch* last = m_batches.empty() ? nullptr : &m_batches.back();
+		if (last == nullptr || !last->indirect || last->shader != instancedShader || last->item->materialID != item.materialID
+			|| last->format != range->format)
+		{
+			m_batches.push_back({ instancedShader, &item, true, range->format, m_commands.size() - 1, 0, 0, 0 });
+			last = &m_batches.back();
+		}
+		last->count++;
+		last->instances += instances;
+		last->triangles += instances * (range->indexCount / 3);
+		i = runEnd;
+	}
+
+	if (!m_commands.empty())
+	{
+		prepareInstances(list);
+		m_commandBuffer.setData(m_commands.data(), m_commands.size() * sizeof(DrawElementsIndirectCommand), GL_STREAM_DRAW);
+	}
+
+	const Shader* boundShader   = nullptr;
+	const Mesh*   boundMesh     = nullptr;
+	unsigned int  boundMaterial = 0;
+	bool          materialBound = false;
+
+	for (const DrawBatch& batch : m_batches)
+	{
+		if (batch.shader != boundShader)
+		{
+			batch.shader->bind();
+			boundShader = batch.shader;
+			materialBound = false;
+		}
+		if (!materialBound || batch.item->materialID != boundMaterial)
+		{
+			batch.item->mesh->getMaterial().passUniforms(*batch.shader);
+			boundMaterial = batch.item->materialID;
+			materialBound = true;
+		}
+
+		if (batch.indirect)
+		{
+			m_pool->bindFormat(batch.format);
+			m_pool->setInstanceAttributes(batch.format, *list.instanceBuffer, 0, InstanceData::layout());
+			boundMesh = nullptr;
+			// the indirect buffer is not recorded by the vao: it stays bound since the upload
+			GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+				(const void*)(batch.first * sizeof(DrawElementsIndirectCommand)), (GLsizei)batch.count, 0));
+			RenderStats::countMultiDraw(batch.count, batch.instances, batch.triangles);
+			continue;
+		}
+
+		if (batch.item->mesh != boundMesh)
+		{
+			batch.item->mesh->bindVao();
+			boundMesh = batch.item->mesh;
+		}
+		for (size_t j = batch.first; j < batch.first + batch.count; j++)
+		{
+			const DrawMatrices& matrices = matricesOf(list, queue.at(j));
+			batch.shader->setUniformMatrix("model", matrices.model, false);
+			batch.shader->setUniformMatrix("normalMat", matrices.normal, false);
+			batch.item->mesh->drawElements();
+		}
+	}
+}
+
+unsigned int Simple3DRenderer::getShaderID(const Shader* shader)
+{
+	auto it = m_shaderIDs.find(shader);
+	if (it == m_shaderIDs.end())
+	{
+		it = m_shaderIDs.insert({ shader, (unsigned int)m_shaderIDs.size() }).first;
+	}
+	return it->second;
+}
+
+unsigned int Simple3DRenderer::getMeshID(const Mesh* mesh)
+{
+	auto it = m_meshIDs.find(mesh);
+	if (it == m_meshIDs.end())
+	{
+		it = m_meshIDs.insert({ mesh, (unsigned int)m_meshIDs.size() }).first;
+	}
+	return it->second;
+}
+
+unsigned int Simple3DRenderer::getMaterialID(const Material& material)
+{
+	// materials are compared by content: meshes using the same textures share the ID
+	MaterialContent content{ material.getDiffuse(), material.getSpecular(), material.getNormal(), material.getShininess() };
+	auto it = m_materialIDs.find(content);
+	if (it == m_materialIDs.end())
+	{
+		it = m_materialIDs.insert({ content, (unsigned int)m_materialIDs.size() }).first;
+	}
+	return it->second;
+}
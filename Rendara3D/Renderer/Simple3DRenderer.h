@@ -1,98 +1,177 @@
 #pragma once
 
 #include "Renderer.h"
-#include <deque>
-
-
+#include "RenderQueue.h"
+#include "CommandList.h"
+#include "RenderScene.h"
+#include "InstanceData.h"
+#include "../Camera/Frustum.h"
+#include "../buffers/GeometryPool.h"
+#include "../utils/DirtyRanges.h"
+
+/* stl */
+#include <vector>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <functional>
+
+
+//! Renderer that draws each submitted model with its own shader, ordered to minimize the state changes.
+/*!
+	Each mesh goes into a RenderQueue sorted by (pass, shader, material, mesh, depth); the draw loop binds only
+	what changes, and runs of identical draws become instanced draws (see setInstancedShader).
+*/
 class Simple3DRenderer : public Renderer
 {
-	std::vector< std::pair<Shader*, std::deque<const Model*> >  >      m_modelsTable;
-	std::vector< std::pair<Shader*, std::deque<Transform>    >  >  m_transformsTable;
-
 public:
 	Simple3DRenderer() : Simple3DRenderer(50) {}
-	Simple3DRenderer(size_t reservedSize)
-	{
-		m_modelsTable.reserve(reservedSize);
-		m_transformsTable.reserve(reservedSize);
-	}
-
-	virtual void submit(RenderingSpecification renderingSpecification) override
-	{
-		const Model* model = renderingSpecification.model;
-		Transform transform = renderingSpecification.transform;
-		Shader* shader = renderingSpecification.shader;
-
-		bool shaderAlreadyExists = false;
-		// loop over tables to see shader is already there
-		for (size_t i = 0; i < m_modelsTable.size(); i++)
-		{
-			const Shader* tableShader = m_modelsTable.at(i).first;
-			std::deque<const Model*>&     models     = m_modelsTable.at(i).second;
-			std::deque<Transform>& transforms = m_transformsTable.at(i).second;
-
-			if (shader == tableShader)
-			{
-				models.push_back(model);
-				transforms.push_back(transform);
-				shaderAlreadyExists = true;
-				break;
-			}
-		}
-		if (!shaderAlreadyExists)
-		{
-			// add entry to the vectors
-			m_modelsTable.push_back(std::make_pair(shader, std::deque<const Model*>{}));
-			m_transformsTable.push_back(std::make_pair(shader, std::deque<Transform>{}));
-			m_modelsTable.back().second.push_back(model);
-			m_transformsTable.back().second.push_back(transform);
-		}
-	}
-
-
-
-	virtual void clear() override
-	{
-		size_t currentSize = m_modelsTable.size();
-		m_modelsTable.clear();
-		m_transformsTable.clear();
-	}
+	Simple3DRenderer(size_t reservedSize, memory::FrameArena& arena = memory::FrameArena::shared());
+
+	virtual void submit(RenderingSpecification renderingSpecification) override;
+	//!< Pushes the draws recorded by the list (with the view returned by getRecordingView) into the queue.
+	void submit(const CommandList& list);
+	//!< Submits the count specifications, recorded in parallel.
+	void submitParallel(const RenderingSpecification* specifications, size_t count);
+	//!< Submits count objects recorded in parallel: specification(i) is called from the worker threads, and must only read shared data.
+	//!< Each chunk of objects is recorded into its own CommandList on ThreadPool::shared(), and the lists are merged
+	//!< in chunk order, so the queue is the same as with submit. Only the merge and the draws need the OpenGL thread.
+	void submitParallel(size_t count, const std::function<RenderingSpecification(size_t)>& specification);
+
+	virtual void clear() override;
+
+	virtual void draw() override;
+
+	virtual void draw(Shader* shader) override;
+
+	//!< Sets the position from which the depth of the submitted objects is measured, and the largest depth that is distinguished.
+	void setViewPoint(const glm::vec3& eye, float maxDepth = 100.0f);
+
+	//!< Culls the following submissions against the frustum (see Camera::getFrustum). Stays active until disableCulling.
+	//!< draw() skips the culled submissions, draw(Shader*) does not: objects outside the view can cast shadows into it.
+	void setFrustum(const Frustum& frustum);
+	void disableCulling() { m_view.cullingEnabled = false; }
+	//!< View point and frustum set on the renderer, for the command lists recorded by other threads.
+	const RecordingView& getRecordingView() const { return m_view; }
+	//!< Number of meshes culled since the last clear.
+	size_t getNumCulled() const { return m_numCulled; }
+	//!< Submitted draws in key order (the scene is not in it). Sorts the queue if needed.
+	const RenderQueue& getQueue() { m_queue.sort(); return m_queue; }
+	//!< Matrices of an item of getQueue.
+	const DrawMatrices& getMatrices(const RenderItem& item) const { return m_matrices[item.matrixIndex]; }
+
+	//!< Registers the shader used in place of the given one when a run of identical draws is instanced. Passing nullptr removes it.
+	//!< The variant reads the matrices from the instance attributes (see InstanceData); its other uniforms are set like the original's.
+	void setInstancedShader(const Shader* shader, Shader* instancedShader);
+	//!< Sets the minimum number of identical consecutive draws that are merged into an instanced draw.
+	void setInstancingThreshold(size_t threshold) { m_instancingThreshold = threshold; }
+	size_t getInstancingThreshold() const { return m_instancingThreshold; }
+
+	//!< Draws the objects of the scene with the submitted ones, every frame until set to nullptr.
+	//!< The scene is sorted once by state (no depth) and its matrices stay in an instance buffer of the renderer:
+	//!< each draw uploads only the moved objects, rebuilds everything when objects were added or removed, and culls
+	//!< again only when the frustum changed. clear forgets the submissions, never the scene.
+	void setScene(RenderScene* scene);
+
+	//!< Draws the meshes held by the pool with glMultiDrawElementsIndirect, when supported. nullptr goes back to the draws per run.
+	//!< The draws whose shader has an instanced variant become one command per run of the same mesh, and consecutive
+	//!< runs with the same shader, material and vertex format share a multi-draw call. The baseInstance of a command
+	//!< points at its matrices in the instance buffer (no gl_DrawID). The other draws are drawn one by one.
+	void setGeometryPool(const GeometryPool* pool) { m_pool = pool; }
+	//!< True if a pool is set and the context supports the multi-draws.
+	bool usesMultiDrawIndirect() const { return m_pool != nullptr && GeometryPool::isMultiDrawSupported(); }
 
-	virtual void draw() override
-	{
-		// draw
-		for (size_t i = 0; i < m_modelsTable.size(); i++)
-		{
-			Shader* shader = m_modelsTable.at(i).first;
-			shader->bind();
-			drawTable(i, shader);
-		}
+private:
+	static const size_t PARALLEL_CHUNK = 256;  // objects recorded by each task of submitParallel
 
-	}
+	typedef std::tuple<const Texture*, const Texture*, const Texture*, float> MaterialContent;
 
-	virtual void draw(Shader* shader) override
+	//! Consecutive draws with the same state: commands of one multi-draw call, or items of the queue drawn one by one.
+	struct DrawBatch
 	{
-		shader->bind();
-		// draw
-		for (size_t i = 0; i < m_modelsTable.size(); i++)
-		{
-			drawTable(i, shader);
-		}
-	}
-
-private:
-	void drawTable(size_t i, Shader* shader)
+		Shader*           shader;
+		const RenderItem* item;       // first item, for the material and the mesh
+		bool              indirect;
+		unsigned int      format;     // of the GeometryPool, if indirect
+		size_t            first;      // first command if indirect, first item of the queue otherwise
+		size_t            count;
+		size_t            instances;  // if indirect
+		size_t            triangles;  // if indirect
+	};
+
+	//! Items of a sorted queue, with their instance buffer: the submissions, or the scene.
+	struct DrawList
 	{
-		std::deque<const Model*>&     models = m_modelsTable.at(i).second;
-		std::deque<Transform>& transforms = m_transformsTable.at(i).second;
-		for (size_t j = 0; j < models.size(); j++)
-		{
-			const Model*     model = models.at(j);
-			Transform transform = transforms.at(j);
-			model->draw(transform.scale, transform.position, transform.rotation, *shader);
-		}
-	}
+		const RenderQueue* queue;
+		const Buffer*      instanceBuffer;
+		bool               scene;           // matrices of the RenderScene, uploaded by syncScene
+	};
+
+	memory::FrameArena*                m_arena;
+	size_t                             m_arenaFrame;   //!< frame of the arena the containers were renewed in
+	size_t                             m_reservedSize;
+	RenderQueue                        m_queue;
+	memory::FrameVector<DrawMatrices>  m_matrices;
+
+	// IDs used in the sort keys. They are kept across frames, so that the order of the draws is stable.
+	std::unordered_map<const Shader*, unsigned int> m_shaderIDs;
+	std::unordered_map<const Mesh*, unsigned int>   m_meshIDs;
+	std::map<MaterialContent, unsigned int>         m_materialIDs;
+
+	// instancing
+	std::unordered_map<const Shader*, Shader*> m_instancedShaders;
+	size_t                                     m_instancingThreshold;
+	memory::FrameVector<InstanceData>          m_instanceData;   //!< matrices of the queue in key order
+	Buffer                                     m_instanceBuffer;
+	bool                                       m_instancesUploaded;
+
+	// multi-draw indirect, rebuilt by each draw
+	const GeometryPool*                              m_pool;
+	memory::FrameVector<DrawElementsIndirectCommand> m_commands;
+	memory::FrameVector<DrawBatch>                   m_batches;
+	Buffer                                           m_commandBuffer;
+
+	RecordingView            m_view;
+	size_t                   m_numCulled;
+	CommandList              m_immediate;    //!< records the object of submit, merged right away
+	std::vector<CommandList> m_chunkLists;   //!< one per chunk of submitParallel
+
+	// retained scene, kept across frames
+	RenderScene*                m_scene;
+	size_t                      m_sceneVersion;     //!< of the scene when m_sceneQueue was built
+	RenderQueue                 m_sceneQueue;       //!< items pushed in the order of the objects, matrixIndex is the object
+	std::vector<uint32_t>       m_sceneFirstItem;   //!< first item of each object (and the count at the end)
+	std::vector<uint32_t>       m_scenePositions;   //!< position in key order of each item
+	std::vector<InstanceData>   m_sceneInstances;   //!< in key order, as in the instance buffer
+	std::vector<BoundingSphere> m_sceneSpheres;     //!< in key order
+	Buffer                      m_sceneInstanceBuffer;
+	memory::DirtyRanges         m_sceneDirty;       //!< instances changed since the last upload
+	Frustum                     m_sceneFrustum;     //!< the visibility of the items was computed with it
+	bool                        m_sceneCulling;
+
+	//!< Moves the containers to the memory of the current frame of the arena, the first time it is called in a frame.
+	//!< The arena keeps two frames, so the renderer must be used (or cleared) at least every other frame.
+	void renewFrame();
+
+	unsigned int getShaderID(const Shader* shader);
+	unsigned int getMeshID(const Mesh* mesh);
+	unsigned int getMaterialID(const Material& material);
+
+	//!< Draws the scene and the queue, pass by pass.
+	void drawQueue(Shader* overrideShader);
+	//!< Draws the items [begin, end) of the list in key order.
+	void drawRange(const DrawList& list, size_t begin, size_t end, Shader* overrideShader);
+	//!< Same as drawRange, through the GeometryPool.
+	void drawRangeIndirect(const DrawList& list, size_t begin, size_t end, Shader* overrideShader);
+	void prepareInstances(const DrawList& list);
+	const DrawMatrices& matricesOf(const DrawList& list, const RenderItem& item) const;
+
+	//!< Brings the draw list and the instance buffer of the scene up to date with its changes and the frustum.
+	void syncScene();
+	void rebuildScene();
+	//!< Recomputes the instance, the sphere and the visibility of the scene item at position i in key order.
+	void refreshSceneItem(size_t i);
+	//!< Fills the instance buffer with the matrices of the sorted queue. Done once per frame, the first time a run is instanced.
+	void uploadInstances();
+	Shader* getInstancedShader(const Shader* shader) const;
 };
-
-
-
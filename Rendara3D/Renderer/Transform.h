@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 struct Transform
 {
@@ -12,4 +13,16 @@ struct Transform
 	glm::vec3 position;
 	glm::vec3 rotation;
 	glm::vec3 scale;
-};
\ No newline at end of file
+
+	//!< Model matrix: translation, then rotations around z, y, x (in degrees), then scale.
+	glm::mat4 getModelMatrix() const
+	{
+		glm::mat4 modelMatrix{ 1.0 };
+		modelMatrix = glm::translate(modelMatrix, position);
+		modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.z), glm::vec3{ 0.0f,0.0f,1.0f });
+		modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.y), glm::vec3{ 0.0f,1.0f,0.0f });
+		modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.x), glm::vec3{ 1.0f,0.0f,0.0f });
+		modelMatrix = glm::scale(modelMatrix, scale);
+		return modelMatrix;
+	}
+};
@@ -0,0 +1,206 @@
+#include "TransformBatch.h"
+
+#if defined(__AVX__)
+#define TRANSFORM_BATCH_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_BATCH_SSE
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+#if defined(TRANSFORM_BATCH_AVX)
+	typedef __m256 vfloat;
+	const size_t WIDTH = 8;
+
+	inline vfloat vload(const float* p)          { return _mm256_loadu_ps(p); }
+	inline vfloat vset(float a)                  { return _mm256_set1_ps(a); }
+	inline vfloat vadd(vfloat a, vfloat b)       { return _mm256_add_ps(a, b); }
+	inline vfloat vsub(vfloat a, vfloat b)       { return _mm256_sub_ps(a, b); }
+	inline vfloat vmul(vfloat a, vfloat b)       { return _mm256_mul_ps(a, b); }
+	inline vfloat vdiv(vfloat a, vfloat b)       { return _mm256_div_ps(a, b); }
+	inline vfloat vgreater(vfloat a, vfloat b)   { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	inline vfloat vround(vfloat a)               { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	inline vfloat vselect(vfloat mask, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, mask); }
+	inline void   vstore(float* p, vfloat a)     { _mm256_storeu_ps(p, a); }
+#elif defined(TRANSFORM_BATCH_SSE)
+	typedef __m128 vfloat;
+	const size_t WIDTH = 4;
+
+	inline vfloat vload(const float* p)          { return _mm_loadu_ps(p); }
+	inline vfloat vset(float a)                  { return _mm_set1_ps(a); }
+	inline vfloat vadd(vfloat a, vfloat b)       { return _mm_add_ps(a, b); }
+	inline vfloat vsub(vfloat a, vfloat b)       { return _mm_sub_ps(a, b); }
+	inline vfloat vmul(vfloat a, vfloat b)       { return _mm_mul_ps(a, b); }
+	inline vfloat vdiv(vfloat a, vfloat b)       { return _mm_div_ps(a, b); }
+	inline vfloat vgreater(vfloat a, vfloat b)   { return _mm_cmpgt_ps(a, b); }
+	// rounds to nearest (the default rounding mode); the angles are far below 2^31
+	inline vfloat vround(vfloat a)               { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+	inline vfloat vselect(vfloat mask, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	inline void   vstore(float* p, vfloat a)     { _mm_storeu_ps(p, a); }
+#else
+	const size_t WIDTH = 1;
+#endif
+
+#if defined(TRANSFORM_BATCH_AVX) || defined(TRANSFORM_BATCH_SSE)
+	//!< x - k * 2pi, in [-pi, pi]. 2pi is split in two parts, so that k * 2pi is subtracted without losing the low bits.
+	inline vfloat vreduce(vfloat x)
+	{
+		const vfloat invTwoPi  = vset(0.159154943091895f);
+		const vfloat twoPiHigh = vset(6.28125f);
+		const vfloat twoPiLow  = vset(0.00193530717958647f);
+
+		vfloat k = vround(vmul(x, invTwoPi));
+		return vsub(vsub(x, vmul(k, twoPiHigh)), vmul(k, twoPiLow));
+	}
+
+	//!< sin(x) for x in [-pi, pi]: folded to [-pi/2, pi/2], then an odd polynomial (max error about 1e-7).
+	inline vfloat vsinReduced(vfloat x)
+	{
+		const vfloat pi     = vset(3.14159265358979f);
+		const vfloat halfPi = vset(1.57079632679490f);
+
+		// sin(x) = sin(pi - x) = sin(-pi - x)
+		x = vselect(vgreater(x, halfPi), vsub(pi, x), x);
+		x = vselect(vgreater(vsub(vset(0.0f), halfPi), x), vsub(vsub(vset(0.0f), pi), x), x);
+
+		vfloat x2 = vmul(x, x);
+		vfloat p = vset(-2.50521083854417e-8f);
+		p = vadd(vmul(p, x2), vset(2.75573192239859e-6f));
+		p = vadd(vmul(p, x2), vset(-1.98412698412698e-4f));
+		p = vadd(vmul(p, x2), vset(8.33333333333333e-3f));
+		p = vadd(vmul(p, x2), vset(-1.66666666666667e-1f));
+		p = vadd(vmul(p, x2), vset(1.0f));
+		return vmul(p, x);
+	}
+
+	//!< sin(x) and cos(x) for any x. cos(x) = sin(x + pi/2), with pi/2 added after the reduction to keep the precision.
+	inline void vsincos(vfloat x, vfloat& sine, vfloat& cosine)
+	{
+		vfloat reduced = vreduce(x);
+		sine = vsinReduced(reduced);
+		cosine = vsinReduced(vreduce(vadd(reduced, vset(1.57079632679490f))));
+	}
+#endif
+
+	inline float* matrixAt(glm::mat4* base, size_t i, size_t stride)
+	{
+		return reinterpret_cast<float*>(reinterpret_cast<char*>(base) + i * stride);
+	}
+
+}
+
+
+void TransformBatch::resize(size_t size)
+{
+	m_size = size;
+	m_paddedSize = (size + WIDTH - 1) / WIDTH * WIDTH;
+	for (int c = 0; c < 3; c++)
+	{
+		m_position[c].resize(m_paddedSize, 0.0f);
+		m_rotation[c].resize(m_paddedSize, 0.0f);
+		m_scale[c].resize(m_paddedSize, 1.0f);
+	}
+}
+
+void TransformBatch::set(size_t i, const Transform& transform)
+{
+	for (int c = 0; c < 3; c++)
+	{
+		m_position[c][i] = transform.position[c];
+		m_rotation[c][i] = transform.rotation[c];
+		m_scale[c][i]    = transform.scale[c];
+	}
+}
+
+Transform TransformBatch::get(size_t i) const
+{
+	return Transform{ glm::vec3{ m_position[0][i], m_position[1][i], m_position[2][i] },
+	                  glm::vec3{ m_rotation[0][i], m_rotation[1][i], m_rotation[2][i] },
+	                  glm::vec3{ m_scale[0][i],    m_scale[1][i],    m_scale[2][i] } };
+}
+
+void TransformBatch::computeMatricesScalar(glm::mat4* models, glm::mat4* normals, size_t stride) const
+{
+	for (size_t i = 0; i < m_size; i++)
+	{
+		glm::mat4 model = get(i).getModelMatrix();
+		*reinterpret_cast<glm::mat4*>(matrixAt(models, i, stride)) = model;
+		if (normals != nullptr)
+		{
+			*reinterpret_cast<glm::mat4*>(matrixAt(normals, i, stride)) = glm::mat4{ glm::mat3{ glm::inverse(glm::transpose(model)) } };
+		}
+	}
+}
+
+void TransformBatch::computeMatrices(glm::mat4* models, glm::mat4* normals, size_t stride) const
+{
+#if defined(TRANSFORM_BATCH_AVX) || defined(TRANSFORM_BATCH_SSE)
+	const vfloat degToRad = vset(0.0174532925199433f);
+	const vfloat one = vset(1.0f);
+
+	// the columns of the rotation, scaled, are written here and then scattered to the matrices
+	float modelColumns[9][WIDTH];
+	float normalColumns[9][WIDTH];
+
+	for (size_t b = 0; b < m_paddedSize; b += WIDTH)
+	{
+		vfloat ax = vmul(vload(&m_rotation[0][b]), degToRad);
+		vfloat ay = vmul(vload(&m_rotation[1][b]), degToRad);
+		vfloat az = vmul(vload(&m_rotation[2][b]), degToRad);
+		vfloat sinX, cosX, sinY, cosY, sinZ, cosZ;
+		vsincos(ax, sinX, cosX);
+		vsincos(ay, sinY, cosY);
+		vsincos(az, sinZ, cosZ);
+
+		// R = Rz * Ry * Rx, column by column
+		vfloat r[9];
+		r[0] = vmul(cosY, cosZ);
+		r[1] = vmul(cosY, sinZ);
+		r[2] = vsub(vset(0.0f), sinY);
+		vfloat sinYsinX = vmul(sinY, sinX);
+		vfloat sinYcosX = vmul(sinY, cosX);
+		r[3] = vsub(vmul(cosZ, sinYsinX), vmul(sinZ, cosX));
+		r[4] = vadd(vmul(sinZ, sinYsinX), vmul(cosZ, cosX));
+		r[5] = vmul(cosY, sinX);
+		r[6] = vadd(vmul(cosZ, sinYcosX), vmul(sinZ, sinX));
+		r[7] = vsub(vmul(sinZ, sinYcosX), vmul(cosZ, sinX));
+		r[8] = vmul(cosY, cosX);
+
+		// model = R * S, normal = R * S^-1
+		for (int column = 0; column < 3; column++)
+		{
+			vfloat scale = vload(&m_scale[column][b]);
+			vfloat inverseScale = vdiv(one, scale);
+			for (int row = 0; row < 3; row++)
+			{
+				vstore(modelColumns[3 * column + row], vmul(r[3 * column + row], scale));
+				vstore(normalColumns[3 * column + row], vmul(r[3 * column + row], inverseScale));
+			}
+		}
+
+		size_t lanes = (m_size - b < WIDTH) ? m_size - b : WIDTH;
+		for (size_t l = 0; l < lanes; l++)
+		{
+			float* m = matrixAt(models, b + l, stride);
+			m[0]  = modelColumns[0][l]; m[1]  = modelColumns[1][l]; m[2]  = modelColumns[2][l]; m[3]  = 0.0f;
+			m[4]  = modelColumns[3][l]; m[5]  = modelColumns[4][l]; m[6]  = modelColumns[5][l]; m[7]  = 0.0f;
+			m[8]  = modelColumns[6][l]; m[9]  = modelColumns[7][l]; m[10] = modelColumns[8][l]; m[11] = 0.0f;
+			m[12] = m_position[0][b + l]; m[13] = m_position[1][b + l]; m[14] = m_position[2][b + l]; m[15] = 1.0f;
+
+			if (normals != nullptr)
+			{
+				float* n = matrixAt(normals, b + l, stride);
+				n[0]  = normalColumns[0][l]; n[1]  = normalColumns[1][l]; n[2]  = normalColumns[2][l]; n[3]  = 0.0f;
+				n[4]  = normalColumns[3][l]; n[5]  = normalColumns[4][l]; n[6]  = normalColumns[5][l]; n[7]  = 0.0f;
+				n[8]  = normalColumns[6][l]; n[9]  = normalColumns[7][l]; n[10] = normalColumns[8][l]; n[11] = 0.0f;
+				n[12] = 0.0f;                n[13] = 0.0f;                n[14] = 0.0f;                n[15] = 1.0f;
+			}
+		}
+	}
+#else
+	computeMatricesScalar(models, normals, stride);
+#endif
+}
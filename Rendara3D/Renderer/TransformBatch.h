@@ -0,0 +1,41 @@
+#pragma once
+
+/* stl */
+#include <vector>
+
+/* maths */
+#include <glm/glm.hpp>
+
+#include "Transform.h"
+
+
+//! Transforms stored as structure of arrays, to compute their matrices several at a time with SIMD.
+/*!
+	computeMatrices gives the same matrices as Transform::getModelMatrix (T * Rz * Ry * Rx * S) and, optionally,
+	their normal matrices. Since the rotation part R is orthonormal, the normal matrix of R * S is R * S^-1:
+	it is written in closed form, without inverting anything.
+	The kernel processes 8 transforms at a time with AVX, 4 with SSE, and falls back to scalar code otherwise.
+	The matrices are written with a stride, so that they can go straight into interleaved instance data.
+*/
+class TransformBatch
+{
+public:
+	void   resize(size_t size);
+	size_t size() const { return m_size; }
+
+	void      set(size_t i, const Transform& transform);
+	Transform get(size_t i) const;
+
+	//!< Writes the model matrix of the i-th transform at (char*)models + i * stride, and its normal matrix at
+	//!< (char*)normals + i * stride (skipped if normals is nullptr). The normal matrix has no translation and w = 1.
+	void computeMatrices(glm::mat4* models, glm::mat4* normals, size_t stride) const;
+	//!< Same result, one transform at a time through glm. Used to check and measure the SIMD kernel.
+	void computeMatricesScalar(glm::mat4* models, glm::mat4* normals, size_t stride) const;
+
+private:
+	size_t             m_size = 0;
+	size_t             m_paddedSize = 0; // multiple of the SIMD width, the padding is filled with identities
+	std::vector<float> m_position[3];
+	std::vector<float> m_rotation[3];  // degrees
+	std::vector<float> m_scale[3];
+};
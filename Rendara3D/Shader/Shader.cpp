@@ -1,4 +1,7 @@
 #include "Shader.h"
+#include "UniformBlocks.h"
+#include "../Renderer/RenderStats.h"
+#include "../utils/CpuProfiler.h"
 
 static ShaderProgramSource ParseShader(const std::string& filepath)
 {
@@ -59,6 +62,7 @@ Shader& Shader::operator=(Shader&& other)
 
 void Shader::generate(const std::string& path)
 {
+	CPU_PROFILE_SCOPE("Shader::generate");
 	m_path = path;
 	ShaderProgramSource source = ParseShader(m_path);
 
@@ -115,27 +119,146 @@ void Shader::generate(const std::string& path)
 		std::cout << "Failure at linking program. Log: \n" << log << std::endl;
 		throw - 1;
 	}
+
+	reflectUniforms();
+}
+
+static bool isSamplerType(GLenum type)
+{
+	switch (type)
+	{
+	case GL_SAMPLER_1D:            case GL_SAMPLER_2D:            case GL_SAMPLER_3D:
+	case GL_SAMPLER_CUBE:          case GL_SAMPLER_1D_SHADOW:     case GL_SAMPLER_2D_SHADOW:
+	case GL_SAMPLER_1D_ARRAY:      case GL_SAMPLER_2D_ARRAY:      case GL_SAMPLER_1D_ARRAY_SHADOW:
+	case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_CUBE_SHADOW: case GL_SAMPLER_BUFFER:
+	case GL_SAMPLER_2D_RECT:       case GL_SAMPLER_2D_RECT_SHADOW:
+	case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+	case GL_INT_SAMPLER_2D:        case GL_INT_SAMPLER_3D:        case GL_INT_SAMPLER_CUBE:
+	case GL_INT_SAMPLER_2D_ARRAY:  case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+	case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void Shader::reflectUniforms()
+{
+	m_uniforms.clear();
+
+	GLint count = 0;
+	GLint maxLength = 0;
+	GLCall(glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count));
+	GLCall(glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+	std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+
+	// the samplers keep their unit for the whole life of the program: it is set here once
+	int nextTextureUnit = 0;
+	GLState::useProgram(m_id);
+	for (GLint u = 0; u < count; u++)
+	{
+		GLsizei length = 0;
+		GLint   size = 0;
+		GLenum  type = 0;
+		GLCall(glGetActiveUniform(m_id, (GLuint)u, (GLsizei)buffer.size(), &length, &size, &type, buffer.data()));
+		std::string name(buffer.data(), length);
+
+		// an array is reported once, as "name[0]", with its size
+		std::string arrayName = name;
+		bool isArray = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+		if (isArray)
+		{
+			arrayName = name.substr(0, name.size() - 3);
+		}
+
+		for (GLint element = 0; element < size; element++)
+		{
+			ActiveUniform uniform;
+			uniform.name = isArray ? arrayName + "[" + std::to_string(element) + "]" : name;
+			GLCall(uniform.handle.location = glGetUniformLocation(m_id, uniform.name.c_str()));
+			if (uniform.handle.location < 0)
+			{
+				continue; // member of a uniform block
+			}
+			uniform.handle.type = type;
+			if (isSamplerType(type))
+			{
+				uniform.handle.textureUnit = nextTextureUnit++;
+				GLCall(glUniform1i(uniform.handle.location, uniform.handle.textureUnit));
+			}
+			m_uniforms.push_back(uniform);
+
+			if (isArray && element == 0)
+			{
+				uniform.name = arrayName;
+				m_uniforms.push_back(uniform);
+			}
+		}
+	}
+	GLState::useProgram(0);
+
+	// the shared blocks go to their fixed binding points (GLSL 330 cannot give them a binding)
+	GLint blockCount = 0;
+	GLCall(glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+	for (GLint b = 0; b < blockCount; b++)
+	{
+		GLsizei length = 0;
+		char blockName[64];
+		GLCall(glGetActiveUniformBlockName(m_id, (GLuint)b, sizeof(blockName), &length, blockName));
+
+		unsigned int binding;
+		size_t expectedSize;
+		if (!findUniformBlock(std::string(blockName, length), binding, expectedSize))
+		{
+			continue;
+		}
+		GLint dataSize = 0;
+		GLCall(glGetActiveUniformBlockiv(m_id, (GLuint)b, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+		if ((size_t)dataSize != expectedSize)
+		{
+			std::cerr << "Uniform block " << blockName << " of " << m_path << " has " << dataSize << " bytes, "
+				<< expectedSize << " expected (see UniformBlocks.h)." << std::endl;
+		}
+		GLCall(glUniformBlockBinding(m_id, (GLuint)b, binding));
+	}
+
+	std::sort(m_uniforms.begin(), m_uniforms.end(), [](const ActiveUniform& a, const ActiveUniform& b) { return a.name < b.name; });
 }
 
-void Shader::setTexture(GLenum target, const std::string& uniformName, unsigned int textureID)
+UniformHandle Shader::getUniformHandle(const std::string& name) const
 {
-	std::vector<std::string>::iterator it = std::find(m_textureUnits.begin(), m_textureUnits.end(), uniformName);
-	int textureUnit;
-	if (it == m_textureUnits.end())
+	std::vector<ActiveUniform>::const_iterator it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name,
+		[](const ActiveUniform& uniform, const std::string& value) { return uniform.name < value; });
+	if (it == m_uniforms.end() || it->name != name)
 	{
-		// new texture
-		textureUnit = m_textureUnits.size();
-		setUniformValue(uniformName, textureUnit);
-		m_textureUnits.push_back(uniformName);
+		return UniformHandle{};
 	}
-	else
+	return it->handle;
+}
+
+UniformHandle Shader::getUniformHandle(const char* name) const
+{
+	std::vector<ActiveUniform>::const_iterator it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name,
+		[](const ActiveUniform& uniform, const char* value) { return uniform.name.compare(value) < 0; });
+	if (it == m_uniforms.end() || it->name.compare(name) != 0)
 	{
-		// texture unit already exists, dont set the uniform
-		textureUnit = it - m_textureUnits.begin();
+		return UniformHandle{};
 	}
+	return it->handle;
+}
+
+void Shader::setTexture(GLenum target, const std::string& uniformName, unsigned int textureID) const
+{
+	setTexture(target, getUniformHandle(uniformName), textureID);
+}
 
-	GLCall(glActiveTexture(GL_TEXTURE0 + textureUnit));
-	GLCall(glBindTexture(target, textureID));
+void Shader::setTexture(GLenum target, UniformHandle sampler, unsigned int textureID) const
+{
+	if (sampler.textureUnit < 0)
+	{
+		return; // not an active sampler: nothing would read the texture
+	}
+	GLState::bindTextureUnit(sampler.textureUnit, target, textureID);
 }
 
 unsigned int Shader::compileShader(unsigned int type, const std::string & shader)
@@ -173,81 +296,194 @@ unsigned int Shader::compileShader(unsigned int type, const std::string & shader
 void Shader::release()
 {
 	GLCall(glDeleteProgram(m_id));
+	GLState::forgetProgram(m_id);
 	m_id = 0;
 	m_path = "";
-	m_textureUnits.clear();
+	m_uniforms.clear();
 }
 
 void Shader::swapData(Shader& other)
 {
 	m_id = other.m_id;
 	m_path = other.m_path;
-	//m_textureUnits.clear(); should already be cleared during "release" in the move assignment
-	for (auto it = other.m_textureUnits.begin(); it != other.m_textureUnits.end(); ++it)
-	{
-		m_textureUnits.push_back(*it);
-	}
+	//m_uniforms.clear(); should already be cleared during "release" in the move assignment
+	m_uniforms.swap(other.m_uniforms);
 
 	other.m_id = 0;
 	other.m_path = "";
-	other.m_textureUnits.clear();
+	other.m_uniforms.clear();
 }
 
 void Shader::setUniformValue(const std::string& name, int          value) const
 {
-	int location;
-	GLCall(location = glGetUniformLocation(m_id, name.c_str()));
-	GLCall(glUniform1i(location, value));
+	setUniformValue(getUniformHandle(name), value);
 }
 void Shader::setUniformValue(const std::string& name, double       value) const
 {
-	int location;
-	GLCall(location = glGetUniformLocation(m_id, name.c_str()));
-	GLCall(glUniform1d(location, value));
+	setUniformValue(getUniformHandle(name), value);
 }
 void Shader::setUniformValue(const std::string& name, unsigned int value) const
 {
-	int location;
-	GLCall(location = glGetUniformLocation(m_id, name.c_str()));
-	GLCall(glUniform1ui(location, value));
+	setUniformValue(getUniformHandle(name), value);
 }
 
 void Shader::setUniformValue(const std::string& name, float        value) const
 {
-	int location;
-	GLCall(location = glGetUniformLocation(m_id, name.c_str()));
-	GLCall(glUniform1f(location, value));
+	setUniformValue(getUniformHandle(name), value);
 }
 
 void Shader::setUniformValue(const std::string & name, float v1, float v2) const
 {
-	int location;
-	GLCall(location = glGetUniformLocation(m_id, name.c_str()));
-	GLCall(glUniform2f(location, v1, v2));
+	setUniformValue(getUniformHandle(name), v1, v2);
 }
 
 void Shader::setUniformValue(const std::string & name, float v1, float v2, float v3) const
 {
-	int location;
-	GLCall(location = glGetUniformLocation(m_id, name.c_str()));
-	GLCall(glUniform3f(location, v1, v2, v3));
+	setUniformValue(getUniformHandle(name), v1, v2, v3);
 }
 
 void Shader::setUniformValue(const std::string & name, float v1, float v2, float v3, float v4) const
 {
-	int location;
-	GLCall(location = glGetUniformLocation(m_id, name.c_str()));
-	GLCall(glUniform4f(location, v1, v2, v3, v4));
+	setUniformValue(getUniformHandle(name), v1, v2, v3, v4);
 }
 
 void Shader::setUniformValue(const std::string & name, glm::vec3 values) const
 {
-	setUniformValue(name, values.x, values.y, values.z);
+	setUniformValue(getUniformHandle(name), values.x, values.y, values.z);
 }
 
 void Shader::setUniformMatrix(const std::string& name, const glm::mat4& matrix, bool transpose) const
 {
-	int location;
-	GLCall(location = glGetUniformLocation(m_id, name.c_str()));
-	GLCall(glUniformMatrix4fv(location, 1, transpose, glm::value_ptr(matrix) ));
+	setUniformMatrix(getUniformHandle(name), matrix, transpose);
+}
+
+void Shader::setUniformValue(const char* name, int          value) const
+{
+	setUniformValue(getUniformHandle(name), value);
+}
+void Shader::setUniformValue(const char* name, double       value) const
+{
+	setUniformValue(getUniformHandle(name), value);
+}
+void Shader::setUniformValue(const char* name, unsigned int value) const
+{
+	setUniformValue(getUniformHandle(name), value);
+}
+
+void Shader::setUniformValue(const char* name, float        value) const
+{
+	setUniformValue(getUniformHandle(name), value);
+}
+
+void Shader::setUniformValue(const char* name, float v1, float v2) const
+{
+	setUniformValue(getUniformHandle(name), v1, v2);
+}
+
+void Shader::setUniformValue(const char* name, float v1, float v2, float v3) const
+{
+	setUniformValue(getUniformHandle(name), v1, v2, v3);
+}
+
+void Shader::setUniformValue(const char* name, float v1, float v2, float v3, float v4) const
+{
+	setUniformValue(getUniformHandle(name), v1, v2, v3, v4);
+}
+
+void Shader::setUniformValue(const char* name, glm::vec3 values) const
+{
+	setUniformValue(getUniformHandle(name), values.x, values.y, values.z);
+}
+
+void Shader::setUniformMatrix(const char* name, const glm::mat4& matrix, bool transpose) const
+{
+	setUniformMatrix(getUniformHandle(name), matrix, transpose);
+}
+
+void Shader::setTexture(GLenum target, const char* uniformName, unsigned int textureID) const
+{
+	setTexture(target, getUniformHandle(uniformName), textureID);
+}
+
+void Shader::setUniformValue(UniformHandle handle, int          value) const
+{
+	if (!handle.isValid())
+	{
+		return; // not active in the program: nothing is uploaded
+	}
+	GLCall(glUniform1i(handle.location, value));
+	RenderStats::countUniformUpload();
+}
+void Shader::setUniformValue(UniformHandle handle, double       value) const
+{
+	if (!handle.isValid())
+	{
+		return;
+	}
+	GLCall(glUniform1d(handle.location, value));
+	RenderStats::countUniformUpload();
+}
+void Shader::setUniformValue(UniformHandle handle, unsigned int value) const
+{
+	if (!handle.isValid())
+	{
+		return;
+	}
+	GLCall(glUniform1ui(handle.location, value));
+	RenderStats::countUniformUpload();
+}
+
+void Shader::setUniformValue(UniformHandle handle, float        value) const
+{
+	if (!handle.isValid())
+	{
+		return;
+	}
+	GLCall(glUniform1f(handle.location, value));
+	RenderStats::countUniformUpload();
+}
+
+void Shader::setUniformValue(UniformHandle handle, float v1, float v2) const
+{
+	if (!handle.isValid())
+	{
+		return;
+	}
+	GLCall(glUniform2f(handle.location, v1, v2));
+	RenderStats::countUniformUpload();
+}
+
+void Shader::setUniformValue(UniformHandle handle, float v1, float v2, float v3) const
+{
+	if (!handle.isValid())
+	{
+		return;
+	}
+	GLCall(glUniform3f(handle.location, v1, v2, v3));
+	RenderStats::countUniformUpload();
+}
+
+void Shader::setUniformValue(UniformHandle handle, float v1, float v2, float v3, float v4) const
+{
+	if (!handle.isValid())
+	{
+		return;
+	}
+	GLCall(glUniform4f(handle.location, v1, v2, v3, v4));
+	RenderStats::countUniformUpload();
 }
+
+void Shader::setUniformValue(UniformHandle handle, glm::vec3 values) const
+{
+	setUniformValue(handle, values.x, values.y, values.z);
+}
+
+void Shader::setUniformMatrix(UniformHandle handle, const glm::mat4& matrix, bool transpose) const
+{
+	if (!handle.isValid())
+	{
+		return;
+	}
+	GLCall(glUniformMatrix4fv(handle.location, 1, transpose, glm::value_ptr(matrix) ));
+	RenderStats::countUniformUpload();
+}
\ No newline at end of file
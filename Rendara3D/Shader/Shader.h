@@ -4,10 +4,12 @@
 #include <GLFW/glfw3.h>
 
 #include "../utils/ErrorHandling.h"
+#include "../utils/GLState.h"
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <algorithm>
 
 /* maths */
 #include <glm/glm.hpp>
@@ -23,14 +25,35 @@ struct ShaderProgramSource
 static ShaderProgramSource ParseShader(const std::string& filepath);
 
 
+//! Location of an active uniform of a Shader, resolved once with Shader::getUniformHandle.
+/*!
+	A default handle (location -1) refers to a uniform that is not active in the program: setting it does
+	nothing, as glUniform does with location -1. Samplers also carry the texture unit reserved for them.
+*/
+struct UniformHandle
+{
+	int    location    = -1;
+	GLenum type        = 0;  //!< GL_FLOAT_VEC3, GL_SAMPLER_2D, ... as given by glGetActiveUniform
+	int    textureUnit = -1; //!< samplers only
+
+	bool isValid() const { return location >= 0; }
+};
+
+
 class Shader
 {
 private:
 	unsigned int m_id;
 	std::string  m_path;
 
-	//std::unordered_map<std::string, size_t> m_textureUnits;
-	std::vector<std::string> m_textureUnits;
+	// active uniforms, reflected after linking and sorted by name. Array elements are listed one by one
+	// ("shadowMap[0]", "shadowMap[1]", ...), and the name of an array alone refers to its first element.
+	struct ActiveUniform
+	{
+		std::string   name;
+		UniformHandle handle;
+	};
+	std::vector<ActiveUniform> m_uniforms;
 
 
 public:
@@ -48,8 +71,8 @@ public:
 	Shader(Shader&& other);
 	Shader& operator=(Shader&& other);
 
-	void bind()   const { GLCall(glUseProgram(m_id)); } 	
-	void unbind() const { GLCall(glUseProgram(0)); }	
+	void bind()   const { GLState::useProgram(m_id); }
+	void unbind() const { GLState::useProgram(0); }
 
 	void setUniformValue(const std::string& name, int          value) const;
 	void setUniformValue(const std::string& name, double       value) const;
@@ -63,10 +86,48 @@ public:
 	void setUniformValue(const std::string& name, glm::vec3) const;
 	void setUniformMatrix(const std::string& name, const glm::mat4& matrix, bool transpose) const;
 
-	void setTexture(GLenum target, const std::string& uniformName, unsigned int textureID);
+	//!< Binds the texture to the unit reserved for the sampler at link time.
+	void setTexture(GLenum target, const std::string& uniformName, unsigned int textureID) const;
+
+	// the same setters for literal names, looked up without building a std::string
+	void setUniformValue(const char* name, int          value) const;
+	void setUniformValue(const char* name, double       value) const;
+	void setUniformValue(const char* name, unsigned int value) const;
+
+	void setUniformValue(const char* name, float value) const;
+	void setUniformValue(const char* name, float v1, float v2) const;
+	void setUniformValue(const char* name, float v1, float v2, float v3) const;
+	void setUniformValue(const char* name, float v1, float v2, float v3, float v4) const;
+
+	void setUniformValue(const char* name, glm::vec3) const;
+	void setUniformMatrix(const char* name, const glm::mat4& matrix, bool transpose) const;
+	void setTexture(GLenum target, const char* uniformName, unsigned int textureID) const;
+
+	//!< Handle of an active uniform (or of an element of an active array), found in the reflected table
+	//!< without asking the driver. Resolve the handles once and use the overloads below in the frame loop.
+	UniformHandle getUniformHandle(const std::string& name) const;
+	//!< Same lookup for a name built without std::string (e.g. with FrameArena::concat).
+	UniformHandle getUniformHandle(const char* name) const;
+
+	void setUniformValue(UniformHandle handle, int          value) const;
+	void setUniformValue(UniformHandle handle, double       value) const;
+	void setUniformValue(UniformHandle handle, unsigned int value) const;
+
+	void setUniformValue(UniformHandle handle, float value) const;
+	void setUniformValue(UniformHandle handle, float v1, float v2) const;
+	void setUniformValue(UniformHandle handle, float v1, float v2, float v3) const;
+	void setUniformValue(UniformHandle handle, float v1, float v2, float v3, float v4) const;
+
+	void setUniformValue(UniformHandle handle, glm::vec3) const;
+	void setUniformMatrix(UniformHandle handle, const glm::mat4& matrix, bool transpose) const;
+
+	void setTexture(GLenum target, UniformHandle sampler, unsigned int textureID) const;
 
 private:
 	void generate(const std::string& path);
+	//!< Fills m_uniforms from glGetActiveUniform, gives a texture unit to each sampler and binds the shared
+	//!< uniform blocks (UniformBlocks.h) to their binding points.
+	void reflectUniforms();
 	unsigned int compileShader(unsigned int type, const std::string& shader);	
 
 	void release();
@@ -0,0 +1,81 @@
+#pragma once
+
+/* stl */
+#include <string>
+
+/* maths */
+#include <glm/glm.hpp>
+
+
+// Uniform blocks shared by the programs. Every program that declares one of them gets it bound to its fixed
+// binding point at link time (see Shader::reflectUniforms), so a buffer range bound there is seen by all of them.
+// The structs mirror the std140 layout of the blocks: a vec3 takes 16 bytes, an array element is 16-byte aligned.
+
+// must match NR_SUNS and NR_POINT_LIGHTS in the *_wlights shaders
+const size_t MAX_SUNS         = 1;
+const size_t MAX_POINT_LIGHTS = 1;
+
+enum UniformBlockBinding
+{
+	CAMERA_BLOCK_BINDING = 0,
+	LIGHTS_BLOCK_BINDING = 1
+};
+
+//! layout(std140) uniform Camera
+struct CameraBlock
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 cameraPos;  float pad0;
+};
+
+//! struct Sun of the shaders
+struct SunBlock
+{
+	glm::vec3 direction;  float pad0;
+	glm::vec3 ambient;    float pad1;
+	glm::vec3 diffuse;    float pad2;
+	glm::vec3 specular;   float pad3;
+};
+
+//! struct PointLight of the shaders
+struct PointLightBlock
+{
+	glm::vec3 position;       float pad0;
+	glm::vec3 positionWorld;  float constant;
+	float     linear;
+	float     quadratic;      float pad1[2];
+	glm::vec3 ambient;        float pad2;
+	glm::vec3 diffuse;        float pad3;
+	glm::vec3 specular;       float pad4;
+};
+
+//! layout(std140) uniform Lights
+struct LightsBlock
+{
+	SunBlock        sun[MAX_SUNS];
+	PointLightBlock pointLights[MAX_POINT_LIGHTS];
+	glm::mat4       lightSpaceMatrix[MAX_SUNS];
+};
+
+static_assert(sizeof(CameraBlock) == 144, "CameraBlock does not match the std140 layout");
+static_assert(sizeof(SunBlock) == 64, "SunBlock does not match the std140 layout");
+static_assert(sizeof(PointLightBlock) == 96, "PointLightBlock does not match the std140 layout");
+
+//!< Binding point and size (in bytes) of a shared block, given its name in the shaders. Returns false for other blocks.
+inline bool findUniformBlock(const std::string& name, unsigned int& binding, size_t& size)
+{
+	if (name == "Camera")
+	{
+		binding = CAMERA_BLOCK_BINDING;
+		size = sizeof(CameraBlock);
+		return true;
+	}
+	if (name == "Lights")
+	{
+		binding = LIGHTS_BLOCK_BINDING;
+		size = sizeof(LightsBlock);
+		return true;
+	}
+	return false;
+}
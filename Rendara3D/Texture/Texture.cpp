@@ -1,4 +1,31 @@
 #include "Texture.h"
+#include "../utils/CpuProfiler.h"
+#include "../Renderer/RenderStats.h"
+
+
+namespace {
+
+	// bytes of a width x height image in the client format and type given to glTexImage2D
+	size_t imageBytes(int width, int height, GLenum format, GLenum type)
+	{
+		size_t channels = 4;
+		if (format == GL_RED || format == GL_DEPTH_COMPONENT)
+			channels = 1;
+		else if (format == GL_RG)
+			channels = 2;
+		else if (format == GL_RGB)
+			channels = 3;
+
+		size_t channelBytes = 1;
+		if (type == GL_FLOAT || type == GL_INT || type == GL_UNSIGNED_INT)
+			channelBytes = 4;
+		else if (type == GL_HALF_FLOAT || type == GL_SHORT || type == GL_UNSIGNED_SHORT)
+			channelBytes = 2;
+
+		return (size_t)width * (size_t)height * channels * channelBytes;
+	}
+
+}
 
 Texture::Texture(const std::string& filepath, Format internalFormat)
 {
@@ -23,6 +50,10 @@ Texture::Texture(int internalFormat, int width, int height, const std::string& f
 	GLCall(glGenTextures(1, &m_id));
 	bind();
 	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, dataformat, data));
+	if (data != nullptr)
+	{
+		RenderStats::countTextureUpload(imageBytes(width, height, format, dataformat));
+	}
 	unbind();
 }
 
@@ -50,29 +81,26 @@ Texture::~Texture()
 
 void Texture::set2DTextureParameter(GLenum pname, GLint param) 
 {
-	GLuint previouslyBoundTexture = 0;
-	GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&previouslyBoundTexture));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_id));
+	unsigned int previouslyBoundTexture = GLState::getBoundTexture(GL_TEXTURE_2D);
+	GLState::bindTexture(GL_TEXTURE_2D, m_id);
 	GLCall(glTexParameteri(GL_TEXTURE_2D, pname, param));
-	GLCall(glBindTexture(GL_TEXTURE_2D, previouslyBoundTexture));
+	GLState::bindTexture(GL_TEXTURE_2D, previouslyBoundTexture);
 }
 
 void Texture::set2DTextureParameter(GLenum pname, GLfloat param) 
 {
-	GLuint previouslyBoundTexture = 0;
-	GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&previouslyBoundTexture));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_id));
+	unsigned int previouslyBoundTexture = GLState::getBoundTexture(GL_TEXTURE_2D);
+	GLState::bindTexture(GL_TEXTURE_2D, m_id);
 	GLCall(glTexParameterf(GL_TEXTURE_2D, pname, param));
-	GLCall(glBindTexture(GL_TEXTURE_2D, previouslyBoundTexture));
+	GLState::bindTexture(GL_TEXTURE_2D, previouslyBoundTexture);
 }
 
 void Texture::set2DTextureParameter(GLenum pname, GLfloat* param)
 {
-	GLuint previouslyBoundTexture = 0;
-	GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&previouslyBoundTexture));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_id));
+	unsigned int previouslyBoundTexture = GLState::getBoundTexture(GL_TEXTURE_2D);
+	GLState::bindTexture(GL_TEXTURE_2D, m_id);
 	GLCall(glTexParameterfv(GL_TEXTURE_2D, pname, param));
-	GLCall(glBindTexture(GL_TEXTURE_2D, previouslyBoundTexture));
+	GLState::bindTexture(GL_TEXTURE_2D, previouslyBoundTexture);
 }
 
 
@@ -80,6 +108,7 @@ void Texture::set2DTextureParameter(GLenum pname, GLfloat* param)
 
 void Texture::generate(const std::string& filepath, Format internalFormat)
 {
+	CPU_PROFILE_SCOPE("Texture::generate (file)");
 	m_filepath = filepath;
 	int width, height, nrChannels;
 	unsigned char* data = load_image(filepath.c_str(), &width, &height, &nrChannels, true);
@@ -102,6 +131,7 @@ void Texture::generate(int width, int height, int nrChannels, Format internalFor
 
 void Texture::generate(int width, int height, int nrChannels, Format internalFormat, GLenum dataFormat, const unsigned char* data)
 {
+	CPU_PROFILE_SCOPE("Texture::generate");
 	Format format;
 	if (nrChannels == 4)
 		format = Format::RGBA;
@@ -117,6 +147,10 @@ void Texture::generate(int width, int height, int nrChannels, Format internalFor
 	GLCall(glGenTextures(1, &m_id));
 	bind();
 	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat    , width  , height  , 0, format           , dataFormat, (void*)data));
+	if (data != nullptr)
+	{
+		RenderStats::countTextureUpload(imageBytes(width, height, format, dataFormat));
+	}
 
 	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
 	unbind();
@@ -159,6 +193,7 @@ void Material::passUniforms(Shader& shader) const
 void Texture::release()
 {
 	GLCall(glDeleteTextures(1, &m_id));
+	GLState::forgetTexture(m_id);
 }
 
 void Texture::swapData(Texture& other)
@@ -7,6 +7,7 @@
 
 
 #include "../utils/ErrorHandling.h"
+#include "../utils/GLState.h"
 #include "../utils/ImageLoader.h"
 #include "../Shader/Shader.h"
 
@@ -54,9 +55,9 @@ public:
 	~Texture();
 
 	//!< activates this texture.
-	void bind()   const { GLCall(glBindTexture(GL_TEXTURE_2D, m_id)); } 
+	void bind()   const { GLState::bindTexture(GL_TEXTURE_2D, m_id); }
 	//!< deactivates any texture.
-	void unbind() const { GLCall(glBindTexture(GL_TEXTURE_2D,    0)); } 
+	void unbind() const { GLState::bindTexture(GL_TEXTURE_2D,    0); }
 	
 	//!< retrieves ID of texture (used when passing a texture to a shader)
 	unsigned int getID() const { return m_id; } 
@@ -71,7 +72,7 @@ public:
 	//!< Set general opengl parameters for 2D textures
 	void set2DTextureParameter(GLenum pname, GLfloat* param);
 
-	static void setActiveTexture(GLenum texture) { GLCall(glActiveTexture(texture)); }
+	static void setActiveTexture(GLenum texture) { GLState::activeTexture(texture - GL_TEXTURE0); }
 
 private:
 	unsigned int m_id;
@@ -105,4 +106,9 @@ public:
 
 	//!< Passes to the shader all the needed texture IDs and shininess parameter.
 	void passUniforms(Shader& shader) const; 
+
+	const Texture* getDiffuse()   const { return m_diffuse; }
+	const Texture* getSpecular()  const { return m_specular; }
+	const Texture* getNormal()    const { return m_normal; }
+	float          getShininess() const { return m_shininess; }
 };
\ No newline at end of file
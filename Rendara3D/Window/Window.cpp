@@ -3,7 +3,8 @@
 
 Window::Window(std::string title, double width, double height) : Window{ title, width, height, Monitor::G_NOTSPECIFIED } {}
 
-Window::Window(std::string title, double width, double height, Monitor monitor)
+Window::Window(std::string title, double width, double height, Monitor monitor) :
+	m_fixedTimeStep(0.0), m_simulatedTime(0.0)
 {
 	m_lastTime = getCurrentTime();
 	m_lastFrameTime = 0.0f;
@@ -24,11 +25,22 @@ Window::Window(std::string title, double width, double height, Monitor monitor)
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);// GLFW_OPENGL_CORE_PROFILE); 
 
+#if GL_CHECK_LEVEL == GL_CHECK_DEBUG_OUTPUT
+	/* the drivers report the errors only in debug contexts */
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+
 	/* keep the size fixed */
 	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE); // TODO: make windows resizable
 
+	/* only the context is used, the rendering stays in the framebuffers */
+	if (monitor == Monitor::G_HIDDEN)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+	}
+
 	/* Create a windowed mode window and its OpenGL context */
-	if (monitor == Monitor::G_NOTSPECIFIED)
+	if (monitor == Monitor::G_NOTSPECIFIED || monitor == Monitor::G_HIDDEN)
 	{
 		m_window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
 	}
@@ -46,6 +58,10 @@ Window::Window(std::string title, double width, double height, Monitor monitor)
 
 	/* Make the window's current context */
 	glfwMakeContextCurrent(m_window);
+	if (monitor == Monitor::G_HIDDEN)
+	{
+		glfwSwapInterval(0); // nothing is shown: do not wait for the vertical sync
+	}
 
 	/* Once context is created, I can initialize GLEW*/
 	GLenum err = glewInit();
@@ -58,15 +74,18 @@ Window::Window(std::string title, double width, double height, Monitor monitor)
 	}
 
 
+	enableGLDebugOutput();
+
 	// configure global opengl state
 	// -----------------------------
-	GLCall(glEnable(GL_DEPTH_TEST));
+	GLState::invalidate(); // new context
+	GLState::enable(GL_DEPTH_TEST);
 	//ste//GLCall(glDepthFunc(GL_LESS));
 	//ste//GLCall(glEnable(GL_STENCIL_TEST));
 	//ste//GLCall(glStencilFunc(GL_NOTEQUAL, 1, 0xFF));
 	//ste//GLCall(glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE));
 
-	glEnable(GL_CULL_FACE);
+	GLState::enable(GL_CULL_FACE);
 	//glFrontFace(GL_CCW);
 
 	// disable this to have HDR, and in the hdr shader abilitate the calculations for the hdr
@@ -82,7 +101,7 @@ Window::Window(std::string title, double width, double height, Monitor monitor)
 
 void Window::setViewPort(float width, float height) const
 {
-	GLCall(glViewport(0, 0, width, height));
+	GLState::viewport(0, 0, (int)width, (int)height);
 }
 
 
@@ -104,6 +123,16 @@ void Window::swapBuffers() const
 	glfwSwapBuffers(m_window);
 }
 
+void Window::makeContextCurrent() const
+{
+	glfwMakeContextCurrent(m_window);
+}
+
+void Window::releaseContext()
+{
+	glfwMakeContextCurrent(nullptr);
+}
+
 void Window::pollEvents() const
 {
 	glfwPollEvents();
@@ -134,6 +163,10 @@ float Window::getLastFrameTime() const
 }
 float Window::getCurrentTime() const
 {
+	if (m_fixedTimeStep > 0.0)
+	{
+		return m_simulatedTime;
+	}
 	return glfwGetTime();
 }
 void  Window::updateTime()
@@ -142,5 +175,16 @@ void  Window::updateTime()
 }
 void Window::updateLastFrameTime()
 {
+	if (m_fixedTimeStep > 0.0)
+	{
+		m_simulatedTime += m_fixedTimeStep;
+	}
 	m_lastFrameTime = getCurrentTime() - m_lastTime;
 }
+void Window::setFixedTimeStep(double timeStep)
+{
+	m_fixedTimeStep = timeStep;
+	m_simulatedTime = 0.0;
+	m_lastTime = getCurrentTime();
+	m_lastFrameTime = (float)timeStep;
+}
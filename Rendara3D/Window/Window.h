@@ -3,6 +3,7 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "../utils/ErrorHandling.h"
+#include "../utils/GLState.h"
 
 #include <iostream>
 #include <exception>
@@ -16,7 +17,8 @@ enum Monitor
 {
 	G_PRIMARY = 0,
 	G_SECONDARY = 1,
-	G_NOTSPECIFIED = -1
+	G_NOTSPECIFIED = -1,
+	G_HIDDEN = -2        // no window on the screen: only offscreen rendering (benchmarks)
 };
 
 //! Class for the window on which things will be rendered.
@@ -35,6 +37,10 @@ private:
 	float m_lastTime;
 	float m_lastFrameTime;
 
+	// when positive, the clock advances by this much at each frame instead of following the real time
+	double m_fixedTimeStep;
+	double m_simulatedTime;
+
 	bool m_Keys[MAX_KEYS];
 	bool m_MouseButtons[MAX_BUTTONS];
 	double mx, my;
@@ -59,6 +65,10 @@ public:
 	//!< Set the "background color" of the currently binded buffer. Use numbers between 0 and 1 (not 0-255!).
 	void clearColorBufferBit(float red, float blue, float green, float alpha) const;
 	void swapBuffers() const;
+	//!< Makes the OpenGL context of the window current on the calling thread (it can be current on one thread at a time).
+	void makeContextCurrent() const;
+	//!< Detaches the current OpenGL context from the calling thread, so that another thread can make it current.
+	static void releaseContext();
 	void pollEvents() const;
 	void terminate() const;
 
@@ -80,4 +90,7 @@ public:
 	void  updateTime();
 	//!< Update the time it took to process this frame (in seconds). To be used at the end of each frame.
 	void  updateLastFrameTime();
+	//!< With a positive timeStep, every frame lasts timeStep seconds and the time starts again from zero, which makes
+	//!< runs reproducible. Zero goes back to the real time.
+	void  setFixedTimeStep(double timeStep);
 };
@@ -1,11 +1,17 @@
 #include "Buffer.h"
+#include "../Renderer/RenderStats.h"
 
-Buffer::Buffer(unsigned int type, const void* data, size_t size) : m_type(type)
+Buffer::Buffer(unsigned int type, const void* data, size_t size) : m_type(type), m_size(0)
 {
 	generate();
 	setData(data, size);
 }
 
+Buffer::Buffer(unsigned int type) : m_type(type), m_size(0)
+{
+	generate();
+}
+
 Buffer::~Buffer()
 {
 	release();
@@ -48,7 +54,7 @@ void Buffer::generate() {
 	GLCall(glGenBuffers(1, &m_id));
 }
 
-void Buffer::setData(const void* data, size_t size)
+void Buffer::setData(const void* data, size_t size, GLenum usage)
 {
 	// what was bound before?
 	//GLuint boundBuffer = 0;
@@ -56,18 +62,32 @@ void Buffer::setData(const void* data, size_t size)
 
 	// bind
 	bind();
-	GLCall(glBufferData(m_type, size, data, GL_STATIC_DRAW));
+	GLCall(glBufferData(m_type, size, data, usage));
+	m_size = size;
+	if (data != nullptr)
+	{
+		RenderStats::countBufferUpload(size);
+	}
 	
 	// bind what was bind before
 	//bind(boundBuffer); // <- this is a mistake: need to keep the buffer binded while constructing vao
 }
 
+void Buffer::setSubData(size_t offset, const void* data, size_t size)
+{
+	bind();
+	GLCall(glBufferSubData(m_type, offset, size, data));
+	RenderStats::countBufferUpload(size);
+}
+
 void Buffer::swapData(Buffer& other)
 {
 	m_id = other.m_id;
 	m_type = other.m_type;
+	m_size = other.m_size;
 
 	other.m_id = 0;
+	other.m_size = 0;
 	// other.m_type remains the same
 }
 
@@ -75,4 +95,5 @@ void Buffer::release()
 {
 	GLCall(glDeleteBuffers(1, &m_id));
 	m_id = 0;
+	m_size = 0;
 }
\ No newline at end of file
@@ -19,8 +19,11 @@ class Buffer
 private:
 	unsigned int m_id;
 	unsigned int m_type;
+	size_t       m_size;
 public:
-	Buffer() : m_id(0), m_type(GL_ARRAY_BUFFER) {}
+	Buffer() : m_id(0), m_type(GL_ARRAY_BUFFER), m_size(0) {}
+	//!< Generates an empty buffer of the given type: allocate it with setData.
+	explicit Buffer(unsigned int type);
 	Buffer(unsigned int type, const void* data, size_t size);
 	~Buffer();
 
@@ -35,11 +38,18 @@ public:
 	void bind()   const;
 	void unbind() const;
 
+	//!< (Re)allocates the storage of the buffer and fills it with data (which can be NULL). Leaves the buffer bound.
+	void setData(const void* data, size_t size, GLenum usage = GL_STATIC_DRAW);
+	//!< Overwrites size bytes starting at offset. The storage must have been allocated with setData. Leaves the buffer bound.
+	void setSubData(size_t offset, const void* data, size_t size);
+
+	unsigned int getID()   const { return m_id; }
+	size_t       getSize() const { return m_size; }
+
 private:
 	void bind(unsigned int id)   const;
 
 	void generate();
-	void setData(const void* data, size_t size);
 
 	void swapData(Buffer& other);
 	void release();
@@ -35,12 +35,12 @@ void FrameBuffer::generate()
 void FrameBuffer::bind(GLenum target)
 {
 	m_currentTarget = target;
-	GLCall(glBindFramebuffer(target, m_id));
+	GLState::bindFramebuffer(target, m_id);
 }
 
 void FrameBuffer::unbind()
 {
-	GLCall(glBindFramebuffer(m_currentTarget, 0));
+	GLState::bindFramebuffer(m_currentTarget, 0);
 }
 
 void FrameBuffer::attach2DTexture(GLenum attachment, Texture&& texture)
@@ -111,6 +111,7 @@ void FrameBuffer::release()
 
 	// release FrameBuffer
 	GLCall(glDeleteFramebuffers(1, &m_id));
+	GLState::forgetFramebuffer(m_id);
 	m_id = 0;
 }
 
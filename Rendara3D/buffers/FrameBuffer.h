@@ -6,6 +6,7 @@
 #include<GLFW/glfw3.h>
 
 #include "../utils/ErrorHandling.h"
+#include "../utils/GLState.h"
 #include "../Texture/Texture.h"
 
 //! Class for OpenGL Framebuffers
@@ -0,0 +1,136 @@
+#include "GeometryPool.h"
+
+/* stl */
+#include <algorithm>
+
+
+namespace {
+
+	//!< Buffer of size bytes, left uninitialized. Created for GL_COPY_WRITE_BUFFER, which no vao records.
+	Buffer makeStorage(size_t size)
+	{
+		Buffer buffer{ GL_COPY_WRITE_BUFFER };
+		buffer.setData(nullptr, size, GL_STATIC_DRAW);
+		buffer.unbind();
+		return buffer;
+	}
+
+	void copyBuffer(const Buffer& source, size_t sourceOffset, const Buffer& destination, size_t destinationOffset, size_t size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, source.getID()));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, destination.getID()));
+		GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, size));
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	}
+
+}
+
+
+GeometryPool::GeometryPool(size_t vertexBytes, size_t indexBytes) : m_vertexBytes(vertexBytes), m_indexBytes(indexBytes)
+{
+}
+
+bool GeometryPool::isMultiDrawSupported()
+{
+	return GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+}
+
+void GeometryPool::add(const Model& model)
+{
+	const std::vector<Mesh>* meshes = model.getMeshes();
+	for (size_t i = 0; i < meshes->size(); i++)
+	{
+		add(meshes->at(i));
+	}
+}
+
+const GeometryRange* GeometryPool::add(const Mesh& mesh)
+{
+	auto it = m_ranges.find(&mesh);
+	if (it != m_ranges.end())
+	{
+		return &it->second;
+	}
+
+	const VertexArray& source = mesh.getVertexArray();
+	if (source.getComponents().empty())
+	{
+		return nullptr;
+	}
+
+	unsigned int formatIndex = getFormat(source.getComponents());
+	Format& format = m_formats.at(formatIndex);
+	size_t stride = source.getStride();
+	size_t vertices = source.getNumVertices();
+	size_t indices = mesh.getIndices();
+	reserve(format, vertices, indices);
+
+	// the indices stay relative to the first vertex of the mesh: the draws add baseVertex to them
+	copyBuffer(source.getVertexBuffer(), 0, format.vao.getVertexBuffer(), format.numVertices * stride, vertices * stride);
+	copyBuffer(source.getIndexBuffer(), 0, format.vao.getIndexBuffer(), format.numIndices * sizeof(unsigned int), indices * sizeof(unsigned int));
+
+	GeometryRange range{ formatIndex, (unsigned int)format.numIndices, (unsigned int)indices, (int)format.numVertices };
+	format.numVertices += vertices;
+	format.numIndices += indices;
+	return &m_ranges.insert({ &mesh, range }).first->second;
+}
+
+const GeometryRange* GeometryPool::find(const Mesh* mesh) const
+{
+	auto it = m_ranges.find(mesh);
+	return (it == m_ranges.end()) ? nullptr : &it->second;
+}
+
+void GeometryPool::clear()
+{
+	m_ranges.clear();
+	m_formats.clear();
+}
+
+unsigned int GeometryPool::getFormat(const std::vector<unsigned int>& components)
+{
+	for (size_t f = 0; f < m_formats.size(); f++)
+	{
+		if (m_formats.at(f).vao.getComponents() == components)
+		{
+			return (unsigned int)f;
+		}
+	}
+	m_formats.push_back(Format{ VertexArray{ makeStorage(m_vertexBytes), makeStorage(m_indexBytes), components }, 0, 0 });
+	return (unsigned int)(m_formats.size() - 1);
+}
+
+void GeometryPool::reserve(Format& format, size_t vertices, size_t indices)
+{
+	size_t stride = format.vao.getStride();
+	size_t vertexBytes = (format.numVertices + vertices) * stride;
+	size_t indexBytes = (format.numIndices + indices) * sizeof(unsigned int);
+	size_t vertexCapacity = format.vao.getVertexBuffer().getSize();
+	size_t indexCapacity = format.vao.getIndexBuffer().getSize();
+	if (vertexBytes <= vertexCapacity && indexBytes <= indexCapacity)
+	{
+		return;
+	}
+
+	while (vertexCapacity < vertexBytes)
+	{
+		vertexCapacity = std::max<size_t>(2 * vertexCapacity, stride);
+	}
+	while (indexCapacity < indexBytes)
+	{
+		indexCapacity = std::max<size_t>(2 * indexCapacity, sizeof(unsigned int));
+	}
+
+	// new buffers with what is already there, and a new vao reading them
+	Buffer vbo = makeStorage(vertexCapacity);
+	Buffer ibo = makeStorage(indexCapacity);
+	copyBuffer(format.vao.getVertexBuffer(), 0, vbo, 0, format.numVertices * stride);
+	copyBuffer(format.vao.getIndexBuffer(), 0, ibo, 0, format.numIndices * sizeof(unsigned int));
+	std::vector<unsigned int> components = format.vao.getComponents();
+	format.vao = VertexArray{ std::move(vbo), std::move(ibo), components };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "VertexArray.h"
+#include "../Model/Model.h"
+
+
+//! Arguments of one draw of glMultiDrawElementsIndirect, as read by OpenGL from the indirect buffer.
+struct DrawElementsIndirectCommand
+{
+	GLuint count;          //!< indices of the mesh
+	GLuint instanceCount;
+	GLuint firstIndex;     //!< of the mesh in the index buffer of its format
+	GLint  baseVertex;     //!< added to the indices of the mesh
+	GLuint baseInstance;   //!< first instance read from the per-instance attributes
+};
+
+//! Where the vertices and indices of a mesh are in a GeometryPool.
+struct GeometryRange
+{
+	unsigned int format;      //!< index of the vertex format (see GeometryPool::bindFormat)
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	int          baseVertex;
+};
+
+
+//! Vertices and indices of many meshes, sub-allocated in a few large buffers: one vertex and one index buffer per vertex format.
+/*!
+	Meshes with the same attributes (e.g. the position, normal, texture coordinates and tangent of the meshes of a
+	Model) share the buffers and the vao of their format, so that they can all be drawn by one
+	glMultiDrawElementsIndirect call with a DrawElementsIndirectCommand each (see Simple3DRenderer::setGeometryPool).
+	add copies the data of a mesh from its own buffers with glCopyBufferSubData: the mesh keeps them, and can still be
+	drawn on its own. The buffers of a format grow (twice as large) when they are full, which also replaces its vao.
+	Meshes are never removed one by one: the pool is meant to live as long as the models it holds, as the meshes are
+	found by address.
+*/
+class GeometryPool
+{
+public:
+	static const size_t DEFAULT_VERTEX_BYTES = 4 << 20;  // of each format, before it grows
+	static const size_t DEFAULT_INDEX_BYTES  = 1 << 20;
+
+	explicit GeometryPool(size_t vertexBytes = DEFAULT_VERTEX_BYTES, size_t indexBytes = DEFAULT_INDEX_BYTES);
+
+	GeometryPool(const GeometryPool&) = delete;
+	GeometryPool& operator=(const GeometryPool&) = delete;
+
+	//!< Adds all the meshes of the model.
+	void add(const Model& model);
+	//!< Copies the vertices and indices of the mesh in the buffers of its format, unless already done. nullptr for a mesh never filled.
+	const GeometryRange* add(const Mesh& mesh);
+	//!< Where the mesh is, or nullptr if it was not added.
+	const GeometryRange* find(const Mesh* mesh) const;
+	//!< Forgets all the meshes and releases the buffers.
+	void clear();
+
+	//!< Binds the vao of the format, which reads all the meshes of that format.
+	void bindFormat(unsigned int format) const { m_formats.at(format).vao.bind(); }
+	//!< See VertexArray::setInstanceAttributes. The vao of the format must be bound.
+	void setInstanceAttributes(unsigned int format, const Buffer& buffer, size_t offset, const InstanceLayout& layout) const
+	{
+		m_formats.at(format).vao.setInstanceAttributes(buffer, offset, layout);
+	}
+
+	size_t getNumFormats() const { return m_formats.size(); }
+	size_t getNumMeshes() const  { return m_ranges.size(); }
+
+	//!< True if the context has glMultiDrawElementsIndirect with base instances (OpenGL 4.3, or the ARB extensions).
+	static bool isMultiDrawSupported();
+
+private:
+	struct Format
+	{
+		VertexArray vao;          // owns the vertex and index buffers
+		size_t      numVertices;  // used in the vertex buffer
+		size_t      numIndices;   // used in the index buffer
+	};
+
+	std::vector<Format>                            m_formats;
+	std::unordered_map<const Mesh*, GeometryRange> m_ranges;
+	size_t                                         m_vertexBytes;
+	size_t                                         m_indexBytes;
+
+	unsigned int getFormat(const std::vector<unsigned int>& components);
+	//!< Grows the buffers of the format until they have room for the given vertices and indices.
+	void reserve(Format& format, size_t vertices, size_t indices);
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+//! One per-instance vertex attribute: a vector of floats read at the given offset inside each instance.
+struct InstanceAttribute
+{
+	unsigned int location;   //!< attribute location in the shader
+	unsigned int components; //!< number of floats (1 to 4)
+	size_t       offset;     //!< in bytes, from the start of the instance
+};
+
+//! Describes how the data of one instance is laid out in an instance buffer (attribute divisor 1).
+/*!
+	A mat4 occupies four consecutive locations, one for each column.
+*/
+struct InstanceLayout
+{
+	size_t                         stride; //!< size of one instance, in bytes
+	std::vector<InstanceAttribute> attributes;
+
+	//!< Appends the four columns of a mat4 starting at the given location and offset.
+	void addMat4(unsigned int location, size_t offset)
+	{
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			attributes.push_back({ location + column, 4, offset + column * 4 * sizeof(float) });
+		}
+	}
+};
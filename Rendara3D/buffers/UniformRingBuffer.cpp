@@ -0,0 +1,100 @@
+#include "UniformRingBuffer.h"
+
+
+UniformRingBuffer::UniformRingBuffer(size_t frameSize, unsigned int numFrames) :
+	m_buffer(GL_UNIFORM_BUFFER), m_numRegions(numFrames), m_current(0), m_started(false),
+	m_fences(numFrames, nullptr), m_mapped(nullptr)
+{
+	GLint alignment = 0;
+	GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+	m_alignment = (alignment > 0) ? (size_t)alignment : 256;
+
+	// the start of each region is the offset of its first block
+	m_regionSize = align(frameSize);
+	m_buffer.setData(nullptr, m_regionSize * m_numRegions, GL_STREAM_DRAW);
+	m_buffer.unbind();
+}
+
+UniformRingBuffer::~UniformRingBuffer()
+{
+	release();
+}
+
+UniformRingBuffer::UniformRingBuffer(UniformRingBuffer&& other) : m_fences()
+{
+	swapData(other);
+}
+
+UniformRingBuffer& UniformRingBuffer::operator=(UniformRingBuffer&& other)
+{
+	if (this != &other)
+	{
+		release();
+		swapData(other);
+	}
+	return *this;
+}
+
+char* UniformRingBuffer::beginFrame()
+{
+	if (m_started)
+	{
+		// everything issued so far (the draws of the previous frame) reads the current region
+		m_fences[m_current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_current = (m_current + 1) % m_numRegions;
+	}
+	m_started = true;
+
+	if (m_fences[m_current] != nullptr)
+	{
+		GLCall(glClientWaitSync(m_fences[m_current], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+		GLCall(glDeleteSync(m_fences[m_current]));
+		m_fences[m_current] = nullptr;
+	}
+
+	m_buffer.bind();
+	GLCall(m_mapped = (char*)glMapBufferRange(GL_UNIFORM_BUFFER, m_current * m_regionSize, m_regionSize,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	return m_mapped;
+}
+
+void UniformRingBuffer::endFrame()
+{
+	m_buffer.bind();
+	GLCall(glUnmapBuffer(GL_UNIFORM_BUFFER));
+	m_buffer.unbind();
+	m_mapped = nullptr;
+}
+
+void UniformRingBuffer::bindRange(unsigned int bindingPoint, size_t offset, size_t size) const
+{
+	GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_buffer.getID(), m_current * m_regionSize + offset, size));
+}
+
+void UniformRingBuffer::swapData(UniformRingBuffer& other)
+{
+	m_buffer = std::move(other.m_buffer);
+	m_alignment = other.m_alignment;
+	m_regionSize = other.m_regionSize;
+	m_numRegions = other.m_numRegions;
+	m_current = other.m_current;
+	m_started = other.m_started;
+	m_fences.swap(other.m_fences);
+	m_mapped = other.m_mapped;
+
+	other.m_fences.clear();
+	other.m_started = false;
+	other.m_mapped = nullptr;
+}
+
+void UniformRingBuffer::release()
+{
+	for (size_t i = 0; i < m_fences.size(); i++)
+	{
+		if (m_fences[i] != nullptr)
+		{
+			GLCall(glDeleteSync(m_fences[i]));
+		}
+	}
+	m_fences.clear();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+/* stl */
+#include <vector>
+
+#include "../utils/ErrorHandling.h"
+#include "Buffer.h"
+
+
+//! Uniform buffer split in regions written by the CPU in turn, one region per frame.
+/*!
+	beginFrame moves to the next region and maps it unsynchronized: the driver does not stall, and the GPU
+	may still read the regions of the previous frames. Each region gets a fence when the next frame begins,
+	and writing a region again first waits on its fence, so with numFrames regions the CPU can run up to
+	numFrames - 1 frames ahead of the GPU.
+	The blocks written in a region are bound with bindRange; their offsets must be rounded with align.
+*/
+class UniformRingBuffer
+{
+private:
+	Buffer              m_buffer;
+	size_t              m_alignment;   // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+	size_t              m_regionSize;
+	unsigned int        m_numRegions;
+	unsigned int        m_current;
+	bool                m_started;
+	std::vector<GLsync> m_fences;
+	char*               m_mapped;
+
+public:
+	//!< frameSize is the number of bytes written each frame.
+	UniformRingBuffer(size_t frameSize, unsigned int numFrames = 3);
+	~UniformRingBuffer();
+
+	//Cannot use the copy constructor/assignment.
+	UniformRingBuffer(const UniformRingBuffer&) = delete;
+	UniformRingBuffer& operator=(const UniformRingBuffer&) = delete;
+
+	//Can use move constructor/assignment.
+	UniformRingBuffer(UniformRingBuffer&& other);
+	UniformRingBuffer& operator=(UniformRingBuffer&& other);
+
+	//!< Maps the next region and returns its start.
+	char* beginFrame();
+	//!< Unmaps the region. The ranges must be bound after this.
+	void endFrame();
+
+	//!< Binds size bytes at offset in the current region to the uniform binding point.
+	void bindRange(unsigned int bindingPoint, size_t offset, size_t size) const;
+
+	//!< offset rounded up to the alignment of the bound ranges.
+	size_t align(size_t offset) const { return (offset + m_alignment - 1) / m_alignment * m_alignment; }
+
+private:
+	void swapData(UniformRingBuffer& other);
+	void release();
+};
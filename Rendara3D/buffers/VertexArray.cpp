@@ -2,6 +2,7 @@
 
 
 VertexArray::VertexArray(const std::vector<std::vector<float> >& attributes, const std::vector<unsigned int>& components, const std::vector<unsigned int>& indices)
+	: m_instanceBuffer(0), m_instanceOffset(0), m_instanceLayout(nullptr)
 {
 	generate();
 	bind();
@@ -10,6 +11,20 @@ VertexArray::VertexArray(const std::vector<std::vector<float> >& attributes, con
 	unbind();
 }
 
+VertexArray::VertexArray(Buffer&& vbo, Buffer&& ibo, const std::vector<unsigned int>& components)
+	: m_vbo(std::move(vbo)), m_ibo(std::move(ibo)), m_components(components), m_instanceBuffer(0), m_instanceOffset(0), m_instanceLayout(nullptr)
+{
+	generate();
+	bind();
+	// the buffers may have been created for another target: bound by hand to the ones the vao records
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_vbo.getID()));
+	setAttributePointers();
+	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo.getID()));
+	unbind();
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0)); // Note: after unbinding the vao.
+}
+
 VertexArray::~VertexArray()
 {
 	release();
@@ -50,32 +65,54 @@ void VertexArray::fillData(const std::vector<std::vector<float>>& attributes, co
 		}
 	}
 
+	/* put data in the GPU */
+	Buffer vbo{ GL_ARRAY_BUFFER, &data[0], sizeof(float) * data.size() };
+	m_vbo = std::move(vbo);
+	m_components = components;
+
+	setAttributePointers();
+
+	m_vbo.unbind(); // TODO: necessary?
+	unbind();
+}
+
+void VertexArray::setAttributePointers()
+{
 	/* number of floats for each vertex */
 	int stride = 0;
-	for (size_t i = 0; i < components.size(); i++)
+	for (size_t i = 0; i < m_components.size(); i++)
 	{
-		stride += components.at(i);
+		stride += m_components.at(i);
 	}
 
-	/* put data in the GPU */
-	Buffer vbo{ GL_ARRAY_BUFFER, &data[0], sizeof(float) * data.size() };
-	m_vbo = std::move(vbo);
-
-	for (size_t i = 0; i < attributes.size(); i++)
+	for (size_t i = 0; i < m_components.size(); i++)
 	{
 		// compute the stride for this attribute
 		int offset = 0;
 		for (size_t j = 0; j < i; j++)
 		{
-			offset += components.at(j);
+			offset += m_components.at(j);
 		}
 
 		GLCall(glEnableVertexAttribArray(i));
-		GLCall(glVertexAttribPointer(i, components.at(i), GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(offset * sizeof(float))));
+		GLCall(glVertexAttribPointer(i, m_components.at(i), GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(offset * sizeof(float))));
 	}
+}
 
-	m_vbo.unbind(); // TODO: necessary?
-	unbind();
+size_t VertexArray::getStride() const
+{
+	size_t floats = 0;
+	for (size_t i = 0; i < m_components.size(); i++)
+	{
+		floats += m_components.at(i);
+	}
+	return floats * sizeof(float);
+}
+
+size_t VertexArray::getNumVertices() const
+{
+	size_t stride = getStride();
+	return (stride == 0) ? 0 : m_vbo.getSize() / stride;
 }
 
 void VertexArray::setIbo(const std::vector<unsigned int>& indices)
@@ -91,15 +128,63 @@ void VertexArray::setIbo(const std::vector<unsigned int>& indices)
 }
 
 
+void VertexArray::setInstanceAttributes(const Buffer& buffer, size_t offset, const InstanceLayout& layout) const
+{
+	if (m_instanceBuffer == buffer.getID() && m_instanceOffset == offset && m_instanceLayout == &layout)
+	{
+		return;
+	}
+
+	// disable the attributes of the previous layout that the new one does not use
+	if (m_instanceLayout != nullptr && m_instanceLayout != &layout)
+	{
+		for (size_t i = 0; i < m_instanceLayout->attributes.size(); i++)
+		{
+			unsigned int location = m_instanceLayout->attributes.at(i).location;
+			bool used = false;
+			for (size_t j = 0; j < layout.attributes.size(); j++)
+			{
+				used = used || (layout.attributes.at(j).location == location);
+			}
+			if (!used)
+			{
+				GLCall(glDisableVertexAttribArray(location));
+			}
+		}
+	}
+
+	// the attribute pointers capture the buffer bound to GL_ARRAY_BUFFER
+	buffer.bind();
+	for (size_t i = 0; i < layout.attributes.size(); i++)
+	{
+		const InstanceAttribute& attribute = layout.attributes.at(i);
+		GLCall(glEnableVertexAttribArray(attribute.location));
+		GLCall(glVertexAttribPointer(attribute.location, attribute.components, GL_FLOAT, GL_FALSE, layout.stride, (void*)(offset + attribute.offset)));
+		GLCall(glVertexAttribDivisor(attribute.location, 1));
+	}
+
+	m_instanceBuffer = buffer.getID();
+	m_instanceOffset = offset;
+	m_instanceLayout = &layout;
+}
+
 void VertexArray::swapData(VertexArray& other)
 {
 	m_id = other.m_id;
 	other.m_id = 0;
+	m_instanceBuffer = other.m_instanceBuffer;
+	m_instanceOffset = other.m_instanceOffset;
+	m_instanceLayout = other.m_instanceLayout;
+	other.m_instanceBuffer = 0;
+	other.m_instanceOffset = 0;
+	other.m_instanceLayout = nullptr;
 	m_ibo = std::move(other.m_ibo);
 	m_vbo = std::move(other.m_vbo);
+	m_components.swap(other.m_components);
 }
 
 void VertexArray::release()
 {
 	GLCall(glDeleteVertexArrays(1, &m_id));
+	GLState::forgetVertexArray(m_id);
 }
\ No newline at end of file
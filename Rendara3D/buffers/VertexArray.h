@@ -5,6 +5,8 @@
 #include <assert.h>
 #include <vector>
 #include "Buffer.h"
+#include "InstanceLayout.h"
+#include "../utils/GLState.h"
 
 
 //!< Encapsulate the OpenGL Vertex Array Object (VAO).
@@ -20,10 +22,18 @@ private:
 	Buffer m_vbo;
 	Buffer m_ibo;
 	unsigned int m_id;
+	std::vector<unsigned int> m_components; // floats of each attribute, interleaved in m_vbo
+
+	// per-instance attributes currently recorded in the vao (see setInstanceAttributes)
+	mutable unsigned int          m_instanceBuffer;
+	mutable size_t                m_instanceOffset;
+	mutable const InstanceLayout* m_instanceLayout;
 
 public:
-	VertexArray() : m_vbo{}, m_ibo{}, m_id(0) {}
+	VertexArray() : m_vbo{}, m_ibo{}, m_id(0), m_instanceBuffer(0), m_instanceOffset(0), m_instanceLayout(nullptr) {}
 	VertexArray(const std::vector<std::vector<float> >& attributes, const std::vector<unsigned int>& components, const std::vector<unsigned int>& indices);
+	//!< Takes the buffers, already filled with interleaved vertices of the given components and with the indices (see GeometryPool).
+	VertexArray(Buffer&& vbo, Buffer&& ibo, const std::vector<unsigned int>& components);
 
 	~VertexArray();
 
@@ -36,12 +46,25 @@ public:
 	VertexArray& operator=(VertexArray&& other);
 
 
-	void bind()   const { GLCall(glBindVertexArray(m_id)); }
-	void unbind() const { GLCall(glBindVertexArray(0)); }
+	void bind()   const { GLState::bindVertexArray(m_id); }
+	void unbind() const { GLState::bindVertexArray(0); }
+
+	//!< Points the per-instance attributes of the layout to the buffer, starting at offset (in bytes). The vao must be bound.
+	//!< The vao remembers its instance source: calling again with the same buffer, offset and layout does not touch OpenGL.
+	void setInstanceAttributes(const Buffer& buffer, size_t offset, const InstanceLayout& layout) const;
+
+	const Buffer& getVertexBuffer() const { return m_vbo; }
+	const Buffer& getIndexBuffer()  const { return m_ibo; }
+	const std::vector<unsigned int>& getComponents() const { return m_components; }
+	//!< Size of one vertex in the vertex buffer, in bytes.
+	size_t getStride() const;
+	size_t getNumVertices() const;
 
 private:
 	void generate() { GLCall(glGenVertexArrays(1, &m_id)); }
 	void fillData(const std::vector<std::vector<float> >& attributes, const std::vector<unsigned int>& components);
+	//!< Points the attributes to m_vbo, which must be bound with the vao.
+	void setAttributePointers();
 	void setIbo(const std::vector<unsigned int>& indices);
 	
 	void swapData(VertexArray& other);
@@ -1,13 +1,16 @@
 #include "PointLight.h"
+#include "../utils/FrameArena.h"
 
 
 void PointLight::cast(const std::string& uniformName, Shader& shader)
 {
-	shader.setUniformValue(uniformName+".ambient", ambientColor);
-	shader.setUniformValue(uniformName+".diffuse", diffuseColor);
-	shader.setUniformValue(uniformName+".specular",specularColor);
-	shader.setUniformValue(uniformName+".position", eye);
-	shader.setUniformValue(uniformName+".constant", attenuation.constant);
-	shader.setUniformValue(uniformName+".linear", attenuation.linear);
-	shader.setUniformValue(uniformName+".quadratic", attenuation.quadratic);
+	// the names of the fields are built in the frame arena, not on the heap
+	memory::FrameArena& arena = memory::FrameArena::shared();
+	shader.setUniformValue(shader.getUniformHandle(arena.concat(uniformName, ".ambient")), ambientColor);
+	shader.setUniformValue(shader.getUniformHandle(arena.concat(uniformName, ".diffuse")), diffuseColor);
+	shader.setUniformValue(shader.getUniformHandle(arena.concat(uniformName, ".specular")), specularColor);
+	shader.setUniformValue(shader.getUniformHandle(arena.concat(uniformName, ".position")), eye);
+	shader.setUniformValue(shader.getUniformHandle(arena.concat(uniformName, ".constant")), attenuation.constant);
+	shader.setUniformValue(shader.getUniformHandle(arena.concat(uniformName, ".linear")), attenuation.linear);
+	shader.setUniformValue(shader.getUniformHandle(arena.concat(uniformName, ".quadratic")), attenuation.quadratic);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ShadowCubeMap.h"
+#include "../utils/GpuProfiler.h"
 
 
 ShadowCubeMap::~ShadowCubeMap()
@@ -26,7 +27,7 @@ ShadowCubeMap::ShadowCubeMap(float width, float height) : m_width(width), m_heig
 	// TODO: add cube maps to the engine
 	// create 3D texture
 	GLCall(glGenTextures(1, &m_3DtextureID));
-	GLCall(glBindTexture(GL_TEXTURE_CUBE_MAP, m_3DtextureID));
+	GLState::bindTexture(GL_TEXTURE_CUBE_MAP, m_3DtextureID);
 	for (size_t i = 0; i < 6; i++)
 	{
 		GLCall(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT,
@@ -55,6 +56,7 @@ void ShadowCubeMap::clearShadows()
 
 void ShadowCubeMap::startShadows(const Window& window, Shader& cubeDepthShader, const PointLight& pointLight)
 {
+	GpuProfiler::shared().beginScope("point shadow");
 	window.setViewPort(m_width, m_height);
 	m_frameBuffer.bind();
 	float aspect = (float)m_width / (float)m_height;
@@ -64,33 +66,36 @@ void ShadowCubeMap::startShadows(const Window& window, Shader& cubeDepthShader,
 	float near = 0.1f;
 	float far = 20.0f;
 	glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), aspect, near, far);
-	std::vector<glm::mat4> shadowTransforms;
-	shadowTransforms.push_back(shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-	shadowTransforms.push_back(shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-	shadowTransforms.push_back(shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
-	shadowTransforms.push_back(shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
-	shadowTransforms.push_back(shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-	shadowTransforms.push_back(shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
+	glm::mat4 shadowTransforms[6] = {
+		shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
+		shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
+		shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+		shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)),
+		shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
+		shadowProj * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))
+	};
+	static const char* const shadowMatricesNames[6] = {
+		"shadowMatrices[0]", "shadowMatrices[1]", "shadowMatrices[2]", "shadowMatrices[3]", "shadowMatrices[4]", "shadowMatrices[5]"
+	};
 
 	cubeDepthShader.bind();
-	cubeDepthShader.setUniformMatrix("shadowMatrices[0]", shadowTransforms.at(0), false);
-	cubeDepthShader.setUniformMatrix("shadowMatrices[1]", shadowTransforms.at(1), false);
-	cubeDepthShader.setUniformMatrix("shadowMatrices[2]", shadowTransforms.at(2), false);
-	cubeDepthShader.setUniformMatrix("shadowMatrices[3]", shadowTransforms.at(3), false);
-	cubeDepthShader.setUniformMatrix("shadowMatrices[4]", shadowTransforms.at(4), false);
-	cubeDepthShader.setUniformMatrix("shadowMatrices[5]", shadowTransforms.at(5), false);
+	for (size_t face = 0; face < 6; face++)
+	{
+		cubeDepthShader.setUniformMatrix(shadowMatricesNames[face], shadowTransforms[face], false);
+	}
 
 	cubeDepthShader.setUniformValue("lightPos", lightPosition);
 	cubeDepthShader.setUniformValue("far_plane", far);
-	glDisable(GL_CULL_FACE);
+	GLState::disable(GL_CULL_FACE);
 }
 
 void ShadowCubeMap::stopShadows(const Window& window, Shader& shader)
 {
-	glEnable(GL_CULL_FACE);
+	GLState::enable(GL_CULL_FACE);
 	shader.unbind();
 	m_frameBuffer.unbind();
 	window.setViewPort(window.getWidth(), window.getHeight());
+	GpuProfiler::shared().endScope();
 }
 
 // Passes the farPlane and activates the cube texture
@@ -107,6 +112,7 @@ void ShadowCubeMap::passUniforms(Shader& shader, const std::string& textureUnifo
 void ShadowCubeMap::release()
 {
 	GLCall(glDeleteTextures(1, &m_3DtextureID));
+	GLState::forgetTexture(m_3DtextureID);
 }
 
 void ShadowCubeMap::swapData(ShadowCubeMap& other)
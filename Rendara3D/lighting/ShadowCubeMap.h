@@ -46,6 +46,8 @@ public:
 
 	inline float getWidth() const { return m_width; }
 	inline float getHeight() const { return m_height; }
+	//!< The depth cube map (e.g. to import it in a FrameGraph).
+	inline unsigned int getTextureID() const { return m_3DtextureID; }
 
 private:
 	int m_width;
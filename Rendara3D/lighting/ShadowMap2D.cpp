@@ -1,4 +1,6 @@
 #include "ShadowMap2D.h"
+#include "../Renderer/RenderStats.h"
+#include "../utils/GpuProfiler.h"
 
 
 
@@ -39,19 +41,21 @@ void ShadowMap2D::clearShadows()
 
 void ShadowMap2D::startShadows(const Window& window, Shader& shadowShader, const SunLight* sun)
 {
+	GpuProfiler::shared().beginScope("sun shadow");
 	window.setViewPort(m_width, m_height);
 	m_frameBuffer.bind();
 	shadowShader.bind();
 	shadowShader.setUniformMatrix("lightSpaceMatrix", m_frustrum * sun->getViewMatrix(), false);
-	GLCall(glDisable(GL_CULL_FACE));
+	GLState::disable(GL_CULL_FACE);
 }
 
 void ShadowMap2D::stopShadows(const Window& window, Shader& shadowShader)
 {
 	shadowShader.unbind();
-	GLCall(glEnable(GL_CULL_FACE));
+	GLState::enable(GL_CULL_FACE);
 	m_frameBuffer.unbind();
 	window.setViewPort(window.getWidth(), window.getHeight());
+	GpuProfiler::shared().endScope();
 }
 
 void ShadowMap2D::passUniforms(Shader& shader,
@@ -63,16 +67,20 @@ void ShadowMap2D::passUniforms(Shader& shader,
 	shader.setTexture(GL_TEXTURE_2D, textureUniformName, m_frameBuffer.getAttachedTextureID(0));
 }
 
+void ShadowMap2D::passUniforms(Shader& shader, const std::string& textureUniformName)
+{
+	shader.setTexture(GL_TEXTURE_2D, textureUniformName, m_frameBuffer.getAttachedTextureID(0));
+}
+
 void ShadowMap2D::drawShadowMap(Window& window, float width, float height, Shader& debugShader)
 {
 	window.setViewPort(width, height);
 	// render Depth map to quad for visual debugging
 	debugShader.bind();
 	debugShader.setUniformValue("depthMap", 0);
-	glActiveTexture(GL_TEXTURE0 + 0);
-	glBindTexture(GL_TEXTURE_2D, m_frameBuffer.getAttachedTextureID(0));
+	GLState::bindTextureUnit(0, GL_TEXTURE_2D, m_frameBuffer.getAttachedTextureID(0));
 	renderQuad();
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTextureUnit(0, GL_TEXTURE_2D, 0);
 	debugShader.unbind();
 	window.setViewPort(window.getWidth(), window.getHeight());
 }
@@ -94,15 +102,17 @@ void ShadowMap2D::renderQuad()
 		// setup plane VAO
 		glGenVertexArrays(1, &quadVAO);
 		glGenBuffers(1, &quadVBO);
-		glBindVertexArray(quadVAO);
+		GLState::bindVertexArray(quadVAO);
 		glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+		RenderStats::countBufferUpload(sizeof(quadVertices));
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 	}
-	glBindVertexArray(quadVAO);
+	GLState::bindVertexArray(quadVAO);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	glBindVertexArray(0);
+	RenderStats::countDraw(2);
+	GLState::bindVertexArray(0);
 }
\ No newline at end of file
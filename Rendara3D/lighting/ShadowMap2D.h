@@ -48,11 +48,19 @@ public:
 		const std::string& lightSpaceMatrixUniformName,
 		const glm::mat4& lightViewMatrix);
 
+	//!< Binds the shadow map to the sampler textureUniformName. The light space matrix goes through FrameUniforms::setSun.
+	void passUniforms(Shader& shader, const std::string& textureUniformName);
+
+	//!< Matrix from world to the clip space of the shadow map, for the given view matrix of the light.
+	glm::mat4 getLightSpaceMatrix(const glm::mat4& lightViewMatrix) const { return m_frustrum * lightViewMatrix; }
+
 	//!< Used for debugging. Draws the texture generated for computing the shadows, on the screen as a quad.
 	void drawShadowMap(Window& window, float width, float height, Shader& debugShader);
 
 	inline float getWidth() const { return m_width; }
 	inline float getHeight() const { return m_height; }
+	//!< The depth texture (e.g. to import it in a FrameGraph).
+	inline unsigned int getTextureID() const { return m_frameBuffer.getAttachedTextureID(0); }
 
 private:
 	//!< Used for debugging. Draws a quad on the screen that will be filled with the shadow map.
@@ -2,9 +2,56 @@
 #include "./Demos/OutBreak/OutBreak.h"
 #include "./Demos/Shadows/ShadowsDemoGame.h"
 #include "./Demos/Instancing/demo_instancing.h"
+#include "./Demos/Benchmarks/benchmark_matrices.h"
+#include "./Demos/Benchmarks/benchmark_scenes.h"
+#include "./utils/CpuProfiler.h"
+#include "./utils/AllocationTracker.h"
 
-int main() 
+int main(int argc, char* argv[])
 {	
+	// Rendara3D --trace file.json [...]: records the CPU scopes and writes them as a Chrome trace at exit
+	if (argc > 2 && std::string(argv[1]) == "--trace")
+	{
+		CpuProfiler::setEnabled(true);
+		CpuProfiler::exportAtExit(argv[2]);
+		// the other arguments are read as if --trace was not there
+		argv[2] = argv[0];
+		argc -= 2;
+		argv += 2;
+	}
+
+	// Rendara3D [--trace file.json] --allocations [...]: counts the heap allocations and their call sites
+	// (F3 prints them in the demos, the benchmark adds them to its results)
+	if (argc > 1 && std::string(argv[1]) == "--allocations")
+	{
+		AllocationTracker::setEnabled(true);
+		AllocationTracker::setCaptureCallSites(true);
+		argv[1] = argv[0];
+		argc -= 1;
+		argv += 1;
+	}
+
+	// Rendara3D [...] --render-thread: the demos that support it draw on a render thread (see Game::setRenderThread)
+	bool renderThread = false;
+	if (argc > 1 && std::string(argv[1]) == "--render-thread")
+	{
+		renderThread = true;
+		argv[1] = argv[0];
+		argc -= 1;
+		argv += 1;
+	}
+
+	// non-interactive run: Rendara3D --benchmark [options] (see parseSceneBenchmarkOptions)
+	if (argc > 1 && std::string(argv[1]) == "--benchmark")
+	{
+		SceneBenchmarkOptions options;
+		if (!parseSceneBenchmarkOptions(argc, argv, options))
+		{
+			return 1;
+		}
+		return benchmark_scenes(options);
+	}
+
 	std::cout << "########## Rendara3D ##########" << std::endl;
 	std::cout << "Welcome to the demo of Rendara3D." << std::endl;
 
@@ -12,18 +59,21 @@ int main()
 	std::cout << "\t 1: Shadows" << std::endl;
 	std::cout << "\t 2: Instancing" << std::endl;
 	std::cout << "\t 3: outBreak game (reversed Breakout)" << std::endl;
+	std::cout << "\t 4: benchmark: instance matrices (no window)" << std::endl;
+	std::cout << "\t 5: benchmark: scenes (hidden window, writes benchmark.json)" << std::endl;
 	std::cout << "\t 0: exit." << std::endl;
 
 	int choice = 0;
 	do
 	{
 		std::cin >> choice;
-	} while (choice != 1 && choice != 2 && choice != 3 && choice != 0);
+	} while (choice != 1 && choice != 2 && choice != 3 && choice != 4 && choice != 5 && choice != 0);
 
 	if (choice == 1)
 	{
 		// demo: shadows
 		ShadowsDemoGame game{1000,1000};
+		game.setRenderThread(renderThread);
 		game.execute();
 	}
 	else if (choice == 2)
@@ -37,6 +87,16 @@ int main()
 		OutBreak outBreak{ 1000, 1000 };
 		outBreak.execute();
 	}
+	else if (choice == 4)
+	{
+		// benchmark: SIMD instance matrices
+		benchmark_matrices();
+	}
+	else if (choice == 5)
+	{
+		// benchmark: frame times of the demo scenes
+		benchmark_scenes(SceneBenchmarkOptions{});
+	}
 	
 	return 0;
 }
@@ -11,8 +11,14 @@ layout(location = 8) in vec4 aInstanceColor;
 
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// per-frame data, shared by all the programs (see Renderer/FrameUniforms.h)
+layout(std140) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	vec3 cameraPos;
+};
 
 out vec2 TexCoords;
 out vec4 instanceColor;
@@ -0,0 +1,63 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 4) in vec4 aInstanceRotation;    // quaternion (x, y, z, w)
+layout(location = 5) in vec3 aInstancePosition;
+layout(location = 6) in vec3 aInstanceScale;
+
+//uniform mat4 model;
+
+// rotates v by the unit quaternion q
+vec3 rotateByQuaternion(vec4 q, vec3 v)
+{
+	return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main()
+{
+	vec3 worldPos = aInstancePosition + rotateByQuaternion(aInstanceRotation, aInstanceScale * aPos);
+	gl_Position = vec4(worldPos, 1.0);
+}
+
+
+#shader geometry
+#version 330 core
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 18) out;
+
+uniform mat4 shadowMatrices[6];
+
+out vec4 FragPos; // FragPos from GS (output per emitvertex)
+
+void main()
+{
+	for (int face = 0; face < 6; ++face)
+	{
+		gl_Layer = face; // built-in variable that specifies to which face we render.
+		for (int i = 0; i < 3; ++i) // for each triangle's vertices
+		{
+			FragPos = gl_in[i].gl_Position;
+			gl_Position = shadowMatrices[face] * FragPos;
+			EmitVertex();
+		}
+		EndPrimitive();
+	}
+}
+
+#shader fragment
+#version 330 core
+in vec4 FragPos;
+
+uniform vec3 lightPos;
+uniform float far_plane;
+
+void main()
+{
+	float lightDistance = length(FragPos.xyz - lightPos);
+
+	// map to [0;1] range by dividing by far_plane
+	lightDistance = lightDistance / far_plane;
+
+	// write this as modified depth
+	gl_FragDepth = lightDistance;
+}
\ No newline at end of file
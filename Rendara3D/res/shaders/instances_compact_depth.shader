@@ -0,0 +1,29 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 4) in vec4 aInstanceRotation;    // quaternion (x, y, z, w)
+layout(location = 5) in vec3 aInstancePosition;
+layout(location = 6) in vec3 aInstanceScale;
+
+uniform mat4 lightSpaceMatrix;
+uniform mat4 model;
+
+// rotates v by the unit quaternion q
+vec3 rotateByQuaternion(vec4 q, vec3 v)
+{
+	return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main()
+{
+	vec3 worldPos = aInstancePosition + rotateByQuaternion(aInstanceRotation, aInstanceScale * aPos);
+	gl_Position = lightSpaceMatrix * vec4(worldPos, 1.0f);
+}
+
+#shader fragment
+
+void main()
+{
+	gl_FragDepth = gl_FragCoord.z;   // <- this happens automatically
+	//gl_FragDepth -= gl_FrontFacing ? 0.01 : 0.0;
+}
\ No newline at end of file
@@ -49,19 +49,27 @@ struct Sun {
 };
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 uniform mat4 normalMat;
-uniform vec3 cameraPos;
+
+// per-frame data, shared by all the programs (see Renderer/FrameUniforms.h)
+layout(std140) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	vec3 cameraPos;
+};
 out vec3	 cameraPos_world;
 out vec3	 cameraPos_tan;
 
 uniform FlashLight flashLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
 
-// sun 
-uniform Sun  sun[NR_SUNS];
-uniform mat4 lightSpaceMatrix[NR_SUNS]; // shadow
+// lights of the scene, shared by all the programs (see Renderer/FrameUniforms.h)
+layout(std140) uniform Lights
+{
+	Sun        sun[NR_SUNS];
+	PointLight pointLights[NR_POINT_LIGHTS];
+	mat4       lightSpaceMatrix[NR_SUNS]; // shadow
+};
 out vec4 FragPosLightSpace[NR_SUNS];    // shadow
 
 out vec3 FragPos;
@@ -0,0 +1,291 @@
+#include "AllocationTracker.h"
+
+/* stl */
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <iomanip>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ALLOCATION_CALLER() _ReturnAddress()
+#else
+#define ALLOCATION_CALLER() __builtin_return_address(0)
+#endif
+
+
+std::atomic<bool> AllocationTracker::s_enabled{ false };
+std::atomic<bool> AllocationTracker::s_captureCallSites{ false };
+
+
+namespace {
+
+	// nothing here may allocate: it runs inside operator new
+	std::atomic<uint64_t> s_allocations{ 0 };
+	std::atomic<uint64_t> s_bytes{ 0 };
+	std::atomic<uint64_t> s_deallocations{ 0 };
+	std::atomic<uint64_t> s_violationCount{ 0 };
+
+	thread_local AllocationCounters t_counters;
+	thread_local const char*        t_allocationFree = nullptr;   // innermost allocation-free scope
+
+	// violations and call sites, written by all the threads
+	std::atomic_flag    s_lock = ATOMIC_FLAG_INIT;
+	AllocationViolation s_violations[AllocationTracker::MAX_VIOLATIONS];
+	AllocationCallSite  s_callSites[AllocationTracker::MAX_CALL_SITES];   // open addressing on the address
+	size_t              s_numCallSites = 0;
+
+	// written by the thread calling beginFrame
+	AllocationCounters s_frameStart;
+	AllocationCounters s_lastFrame;
+
+	struct SpinLock
+	{
+		SpinLock()  { while (s_lock.test_and_set(std::memory_order_acquire)) {} }
+		~SpinLock() { s_lock.clear(std::memory_order_release); }
+	};
+
+	void countCallSite(const void* address, size_t bytes)
+	{
+		size_t slot = ((uintptr_t)address >> 4) % AllocationTracker::MAX_CALL_SITES;
+		for (size_t probe = 0; probe < AllocationTracker::MAX_CALL_SITES; probe++)
+		{
+			AllocationCallSite& site = s_callSites[(slot + probe) % AllocationTracker::MAX_CALL_SITES];
+			if (site.address == address || site.address == nullptr)
+			{
+				if (site.address == nullptr)
+				{
+					site.address = address;
+					s_numCallSites++;
+				}
+				site.allocations++;
+				site.bytes += bytes;
+				return;
+			}
+		}
+		// the table is full: the new call sites are not kept
+	}
+
+}
+
+
+void AllocationTracker::setCaptureCallSites(bool capture)
+{
+	s_captureCallSites.store(capture, std::memory_order_relaxed);
+}
+
+AllocationCounters AllocationTracker::getTotal()
+{
+	AllocationCounters total;
+	total.allocations = s_allocations.load(std::memory_order_relaxed);
+	total.bytes = s_bytes.load(std::memory_order_relaxed);
+	total.deallocations = s_deallocations.load(std::memory_order_relaxed);
+	return total;
+}
+
+AllocationCounters AllocationTracker::getThreadCounters()
+{
+	return t_counters;
+}
+
+void AllocationTracker::beginFrame()
+{
+	AllocationCounters total = getTotal();
+	s_lastFrame = total - s_frameStart;
+	s_frameStart = total;
+}
+
+AllocationCounters AllocationTracker::getLastFrame()
+{
+	return s_lastFrame;
+}
+
+uint64_t AllocationTracker::getViolationCount()
+{
+	return s_violationCount.load(std::memory_order_relaxed);
+}
+
+std::vector<AllocationViolation> AllocationTracker::getViolations()
+{
+	// allocates outside the lock: a violation in this scope would take it
+	std::vector<AllocationViolation> violations(MAX_VIOLATIONS);
+	size_t count;
+	{
+		SpinLock lock;
+		count = (size_t)std::min<uint64_t>(s_violationCount.load(std::memory_order_relaxed), MAX_VIOLATIONS);
+		std::copy(s_violations, s_violations + count, violations.begin());
+	}
+	violations.resize(count);
+	return violations;
+}
+
+std::vector<AllocationCallSite> AllocationTracker::getCallSites()
+{
+	std::vector<AllocationCallSite> sites(MAX_CALL_SITES);
+	{
+		SpinLock lock;
+		std::copy(s_callSites, s_callSites + MAX_CALL_SITES, sites.begin());
+	}
+	sites.erase(std::remove_if(sites.begin(), sites.end(), [](const AllocationCallSite& site) { return site.address == nullptr; }), sites.end());
+	std::sort(sites.begin(), sites.end(),
+		[](const AllocationCallSite& a, const AllocationCallSite& b) { return a.allocations > b.allocations; });
+	return sites;
+}
+
+void AllocationTracker::dump(std::ostream& out)
+{
+	if (!isAvailable())
+	{
+		out << "[AllocationTracker] built without ALLOCATION_TRACKING" << std::endl;
+		return;
+	}
+	AllocationCounters frame = getLastFrame();
+	out << "allocations last frame: " << frame.allocations << " (" << frame.bytes << " bytes), deallocations: "
+		<< frame.deallocations << "\n";
+
+	uint64_t violationCount = getViolationCount();
+	if (violationCount > 0)
+	{
+		out << violationCount << " allocations in allocation-free scopes:\n";
+		for (const AllocationViolation& violation : getViolations())
+		{
+			out << "  " << violation.scope << ": " << violation.bytes << " bytes";
+			if (violation.callSite != nullptr)
+			{
+				out << " from " << violation.callSite;
+			}
+			out << "\n";
+		}
+	}
+
+	std::vector<AllocationCallSite> sites = getCallSites();
+	if (!sites.empty())
+	{
+		out << "most frequent call sites:\n";
+		for (size_t s = 0; s < sites.size() && s < 10; s++)
+		{
+			out << "  " << std::setw(18) << sites.at(s).address << std::setw(12) << sites.at(s).allocations
+				<< " allocations" << std::setw(14) << sites.at(s).bytes << " bytes\n";
+		}
+	}
+	out.flush();
+}
+
+void AllocationTracker::reset()
+{
+	SpinLock lock;
+	s_violationCount.store(0, std::memory_order_relaxed);
+	std::fill(s_callSites, s_callSites + MAX_CALL_SITES, AllocationCallSite{ nullptr, 0, 0 });
+	s_numCallSites = 0;
+}
+
+void AllocationTracker::countAllocation(size_t bytes, const void* callSite)
+{
+	t_counters.allocations++;
+	t_counters.bytes += bytes;
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	s_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+	if (t_allocationFree == nullptr && callSite == nullptr)
+	{
+		return;
+	}
+	SpinLock lock;
+	if (t_allocationFree != nullptr)
+	{
+		uint64_t index = s_violationCount.fetch_add(1, std::memory_order_relaxed);
+		if (index < MAX_VIOLATIONS)
+		{
+			s_violations[index] = AllocationViolation{ t_allocationFree, bytes, callSite };
+		}
+	}
+	if (callSite != nullptr)
+	{
+		countCallSite(callSite, bytes);
+	}
+}
+
+void AllocationTracker::countDeallocation()
+{
+	t_counters.deallocations++;
+	s_deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocationTracker::enterAllocationFree(const char* scope, const char*& previous)
+{
+	previous = t_allocationFree;
+	t_allocationFree = scope;
+}
+
+void AllocationTracker::leaveAllocationFree(const char* previous)
+{
+	t_allocationFree = previous;
+}
+
+
+#if ALLOCATION_TRACKING
+
+namespace {
+
+	void* trackedAllocate(size_t size, const void* caller)
+	{
+		if (AllocationTracker::isEnabled())
+		{
+			AllocationTracker::countAllocation(size, AllocationTracker::isCapturingCallSites() ? caller : nullptr);
+		}
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	void trackedFree(void* pointer)
+	{
+		if (pointer == nullptr)
+		{
+			return;
+		}
+		if (AllocationTracker::isEnabled())
+		{
+			AllocationTracker::countDeallocation();
+		}
+		std::free(pointer);
+	}
+
+}
+
+void* operator new(size_t size)
+{
+	void* pointer = trackedAllocate(size, ALLOCATION_CALLER());
+	if (pointer == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void* operator new[](size_t size)
+{
+	void* pointer = trackedAllocate(size, ALLOCATION_CALLER());
+	if (pointer == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return trackedAllocate(size, ALLOCATION_CALLER());
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return trackedAllocate(size, ALLOCATION_CALLER());
+}
+
+void operator delete(void* pointer) noexcept                          { trackedFree(pointer); }
+void operator delete[](void* pointer) noexcept                        { trackedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept                  { trackedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept                { trackedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept   { trackedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { trackedFree(pointer); }
+
+#endif
@@ -0,0 +1,131 @@
+#pragma once
+
+/* stl */
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <ostream>
+
+
+// ALLOCATION_TRACKING 1 (default) replaces the global operator new / delete (AllocationTracker.cpp) to count the
+// allocations while the tracker is enabled; 0 keeps the ones of the standard library and compiles ALLOCATION_FREE_SCOPE out.
+#ifndef ALLOCATION_TRACKING
+#define ALLOCATION_TRACKING 1
+#endif
+
+#define ALLOCATION_TRACKING_CONCAT_(a, b) a##b
+#define ALLOCATION_TRACKING_CONCAT(a, b) ALLOCATION_TRACKING_CONCAT_(a, b)
+
+#if ALLOCATION_TRACKING
+// the rest of the enclosing C++ scope must not allocate: the allocations made there are reported as violations
+#define ALLOCATION_FREE_SCOPE(name) AllocationFreeScope ALLOCATION_TRACKING_CONCAT(allocationFreeScope, __LINE__)(name)
+#else
+#define ALLOCATION_FREE_SCOPE(name) ((void)0)
+#endif
+
+
+//! Allocations made through operator new, and how many bytes they asked for.
+struct AllocationCounters
+{
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+	uint64_t deallocations = 0;
+
+	AllocationCounters operator-(const AllocationCounters& other) const
+	{
+		AllocationCounters difference;
+		difference.allocations = allocations - other.allocations;
+		difference.bytes = bytes - other.bytes;
+		difference.deallocations = deallocations - other.deallocations;
+		return difference;
+	}
+};
+
+//! Allocation made inside an allocation-free scope.
+struct AllocationViolation
+{
+	const char* scope;     // innermost ALLOCATION_FREE_SCOPE
+	size_t      bytes;
+	const void* callSite;  // caller of operator new, nullptr unless setCaptureCallSites(true)
+};
+
+//! Allocations of the same caller of operator new.
+struct AllocationCallSite
+{
+	const void* address;
+	uint64_t    allocations;
+	uint64_t    bytes;
+};
+
+
+//! Counts the heap allocations of the program, per thread and per frame, when built with ALLOCATION_TRACKING 1.
+/*!
+	The replaced operator new counts each allocation in a counter of the calling thread and in the totals, but
+	only while enabled: disabled, it costs a relaxed load over malloc. CPU_PROFILE_SCOPE reads the counters of its
+	thread, so the Chrome trace tells the allocations of each scope (see CpuProfiler).
+	ALLOCATION_FREE_SCOPE marks code that must not allocate once warmed up (the render loop of Simple3DRenderer,
+	the sort of RenderQueue...): an allocation made inside is a violation, kept with its scope (the first
+	MAX_VIOLATIONS) to be reported later, since nothing can be printed from inside operator new.
+	With setCaptureCallSites(true) the return address of operator new is kept too, and the allocations are summed
+	per call site (the first MAX_CALL_SITES addresses). The addresses are symbolized with the debugger.
+	Without ALLOCATION_TRACKING, isAvailable() is false and all the counters stay at zero.
+*/
+class AllocationTracker
+{
+public:
+	static const size_t MAX_VIOLATIONS = 64;
+	static const size_t MAX_CALL_SITES = 512;
+
+	static bool isAvailable() { return ALLOCATION_TRACKING != 0; }
+
+	static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+	static bool isEnabled()              { return s_enabled.load(std::memory_order_relaxed); }
+	static void setCaptureCallSites(bool capture);
+
+	//!< Allocations of all the threads since the start.
+	static AllocationCounters getTotal();
+	//!< Allocations of the calling thread since it started.
+	static AllocationCounters getThreadCounters();
+
+	//!< Ends the current frame (its counters become getLastFrame) and starts a new one.
+	static void beginFrame();
+	static AllocationCounters getLastFrame();
+
+	//!< Number of violations since the last reset, and the first MAX_VIOLATIONS of them.
+	static uint64_t getViolationCount();
+	static std::vector<AllocationViolation> getViolations();
+	//!< Call sites sorted by number of allocations, most frequent first.
+	static std::vector<AllocationCallSite> getCallSites();
+
+	//!< Writes the counters of the last frame, the violations and the most frequent call sites.
+	static void dump(std::ostream& out);
+	//!< Forgets the violations and the call sites (not the counters).
+	static void reset();
+
+	// used by operator new / delete and AllocationFreeScope
+	static void countAllocation(size_t bytes, const void* callSite);
+	static void countDeallocation();
+	static void enterAllocationFree(const char* scope, const char*& previous);
+	static void leaveAllocationFree(const char* previous);
+	static bool isCapturingCallSites() { return s_captureCallSites.load(std::memory_order_relaxed); }
+
+private:
+	static std::atomic<bool> s_enabled;
+	static std::atomic<bool> s_captureCallSites;
+};
+
+
+//! Scope where the calling thread must not allocate, ended at the end of the C++ scope (see ALLOCATION_FREE_SCOPE).
+class AllocationFreeScope
+{
+public:
+	explicit AllocationFreeScope(const char* name) : m_previous(nullptr) { AllocationTracker::enterAllocationFree(name, m_previous); }
+	~AllocationFreeScope() { AllocationTracker::leaveAllocationFree(m_previous); }
+
+	AllocationFreeScope(const AllocationFreeScope&) = delete;
+	AllocationFreeScope& operator=(const AllocationFreeScope&) = delete;
+
+private:
+	const char* m_previous;
+};
@@ -0,0 +1,231 @@
+#include "CpuProfiler.h"
+
+/* stl */
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+
+
+std::atomic<bool> CpuProfiler::s_enabled{ false };
+
+
+namespace {
+
+	struct CpuEvent
+	{
+		const char* name;
+		int64_t     start;     // ns
+		int64_t     duration;  // ns
+		uint64_t    allocations;
+		uint64_t    bytes;
+	};
+
+	// events of one thread, in a ring written by that thread only. The event i (counted since the thread started)
+	// is at events[i % EVENTS_PER_THREAD]; written is published after the event, so a reader copies the events
+	// below it and then drops those the writer may have overwritten meanwhile (see writeChromeTrace)
+	struct ThreadBuffer
+	{
+		std::vector<CpuEvent> events;
+		std::atomic<uint64_t> written{ 0 };
+		std::atomic<uint64_t> cleared{ 0 };   // events below it were forgotten by clear
+		unsigned int          id = 0;
+		std::mutex            nameMutex;      // the name only: setThreadName is not on the hot path
+		std::string           name;
+	};
+
+	// the buffers outlive their threads, so the intervals of a finished thread are still exported
+	struct Registry
+	{
+		std::mutex                                 mutex;
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		std::string                                exitPath;
+	};
+
+	Registry& registry()
+	{
+		static Registry instance;
+		return instance;
+	}
+
+	ThreadBuffer& threadBuffer()
+	{
+		thread_local std::shared_ptr<ThreadBuffer> buffer;
+		if (!buffer)
+		{
+			buffer = std::make_shared<ThreadBuffer>();
+			buffer->events.resize(CpuProfiler::EVENTS_PER_THREAD);
+			Registry& r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			buffer->id = (unsigned int)r.buffers.size() + 1;
+			buffer->name = "thread " + std::to_string(buffer->id);
+			r.buffers.push_back(buffer);
+		}
+		return *buffer;
+	}
+
+	void writeJsonString(std::ostream& out, const char* text)
+	{
+		out << '"';
+		for (const char* c = text; *c != '\0'; c++)
+		{
+			if (*c == '"' || *c == '\\')
+			{
+				out << '\\';
+			}
+			out << ((*c >= 0 && *c < 0x20) ? ' ' : *c);
+		}
+		out << '"';
+	}
+
+	// microseconds with the nanoseconds as decimals, as the trace format expects
+	void writeMicroseconds(std::ostream& out, int64_t nanoseconds)
+	{
+		char text[32];
+		std::snprintf(text, sizeof(text), "%lld.%03lld", (long long)(nanoseconds / 1000), (long long)(nanoseconds % 1000));
+		out << text;
+	}
+
+	void exportAtExitHandler()
+	{
+		CpuProfiler::writeChromeTrace(registry().exitPath);
+	}
+
+}
+
+
+void CpuProfiler::record(const char* name, int64_t start, int64_t end, uint64_t allocations, uint64_t bytes)
+{
+	ThreadBuffer& buffer = threadBuffer();
+	uint64_t index = buffer.written.load(std::memory_order_relaxed);
+	CpuEvent& event = buffer.events[index % EVENTS_PER_THREAD];
+	event.name = name;
+	event.start = start;
+	event.duration = end - start;
+	event.allocations = allocations;
+	event.bytes = bytes;
+	buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::setThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer = threadBuffer();
+	std::lock_guard<std::mutex> lock(buffer.nameMutex);
+	buffer.name = name;
+}
+
+void CpuProfiler::writeChromeTrace(std::ostream& out)
+{
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	{
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		buffers = r.buffers;
+	}
+
+	// copies the rings first, while the threads keep recording
+	std::vector<std::vector<CpuEvent>> events(buffers.size());
+	std::vector<std::string> names(buffers.size());
+	int64_t origin = std::numeric_limits<int64_t>::max();
+	for (size_t t = 0; t < buffers.size(); t++)
+	{
+		ThreadBuffer& buffer = *buffers.at(t);
+		uint64_t end = buffer.written.load(std::memory_order_acquire);
+		uint64_t begin = std::max(buffer.cleared.load(std::memory_order_relaxed), (end > EVENTS_PER_THREAD) ? end - EVENTS_PER_THREAD : 0);
+		std::vector<CpuEvent>& copy = events.at(t);
+		for (uint64_t i = begin; i < end; i++)
+		{
+			copy.push_back(buffer.events[i % EVENTS_PER_THREAD]);
+		}
+		// the events the writer got to again during the copy may be torn: drop them
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t written = buffer.written.load(std::memory_order_relaxed);
+		uint64_t overwritten = (written > EVENTS_PER_THREAD) ? written - EVENTS_PER_THREAD : 0;
+		if (overwritten > begin)
+		{
+			copy.erase(copy.begin(), copy.begin() + (size_t)std::min(overwritten - begin, end - begin));
+		}
+		for (const CpuEvent& event : copy)
+		{
+			origin = std::min(origin, event.start);
+		}
+		std::lock_guard<std::mutex> lock(buffer.nameMutex);
+		names.at(t) = buffer.name;
+	}
+	if (origin == std::numeric_limits<int64_t>::max())
+	{
+		origin = 0;
+	}
+
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Rendara3D\"}}";
+	for (size_t t = 0; t < buffers.size(); t++)
+	{
+		unsigned int tid = buffers.at(t)->id;
+		out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+		writeJsonString(out, names.at(t).c_str());
+		out << "}}";
+		for (const CpuEvent& event : events.at(t))
+		{
+			out << ",\n{\"name\":";
+			writeJsonString(out, event.name);
+			out << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+			writeMicroseconds(out, event.start - origin);
+			out << ",\"dur\":";
+			writeMicroseconds(out, event.duration);
+			if (event.allocations > 0)
+			{
+				out << ",\"args\":{\"allocations\":" << event.allocations << ",\"bytes\":" << event.bytes << "}";
+			}
+			out << "}";
+		}
+	}
+	out << "\n]}\n";
+}
+
+bool CpuProfiler::writeChromeTrace(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cerr << "[CpuProfiler] Cannot write the trace to " << path << std::endl;
+		return false;
+	}
+	writeChromeTrace(file);
+	std::cerr << "[CpuProfiler] Trace written to " << path << std::endl;
+	return true;
+}
+
+void CpuProfiler::exportAtExit(const std::string& path)
+{
+	Registry& r = registry();
+	bool registered;
+	{
+		std::lock_guard<std::mutex> lock(r.mutex);
+		registered = !r.exitPath.empty();
+		r.exitPath = path;
+	}
+	// registered after the registry was created, the handler runs before it is destroyed
+	if (!registered)
+	{
+		std::atexit(exportAtExitHandler);
+	}
+}
+
+void CpuProfiler::clear()
+{
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	for (size_t t = 0; t < r.buffers.size(); t++)
+	{
+		// the writer owns written: the events before it are only hidden
+		ThreadBuffer& buffer = *r.buffers.at(t);
+		buffer.cleared.store(buffer.written.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
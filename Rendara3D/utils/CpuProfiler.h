@@ -0,0 +1,98 @@
+#pragma once
+
+/* stl */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <ostream>
+
+#include "AllocationTracker.h"
+
+
+// CPU_PROFILE 0 compiles the CPU_PROFILE_SCOPE markers out; with 1 (default) they cost a relaxed load while disabled
+#ifndef CPU_PROFILE
+#define CPU_PROFILE 1
+#endif
+
+#define CPU_PROFILE_CONCAT_(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_(a, b)
+
+#if CPU_PROFILE
+// times the rest of the enclosing C++ scope under name, which must be a string literal
+#define CPU_PROFILE_SCOPE(name) CpuScope CPU_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#else
+#define CPU_PROFILE_SCOPE(name) ((void)0)
+#endif
+
+
+//! Records named CPU time intervals of every thread, and writes them as a Chrome trace.
+/*!
+	Each thread writes into its own ring of EVENTS_PER_THREAD events, so recording takes no lock. Disabled (the
+	default), CPU_PROFILE_SCOPE only checks the flag.
+*/
+class CpuProfiler
+{
+public:
+	static const size_t EVENTS_PER_THREAD = 1 << 16;
+
+	static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+	static bool isEnabled()              { return s_enabled.load(std::memory_order_relaxed); }
+
+	//!< Nanoseconds of the steady clock.
+	static int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	//!< Adds the interval [start, end] to the ring of the calling thread (allocated at its first call, the oldest
+	//!< events are overwritten), with the allocations made in it. Takes no lock. The name is not copied: use a string literal.
+	static void record(const char* name, int64_t start, int64_t end, uint64_t allocations = 0, uint64_t bytes = 0);
+	//!< Name of the calling thread in the trace.
+	static void setThreadName(const std::string& name);
+
+	//!< Writes the events recorded so far by all the threads, while they may still be recording, in the JSON trace
+	//!< event format of chrome://tracing and ui.perfetto.dev: one "X" event per interval and one track per thread.
+	static void writeChromeTrace(std::ostream& out);
+	static bool writeChromeTrace(const std::string& path);
+	//!< Writes the trace to path when the program exits normally.
+	static void exportAtExit(const std::string& path);
+	//!< Forgets the events recorded so far.
+	static void clear();
+
+private:
+	static std::atomic<bool> s_enabled;
+};
+
+
+//! Interval from its construction to its destruction, recorded if the profiler was enabled at the start.
+class CpuScope
+{
+public:
+	explicit CpuScope(const char* name)
+		: m_name(CpuProfiler::isEnabled() ? name : nullptr)
+	{
+		if (m_name != nullptr)
+		{
+			m_allocations = AllocationTracker::getThreadCounters();
+			m_start = CpuProfiler::now();
+		}
+	}
+	~CpuScope()
+	{
+		if (m_name != nullptr)
+		{
+			int64_t end = CpuProfiler::now();
+			AllocationCounters allocations = AllocationTracker::getThreadCounters() - m_allocations;
+			CpuProfiler::record(m_name, m_start, end, allocations.allocations, allocations.bytes);
+		}
+	}
+
+	CpuScope(const CpuScope&) = delete;
+	CpuScope& operator=(const CpuScope&) = delete;
+
+private:
+	const char*        m_name;
+	int64_t            m_start = 0;
+	AllocationCounters m_allocations;  // of the thread at the start
+};
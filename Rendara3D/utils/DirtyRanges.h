@@ -0,0 +1,103 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <cstdint>
+
+
+namespace memory {
+
+	//! Remembers which elements of an array changed since the last clear, to upload only those.
+	/*!
+		One bit per element. The marked elements are visited as ranges [begin, end) of consecutive
+		indices; ranges separated by at most mergeGap clean elements are merged into one, since a
+		single larger upload is usually cheaper than many small ones.
+	*/
+	class DirtyRanges
+	{
+	public:
+		DirtyRanges(size_t maxElements) : m_words((maxElements + 63) / 64, 0), m_any(false) {}
+
+		bool any() const { return m_any; }
+
+		//!< Makes room for maxElements elements, keeping the marks.
+		void reserve(size_t maxElements)
+		{
+			if (m_words.size() * 64 < maxElements)
+			{
+				m_words.resize((maxElements + 63) / 64, 0);
+			}
+		}
+
+		void mark(size_t i)
+		{
+			m_words[i / 64] |= uint64_t(1) << (i % 64);
+			m_any = true;
+		}
+
+		void markRange(size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				mark(i);
+			}
+		}
+
+		void clear()
+		{
+			if (!m_any) return;
+			for (size_t w = 0; w < m_words.size(); w++)
+			{
+				m_words[w] = 0;
+			}
+			m_any = false;
+		}
+
+		//!< Calls function(begin, end) for each dirty range below size, in increasing order.
+		template <class Function>
+		void forEachRange(size_t size, size_t mergeGap, Function function) const
+		{
+			if (!m_any) return;
+
+			bool   open  = false;
+			size_t begin = 0;
+			size_t end   = 0;
+			for (size_t w = 0; w < m_words.size() && w * 64 < size; w++)
+			{
+				uint64_t word = m_words[w];
+				while (word != 0)
+				{
+					size_t i = w * 64 + lowestBit(word);
+					word &= word - 1;
+					if (i >= size) break;
+
+					if (open && i <= end + mergeGap)
+					{
+						end = i + 1;
+					}
+					else
+					{
+						if (open) function(begin, end);
+						open  = true;
+						begin = i;
+						end   = i + 1;
+					}
+				}
+			}
+			if (open) function(begin, end);
+		}
+
+	private:
+		std::vector<uint64_t> m_words;
+		bool                  m_any;
+
+		static unsigned int lowestBit(uint64_t word)
+		{
+			unsigned int bit = 0;
+			while ((word & 0xFF) == 0) { word >>= 8; bit += 8; }
+			while ((word & 1) == 0)    { word >>= 1; bit += 1; }
+			return bit;
+		}
+	};
+
+}
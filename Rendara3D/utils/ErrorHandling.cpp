@@ -1,18 +1,131 @@
 #include "ErrorHandling.h"
 
-bool GLlogCall()//const char* function, const char* file, int line)
+
+namespace {
+
+	const char* errorName(GLenum error)
+	{
+		switch (error)
+		{
+		case GL_INVALID_ENUM:                  return "GL_INVALID_ENUM";
+		case GL_INVALID_VALUE:                 return "GL_INVALID_VALUE";
+		case GL_INVALID_OPERATION:             return "GL_INVALID_OPERATION";
+		case GL_INVALID_FRAMEBUFFER_OPERATION: return "GL_INVALID_FRAMEBUFFER_OPERATION";
+		case GL_OUT_OF_MEMORY:                 return "GL_OUT_OF_MEMORY";
+		default:                               return "unknown error";
+		}
+	}
+
+	const char* sourceName(GLenum source)
+	{
+		switch (source)
+		{
+		case GL_DEBUG_SOURCE_API:             return "api";
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "window system";
+		case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+		case GL_DEBUG_SOURCE_THIRD_PARTY:     return "third party";
+		case GL_DEBUG_SOURCE_APPLICATION:     return "application";
+		default:                              return "other";
+		}
+	}
+
+	const char* typeName(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_DEBUG_TYPE_ERROR:               return "error";
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated behavior";
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined behavior";
+		case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+		case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+		case GL_DEBUG_TYPE_MARKER:              return "marker";
+		default:                                return "other";
+		}
+	}
+
+	const char* severityName(GLenum severity)
+	{
+		switch (severity)
+		{
+		case GL_DEBUG_SEVERITY_HIGH:   return "high";
+		case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+		case GL_DEBUG_SEVERITY_LOW:    return "low";
+		default:                       return "notification";
+		}
+	}
+
+	void GLAPIENTRY debugOutputCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+		GLsizei /*length*/, const GLchar* message, const void* /*userParam*/)
+	{
+		std::cerr << "[OpenGL " << typeName(type) << "] (" << sourceName(source) << ", " << severityName(severity)
+			<< ", id " << id << "): " << message << std::endl;
+		if (type == GL_DEBUG_TYPE_ERROR)
+		{
+			DEBUG_BREAK();
+		}
+	}
+
+	// KHR_debug, or the older ARB_debug_output of the drivers without it
+	bool hasKHRDebug() { return GLEW_KHR_debug && glDebugMessageCallback != nullptr; }
+	bool hasARBDebug() { return GLEW_ARB_debug_output && glDebugMessageCallbackARB != nullptr; }
+
+}
+
+
+bool GLlogCall(const char* function, const char* file, int line)
 {
+	bool ok = true;
 	while (GLenum error = glGetError())
 	{
-		std::cout << "[OpenGL error] (" << error << "):" <<
-			std::endl;
-			//function << " " << file << ":" << line << std::endl;
-		return false;
+		std::cerr << "[OpenGL error] " << errorName(error) << " (" << error << "): " <<
+			function << " " << file << ":" << line << std::endl;
+		ok = false;
 	}
-	return true;
+	return ok;
 }
 
 void GLclearErrors()
 {
 	while (glGetError() != GL_NO_ERROR);
-}
\ No newline at end of file
+}
+
+void enableGLDebugOutput(bool synchronous)
+{
+#if GL_CHECK_LEVEL == GL_CHECK_DEBUG_OUTPUT
+	if (hasKHRDebug())
+	{
+		glEnable(GL_DEBUG_OUTPUT);
+		glDebugMessageCallback(debugOutputCallback, nullptr);
+	}
+	else if (hasARBDebug())
+	{
+		glDebugMessageCallbackARB(debugOutputCallback, nullptr);
+	}
+	else
+	{
+		std::cerr << "[Graphics Engine Warning]: the driver has no KHR_debug: OpenGL errors are not reported. "
+			"Build with GL_CHECK_LEVEL=GL_CHECK_SYNC to check them." << std::endl;
+		return;
+	}
+
+	if (synchronous)
+	{
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	}
+	setGLDebugFilter(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, false);
+#else
+	(void)synchronous;
+#endif
+}
+
+void setGLDebugFilter(GLenum source, GLenum type, GLenum severity, bool enabled)
+{
+	if (hasKHRDebug())
+	{
+		glDebugMessageControl(source, type, severity, 0, nullptr, enabled ? GL_TRUE : GL_FALSE);
+	}
+	else if (hasARBDebug() && severity != GL_DEBUG_SEVERITY_NOTIFICATION) // not in ARB_debug_output
+	{
+		glDebugMessageControlARB(source, type, severity, 0, nullptr, enabled ? GL_TRUE : GL_FALSE);
+	}
+}
@@ -4,13 +4,53 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 
-#define ASSERT(x) if (!(x)) __debugbreak();
+#if !defined(_MSC_VER)
+#include <csignal>
+#endif
 
+// How the OpenGL errors are checked, chosen at compile time with GL_CHECK_LEVEL:
+//  GL_CHECK_OFF           GLCall(x) is just x. Default in release builds.
+//  GL_CHECK_DEBUG_OUTPUT  GLCall(x) is just x; the driver reports the errors (and warnings) through the KHR_debug
+//                         callback installed by enableGLDebugOutput. Default in debug builds.
+//  GL_CHECK_SYNC          glGetError before and after every GLCall, reporting the call, file and line. Slow.
+#define GL_CHECK_OFF          0
+#define GL_CHECK_DEBUG_OUTPUT 1
+#define GL_CHECK_SYNC         2
+
+#ifndef GL_CHECK_LEVEL
+#ifdef _DEBUG
+#define GL_CHECK_LEVEL GL_CHECK_DEBUG_OUTPUT
+#else
+#define GL_CHECK_LEVEL GL_CHECK_OFF
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#define DEBUG_BREAK() __debugbreak()
+#else
+#define DEBUG_BREAK() std::raise(SIGTRAP)
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+#if GL_CHECK_LEVEL == GL_CHECK_SYNC
 #define GLCall(x)\
 {GLclearErrors();\
 x;\
-ASSERT(GLlogCall());}
+ASSERT(GLlogCall(#x, __FILE__, __LINE__));}
+#else
+#define GLCall(x)\
+{x;}
+#endif
 
 
-bool GLlogCall();// const char* function, const char* file, int line);
+bool GLlogCall(const char* function, const char* file, int line);
 void GLclearErrors();
+
+//!< With GL_CHECK_DEBUG_OUTPUT, installs the callback printing the driver messages. To call once the context is current.
+//!< synchronous makes the driver call it from inside the faulty call (slower, but the call is on the stack).
+//!< Does nothing with the other levels.
+void enableGLDebugOutput(bool synchronous = false);
+//!< Enables or disables the driver messages of the source, type and severity (GL_DONT_CARE matches all of them).
+//!< enableGLDebugOutput already disables the GL_DEBUG_SEVERITY_NOTIFICATION ones.
+void setGLDebugFilter(GLenum source, GLenum type, GLenum severity, bool enabled);
@@ -0,0 +1,107 @@
+#include "FrameArena.h"
+
+/* stl */
+#include <new>
+#include <cstring>
+
+
+namespace memory {
+
+	LinearArena::LinearArena(size_t capacity) : m_current(0), m_offset(0), m_used(0), m_capacity(0)
+	{
+		if (capacity > 0)
+		{
+			addBlock(capacity);
+		}
+	}
+
+	LinearArena::~LinearArena()
+	{
+		release();
+	}
+
+	void* LinearArena::allocate(size_t size, size_t alignment)
+	{
+		for (;;)
+		{
+			if (m_current == m_blocks.size())
+			{
+				size_t last = m_blocks.empty() ? 0 : m_blocks.back().size;
+				addBlock(std::max(2 * last, size + alignment));
+			}
+			const Block& block = m_blocks[m_current];
+			uintptr_t start = (uintptr_t)block.data + m_offset;
+			uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+			size_t end = (size_t)(aligned - (uintptr_t)block.data) + size;
+			if (end <= block.size)
+			{
+				m_used += end - m_offset;
+				m_offset = end;
+				return (void*)aligned;
+			}
+			// the rest of the block stays unused until reset
+			m_current++;
+			m_offset = 0;
+		}
+	}
+
+	void LinearArena::reset()
+	{
+		if (m_blocks.size() > 1)
+		{
+			// one block for the whole of the last use: it will fit without growing next time
+			size_t capacity = m_capacity;
+			release();
+			addBlock(capacity);
+		}
+		m_current = 0;
+		m_offset = 0;
+		m_used = 0;
+	}
+
+	void LinearArena::addBlock(size_t size)
+	{
+		Block block;
+		block.data = static_cast<char*>(::operator new(size));
+		block.size = size;
+		m_blocks.push_back(block);
+		m_capacity += size;
+	}
+
+	void LinearArena::release()
+	{
+		for (size_t b = 0; b < m_blocks.size(); b++)
+		{
+			::operator delete(m_blocks[b].data);
+		}
+		m_blocks.clear();
+		m_capacity = 0;
+	}
+
+
+	FrameArena::FrameArena(size_t capacity) : m_even(capacity), m_odd(capacity), m_frame(0)
+	{
+	}
+
+	void FrameArena::beginFrame()
+	{
+		m_frame++;
+		current().reset();
+	}
+
+	const char* FrameArena::concat(const std::string& prefix, const char* suffix)
+	{
+		size_t suffixLength = std::strlen(suffix);
+		char* text = static_cast<char*>(allocate(prefix.size() + suffixLength + 1, 1));
+		std::memcpy(text, prefix.data(), prefix.size());
+		std::memcpy(text + prefix.size(), suffix, suffixLength + 1);
+		return text;
+	}
+
+	FrameArena& FrameArena::shared()
+	{
+		static FrameArena instance;
+		return instance;
+	}
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+
+
+namespace memory {
+
+	//! Bump allocator over blocks of memory, freed all at once by reset.
+	/*!
+		allocate moves an offset forward in the current block; when the block is full a new one (twice as large,
+		or as large as the request) is added. reset merges the blocks into a single one as large as all of them,
+		so after the first frames the same work fits in one block and allocating is only moving the offset.
+		Nothing is destroyed: only objects whose destructor does nothing (or that are destroyed by their owner
+		before reset, as the elements of a FrameVector) can be placed in it.
+	*/
+	class LinearArena
+	{
+	public:
+		explicit LinearArena(size_t capacity = 0);
+		~LinearArena();
+
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		//!< size bytes aligned to alignment (a power of two). Never returns nullptr: throws std::bad_alloc as new does.
+		void* allocate(size_t size, size_t alignment);
+		//!< Frees everything allocated so far.
+		void reset();
+
+		//!< Bytes allocated since the last reset, padding included.
+		size_t getUsed() const     { return m_used; }
+		size_t getCapacity() const { return m_capacity; }
+
+	private:
+		struct Block
+		{
+			char*  data;
+			size_t size;
+		};
+
+		std::vector<Block> m_blocks;
+		size_t             m_current;   // block allocate is moving through
+		size_t             m_offset;    // in the current block
+		size_t             m_used;
+		size_t             m_capacity;  // of all the blocks
+
+		void addBlock(size_t size);
+		void release();
+	};
+
+
+	//! Memory for what lives one frame: two LinearArena used in turn, one per frame.
+	/*!
+		beginFrame switches to the other arena and resets it, so what was allocated during a frame stays valid
+		during the next one too (e.g. what is drawn one frame after it was submitted) and is freed at the start
+		of the frame after. The main loop calls beginFrame at the start of each frame.
+		It is not thread safe: it belongs to the thread running the frame.
+	*/
+	class FrameArena
+	{
+	public:
+		static const size_t DEFAULT_CAPACITY = 1 << 20; // of each of the two arenas, before they grow
+
+		explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		//!< Frees what was allocated two frames ago and allocates in its memory from now on.
+		void beginFrame();
+		//!< Number of calls to beginFrame so far.
+		size_t getFrame() const { return m_frame; }
+
+		void* allocate(size_t size, size_t alignment) { return current().allocate(size, alignment); }
+		//!< Zero-terminated copy of prefix followed by suffix, valid until the end of the next frame.
+		const char* concat(const std::string& prefix, const char* suffix);
+
+		//!< Bytes allocated during this frame.
+		size_t getUsed() const { return (m_frame % 2 == 0) ? m_even.getUsed() : m_odd.getUsed(); }
+
+		//!< Arena of the main loop (Game, OutBreak and the scene benchmark call its beginFrame).
+		static FrameArena& shared();
+
+	private:
+		LinearArena m_even;
+		LinearArena m_odd;
+		size_t      m_frame;
+
+		LinearArena& current() { return (m_frame % 2 == 0) ? m_even : m_odd; }
+	};
+
+
+	//! STL allocator taking its memory from a FrameArena, or from the heap when it has no arena.
+	/*!
+		deallocate does nothing for arena memory: a container using it must be emptied, or moved to new memory
+		(see renewFrameVector), before its arena frees the frame it allocated in. The allocator is propagated by
+		copy, move and swap, so a container keeps the arena it was built with.
+	*/
+	template <class T>
+	class FrameAllocator
+	{
+	public:
+		typedef T              value_type;
+		typedef std::true_type propagate_on_container_copy_assignment;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		FrameAllocator() : m_arena(nullptr) {}
+		explicit FrameAllocator(FrameArena* arena) : m_arena(arena) {}
+		template <class U>
+		FrameAllocator(const FrameAllocator<U>& other) : m_arena(other.getArena()) {}
+
+		T* allocate(size_t n)
+		{
+			if (m_arena == nullptr)
+			{
+				return static_cast<T*>(::operator new(n * sizeof(T)));
+			}
+			return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* p, size_t)
+		{
+			if (m_arena == nullptr)
+			{
+				::operator delete(p);
+			}
+		}
+
+		FrameArena* getArena() const { return m_arena; }
+
+	private:
+		FrameArena* m_arena;
+	};
+
+	template <class T, class U>
+	bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) { return a.getArena() == b.getArena(); }
+	template <class T, class U>
+	bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) { return a.getArena() != b.getArena(); }
+
+	template <class T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+	//!< Moves the elements of the vector to memory of the current frame of its arena, with room for at least reserved elements.
+	template <class T>
+	void renewFrameVector(FrameVector<T>& vector, size_t reserved)
+	{
+		FrameVector<T> renewed(vector.get_allocator());
+		renewed.reserve(std::max(reserved, vector.size()));
+		renewed.insert(renewed.end(), vector.begin(), vector.end());
+		vector = std::move(renewed);
+	}
+
+}
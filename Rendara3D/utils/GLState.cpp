@@ -0,0 +1,388 @@
+#include "GLState.h"
+#include "../Renderer/RenderStats.h"
+
+
+namespace {
+
+	// the cache does not know the value: the next call reaches OpenGL
+	const unsigned int UNKNOWN = 0xFFFFFFFF;
+
+	struct Switch
+	{
+		GLenum capability;
+		int    enabled; // 1, 0 or -1 if unknown
+	};
+
+	struct Cache
+	{
+		unsigned int program;
+		unsigned int vertexArray;
+		unsigned int drawFramebuffer;
+		unsigned int readFramebuffer;
+		int          viewport[4];
+		bool         viewportKnown;
+		Switch       switches[3];
+		GLenum       cullFace;
+		GLenum       depthFunc;
+		unsigned int activeUnit;
+		unsigned int texture2D[GLState::MAX_TEXTURE_UNITS];
+		unsigned int textureCube[GLState::MAX_TEXTURE_UNITS];
+
+		Cache() : switches{ { GL_CULL_FACE, -1 }, { GL_DEPTH_TEST, -1 }, { GL_BLEND, -1 } } { reset(); }
+
+		void reset()
+		{
+			program = UNKNOWN;
+			vertexArray = UNKNOWN;
+			drawFramebuffer = UNKNOWN;
+			readFramebuffer = UNKNOWN;
+			viewportKnown = false;
+			for (size_t i = 0; i < 3; i++)
+			{
+				switches[i].enabled = -1;
+			}
+			cullFace = UNKNOWN;
+			depthFunc = UNKNOWN;
+			activeUnit = UNKNOWN;
+			for (unsigned int u = 0; u < GLState::MAX_TEXTURE_UNITS; u++)
+			{
+				texture2D[u] = UNKNOWN;
+				textureCube[u] = UNKNOWN;
+			}
+		}
+
+		// cached binding of the target on the unit, nullptr if not cached
+		unsigned int* texture(unsigned int unit, GLenum target)
+		{
+			if (unit >= GLState::MAX_TEXTURE_UNITS)
+			{
+				return nullptr;
+			}
+			if (target == GL_TEXTURE_2D)
+			{
+				return &texture2D[unit];
+			}
+			if (target == GL_TEXTURE_CUBE_MAP)
+			{
+				return &textureCube[unit];
+			}
+			return nullptr;
+		}
+
+		Switch* find(GLenum capability)
+		{
+			for (size_t i = 0; i < 3; i++)
+			{
+				if (switches[i].capability == capability)
+				{
+					return &switches[i];
+				}
+			}
+			return nullptr;
+		}
+	};
+
+	Cache s_cache;
+
+	GLenum textureBindingQuery(GLenum target)
+	{
+		return (target == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_BINDING_CUBE_MAP : GL_TEXTURE_BINDING_2D;
+	}
+
+#if GL_STATE_VALIDATE
+	void check(const char* what, GLint cached, GLint actual)
+	{
+		if (cached != actual)
+		{
+			std::cerr << "[GLState] Cache out of date for " << what << ": cached " << cached << ", OpenGL has " << actual
+				<< ". Some code changes this state without GLState." << std::endl;
+			ASSERT(false);
+		}
+	}
+
+	void checkInteger(const char* what, GLint cached, GLenum pname)
+	{
+		GLint actual = 0;
+		GLCall(glGetIntegerv(pname, &actual));
+		check(what, cached, actual);
+	}
+
+	void checkTexture(unsigned int unit, GLenum target, unsigned int cached)
+	{
+		GLint active = 0;
+		GLCall(glGetIntegerv(GL_ACTIVE_TEXTURE, &active));
+		GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+		checkInteger("texture binding", (GLint)cached, textureBindingQuery(target));
+		GLCall(glActiveTexture((GLenum)active));
+	}
+#endif
+
+}
+
+
+void GLState::useProgram(unsigned int program)
+{
+	if (s_cache.program == program)
+	{
+#if GL_STATE_VALIDATE
+		checkInteger("program", (GLint)program, GL_CURRENT_PROGRAM);
+#endif
+		return;
+	}
+	GLCall(glUseProgram(program));
+	RenderStats::countProgramBind();
+	s_cache.program = program;
+}
+
+void GLState::bindVertexArray(unsigned int vertexArray)
+{
+	if (s_cache.vertexArray == vertexArray)
+	{
+#if GL_STATE_VALIDATE
+		checkInteger("vertex array", (GLint)vertexArray, GL_VERTEX_ARRAY_BINDING);
+#endif
+		return;
+	}
+	GLCall(glBindVertexArray(vertexArray));
+	s_cache.vertexArray = vertexArray;
+}
+
+void GLState::bindFramebuffer(GLenum target, unsigned int framebuffer)
+{
+	bool draw = (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER);
+	bool read = (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER);
+	if ((!draw || s_cache.drawFramebuffer == framebuffer) && (!read || s_cache.readFramebuffer == framebuffer))
+	{
+#if GL_STATE_VALIDATE
+		if (draw)
+		{
+			checkInteger("draw framebuffer", (GLint)framebuffer, GL_DRAW_FRAMEBUFFER_BINDING);
+		}
+		if (read)
+		{
+			checkInteger("read framebuffer", (GLint)framebuffer, GL_READ_FRAMEBUFFER_BINDING);
+		}
+#endif
+		return;
+	}
+	GLCall(glBindFramebuffer(target, framebuffer));
+	RenderStats::countFramebufferBind();
+	if (draw)
+	{
+		s_cache.drawFramebuffer = framebuffer;
+	}
+	if (read)
+	{
+		s_cache.readFramebuffer = framebuffer;
+	}
+}
+
+void GLState::viewport(int x, int y, int width, int height)
+{
+	int* cached = s_cache.viewport;
+	if (s_cache.viewportKnown && cached[0] == x && cached[1] == y && cached[2] == width && cached[3] == height)
+	{
+#if GL_STATE_VALIDATE
+		GLint actual[4];
+		GLCall(glGetIntegerv(GL_VIEWPORT, actual));
+		for (size_t i = 0; i < 4; i++)
+		{
+			check("viewport", cached[i], actual[i]);
+		}
+#endif
+		return;
+	}
+	GLCall(glViewport(x, y, width, height));
+	cached[0] = x;
+	cached[1] = y;
+	cached[2] = width;
+	cached[3] = height;
+	s_cache.viewportKnown = true;
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled)
+{
+	Switch* cached = s_cache.find(capability);
+	if (cached != nullptr && cached->enabled == (enabled ? 1 : 0))
+	{
+#if GL_STATE_VALIDATE
+		GLboolean actual = GL_FALSE;
+		GLCall(actual = glIsEnabled(capability));
+		check("capability", cached->enabled, actual == GL_TRUE ? 1 : 0);
+#endif
+		return;
+	}
+	if (enabled)
+	{
+		GLCall(glEnable(capability));
+	}
+	else
+	{
+		GLCall(glDisable(capability));
+	}
+	if (cached != nullptr)
+	{
+		cached->enabled = enabled ? 1 : 0;
+	}
+}
+
+void GLState::cullFace(GLenum mode)
+{
+	if (s_cache.cullFace == mode)
+	{
+#if GL_STATE_VALIDATE
+		checkInteger("cull face", (GLint)mode, GL_CULL_FACE_MODE);
+#endif
+		return;
+	}
+	GLCall(glCullFace(mode));
+	s_cache.cullFace = mode;
+}
+
+void GLState::depthFunc(GLenum func)
+{
+	if (s_cache.depthFunc == func)
+	{
+#if GL_STATE_VALIDATE
+		checkInteger("depth function", (GLint)func, GL_DEPTH_FUNC);
+#endif
+		return;
+	}
+	GLCall(glDepthFunc(func));
+	s_cache.depthFunc = func;
+}
+
+void GLState::activeTexture(unsigned int unit)
+{
+	if (s_cache.activeUnit == unit)
+	{
+#if GL_STATE_VALIDATE
+		checkInteger("active texture", (GLint)(GL_TEXTURE0 + unit), GL_ACTIVE_TEXTURE);
+#endif
+		return;
+	}
+	GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+	s_cache.activeUnit = unit;
+}
+
+void GLState::bindTexture(GLenum target, unsigned int texture)
+{
+	if (s_cache.activeUnit == UNKNOWN)
+	{
+		// the unit has to be known to cache its binding
+		activeTexture(0);
+	}
+	unsigned int* cached = s_cache.texture(s_cache.activeUnit, target);
+	if (cached != nullptr && *cached == texture)
+	{
+#if GL_STATE_VALIDATE
+		checkTexture(s_cache.activeUnit, target, texture);
+#endif
+		return;
+	}
+	GLCall(glBindTexture(target, texture));
+	RenderStats::countTextureBind();
+	if (cached != nullptr)
+	{
+		*cached = texture;
+	}
+}
+
+void GLState::bindTextureUnit(unsigned int unit, GLenum target, unsigned int texture)
+{
+	unsigned int* cached = s_cache.texture(unit, target);
+	if (cached != nullptr && *cached == texture)
+	{
+#if GL_STATE_VALIDATE
+		checkTexture(unit, target, texture);
+#endif
+		return;
+	}
+	activeTexture(unit);
+	GLCall(glBindTexture(target, texture));
+	RenderStats::countTextureBind();
+	if (cached != nullptr)
+	{
+		*cached = texture;
+	}
+}
+
+unsigned int GLState::getBoundTexture(GLenum target)
+{
+	if (s_cache.activeUnit == UNKNOWN)
+	{
+		GLint active = 0;
+		GLCall(glGetIntegerv(GL_ACTIVE_TEXTURE, &active));
+		s_cache.activeUnit = (unsigned int)active - GL_TEXTURE0;
+	}
+	unsigned int* cached = s_cache.texture(s_cache.activeUnit, target);
+	if (cached != nullptr && *cached != UNKNOWN)
+	{
+		return *cached;
+	}
+
+	GLint bound = 0;
+	GLCall(glGetIntegerv(textureBindingQuery(target), &bound));
+	if (cached != nullptr)
+	{
+		*cached = (unsigned int)bound;
+	}
+	return (unsigned int)bound;
+}
+
+void GLState::forgetProgram(unsigned int program)
+{
+	// a deleted program stays in use until another one is: only the name must not be trusted anymore
+	if (program != 0 && s_cache.program == program)
+	{
+		s_cache.program = UNKNOWN;
+	}
+}
+
+void GLState::forgetVertexArray(unsigned int vertexArray)
+{
+	if (vertexArray != 0 && s_cache.vertexArray == vertexArray)
+	{
+		s_cache.vertexArray = 0;
+	}
+}
+
+void GLState::forgetFramebuffer(unsigned int framebuffer)
+{
+	if (framebuffer == 0)
+	{
+		return;
+	}
+	if (s_cache.drawFramebuffer == framebuffer)
+	{
+		s_cache.drawFramebuffer = 0;
+	}
+	if (s_cache.readFramebuffer == framebuffer)
+	{
+		s_cache.readFramebuffer = 0;
+	}
+}
+
+void GLState::forgetTexture(unsigned int texture)
+{
+	if (texture == 0)
+	{
+		return;
+	}
+	for (unsigned int u = 0; u < MAX_TEXTURE_UNITS; u++)
+	{
+		if (s_cache.texture2D[u] == texture)
+		{
+			s_cache.texture2D[u] = 0;
+		}
+		if (s_cache.textureCube[u] == texture)
+		{
+			s_cache.textureCube[u] = 0;
+		}
+	}
+}
+
+void GLState::invalidate()
+{
+	s_cache.reset();
+}
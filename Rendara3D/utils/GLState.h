@@ -0,0 +1,67 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "ErrorHandling.h"
+
+// In validation mode every call skipped by the cache first checks that OpenGL really is in the cached
+// state (with glGet, so it is slow). On by default in debug builds; define GL_STATE_VALIDATE to 0 or 1 to choose.
+#ifndef GL_STATE_VALIDATE
+#ifdef _DEBUG
+#define GL_STATE_VALIDATE 1
+#else
+#define GL_STATE_VALIDATE 0
+#endif
+#endif
+
+
+//! Cache of the OpenGL state that the engine changes most often.
+/*!
+	Keeps the current program, vertex array, draw/read framebuffers, viewport, the GL_CULL_FACE, GL_DEPTH_TEST
+	and GL_BLEND switches, cull face and depth function, the active texture unit and the 2D and cube map
+	textures bound to the first MAX_TEXTURE_UNITS units. A call that would not change the state does not
+	reach OpenGL, and the bound textures are read from the cache instead of glGetIntegerv.
+	The program, texture and framebuffer binds that reach OpenGL are counted in RenderStats.
+	Shader, VertexArray, Texture, FrameBuffer and Window go through it: any other code that changes this state
+	must go through it too, otherwise the cache is out of date (call invalidate after such code).
+	The objects must call the forget methods when they delete their OpenGL object, since OpenGL unbinds it.
+	There is one cache for the one context of the engine; it must be used from the thread owning the context.
+*/
+class GLState
+{
+public:
+	//!< Texture units whose bindings are cached. Binding on the other units always calls OpenGL.
+	static const unsigned int MAX_TEXTURE_UNITS = 16;
+
+	static void useProgram(unsigned int program);
+	static void bindVertexArray(unsigned int vertexArray);
+	//!< target is GL_FRAMEBUFFER (draw and read), GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER.
+	static void bindFramebuffer(GLenum target, unsigned int framebuffer);
+	static void viewport(int x, int y, int width, int height);
+
+	//!< glEnable / glDisable. Only GL_CULL_FACE, GL_DEPTH_TEST and GL_BLEND are cached.
+	static void setEnabled(GLenum capability, bool enabled);
+	static void enable(GLenum capability)  { setEnabled(capability, true); }
+	static void disable(GLenum capability) { setEnabled(capability, false); }
+	static void cullFace(GLenum mode);
+	static void depthFunc(GLenum func);
+
+	//!< unit is the index of the unit (0 for GL_TEXTURE0).
+	static void activeTexture(unsigned int unit);
+	//!< Binds to the active unit. Only GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP are cached.
+	static void bindTexture(GLenum target, unsigned int texture);
+	//!< Binds to the unit, changing the active unit only if the texture is not already bound there.
+	static void bindTextureUnit(unsigned int unit, GLenum target, unsigned int texture);
+	//!< Texture bound to the target of the active unit. Asks OpenGL only if the cache does not know it.
+	static unsigned int getBoundTexture(GLenum target);
+
+	//!< To call after deleting the object: OpenGL unbinds it, and its name may be given to a new object.
+	static void forgetProgram(unsigned int program);
+	static void forgetVertexArray(unsigned int vertexArray);
+	static void forgetFramebuffer(unsigned int framebuffer);
+	static void forgetTexture(unsigned int texture);
+
+	//!< Forgets everything: the next call of each kind reaches OpenGL. For a new context, or after raw OpenGL code.
+	static void invalidate();
+};
@@ -0,0 +1,266 @@
+#include "GpuProfiler.h"
+#include "../Renderer/RenderStats.h"
+
+/* stl */
+#include <iomanip>
+#include <algorithm>
+
+
+namespace {
+
+	const std::string FRAME_SCOPE = "frame";
+
+}
+
+
+GpuProfiler::GpuProfiler() : m_enabled(false), m_inFrame(false), m_frame(0), m_droppedFrames(0)
+{
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	// the shared profiler is destroyed at exit, when the context may already be gone with its queries
+	if (glfwGetCurrentContext() != nullptr)
+	{
+		release();
+	}
+}
+
+void GpuProfiler::beginFrame()
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+	if (m_inFrame)
+	{
+		endFrame();
+	}
+
+	FrameQueries& frame = m_frames[m_frame % LATENCY];
+	if (frame.pending)
+	{
+		collect(frame);
+	}
+	frame.used = 0;
+	frame.records.clear();
+	m_openRecords.clear();
+
+	m_inFrame = true;
+	beginScope(FRAME_SCOPE);
+}
+
+void GpuProfiler::endFrame()
+{
+	if (!m_inFrame)
+	{
+		return;
+	}
+	// closes the scopes left open, "frame" included
+	while (!m_openRecords.empty())
+	{
+		endScope();
+	}
+	m_frames[m_frame % LATENCY].pending = true;
+	m_inFrame = false;
+	m_frame++;
+}
+
+void GpuProfiler::beginScope(const std::string& name)
+{
+	// the scopes are the passes of RenderStats too, measured or not
+	RenderStats::beginPass(name);
+	if (!m_inFrame)
+	{
+		return;
+	}
+	FrameQueries& frame = m_frames[m_frame % LATENCY];
+	Record record;
+	record.pass = passIndex(name, (int)m_openRecords.size());
+	record.beginQuery = issueTimestamp(frame);
+	record.endQuery = record.beginQuery;
+	m_openRecords.push_back(frame.records.size());
+	frame.records.push_back(record);
+}
+
+void GpuProfiler::endScope()
+{
+	RenderStats::endPass();
+	if (!m_inFrame || m_openRecords.empty())
+	{
+		return;
+	}
+	FrameQueries& frame = m_frames[m_frame % LATENCY];
+	frame.records.at(m_openRecords.back()).endQuery = issueTimestamp(frame);
+	m_openRecords.pop_back();
+}
+
+size_t GpuProfiler::passIndex(const std::string& name, int depth)
+{
+	auto it = m_passIndex.find(name);
+	if (it != m_passIndex.end())
+	{
+		return it->second;
+	}
+	PassStatistics pass;
+	pass.name = name;
+	pass.depth = depth;
+	m_passes.push_back(pass);
+	m_passIndex[name] = m_passes.size() - 1;
+	return m_passes.size() - 1;
+}
+
+size_t GpuProfiler::issueTimestamp(FrameQueries& frame)
+{
+	if (frame.used == frame.queries.size())
+	{
+		GLuint query = 0;
+		GLCall(glGenQueries(1, &query));
+		frame.queries.push_back(query);
+	}
+	GLCall(glQueryCounter(frame.queries.at(frame.used), GL_TIMESTAMP));
+	return frame.used++;
+}
+
+void GpuProfiler::collect(FrameQueries& frame)
+{
+	frame.pending = false;
+	if (frame.used == 0)
+	{
+		return;
+	}
+
+	// the timestamps are written in order: when the last one is there, all of them are
+	GLint available = 0;
+	GLCall(glGetQueryObjectiv(frame.queries.at(frame.used - 1), GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+	{
+		m_droppedFrames++;
+		return;
+	}
+
+	for (size_t i = 0; i < frame.records.size(); i++)
+	{
+		const Record& record = frame.records.at(i);
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+		GLCall(glGetQueryObjectui64v(frame.queries.at(record.beginQuery), GL_QUERY_RESULT, &begin));
+		GLCall(glGetQueryObjectui64v(frame.queries.at(record.endQuery), GL_QUERY_RESULT, &end));
+
+		PassStatistics& pass = m_passes.at(record.pass);
+		pass.frameSum += (end > begin) ? (end - begin) / 1.0e6 : 0.0;
+		pass.inFrame = true;
+	}
+
+	for (size_t p = 0; p < m_passes.size(); p++)
+	{
+		PassStatistics& pass = m_passes.at(p);
+		if (!pass.inFrame)
+		{
+			continue;
+		}
+		if (pass.samples.size() < STATISTICS_FRAMES)
+		{
+			pass.samples.push_back(pass.frameSum);
+		}
+		else
+		{
+			pass.samples.at(pass.next) = pass.frameSum;
+		}
+		pass.next = (pass.next + 1) % STATISTICS_FRAMES;
+		pass.last = pass.frameSum;
+		pass.frameSum = 0.0;
+		pass.inFrame = false;
+	}
+}
+
+std::vector<GpuPassTiming> GpuProfiler::getTimings() const
+{
+	std::vector<GpuPassTiming> timings;
+	for (size_t p = 0; p < m_passes.size(); p++)
+	{
+		const PassStatistics& pass = m_passes.at(p);
+		GpuPassTiming timing;
+		timing.name = pass.name;
+		timing.depth = pass.depth;
+		timing.lastMs = pass.last;
+		timing.samples = pass.samples.size();
+		timing.averageMs = 0.0;
+		timing.minMs = 0.0;
+		timing.maxMs = 0.0;
+		if (!pass.samples.empty())
+		{
+			double sum = 0.0;
+			for (double sample : pass.samples)
+			{
+				sum += sample;
+			}
+			timing.averageMs = sum / pass.samples.size();
+			timing.minMs = *std::min_element(pass.samples.begin(), pass.samples.end());
+			timing.maxMs = *std::max_element(pass.samples.begin(), pass.samples.end());
+		}
+		timings.push_back(timing);
+	}
+	return timings;
+}
+
+void GpuProfiler::dump(std::ostream& out) const
+{
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << "[GPU profiler] last " << STATISTICS_FRAMES << " frames, in ms (dropped frames: " << m_droppedFrames << ")" << std::endl;
+	out << "  " << std::left << std::setw(28) << "scope" << std::right << std::setw(10) << "average"
+		<< std::setw(10) << "min" << std::setw(10) << "max" << std::setw(10) << "last" << std::endl;
+	out << std::fixed << std::setprecision(3);
+	std::vector<GpuPassTiming> timings = getTimings();
+	for (const GpuPassTiming& timing : timings)
+	{
+		std::string name = std::string(2 * timing.depth, ' ') + timing.name;
+		out << "  " << std::left << std::setw(28) << name << std::right << std::setw(10) << timing.averageMs
+			<< std::setw(10) << timing.minMs << std::setw(10) << timing.maxMs << std::setw(10) << timing.lastMs << std::endl;
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+void GpuProfiler::reset()
+{
+	for (size_t p = 0; p < m_passes.size(); p++)
+	{
+		m_passes.at(p).samples.clear();
+		m_passes.at(p).next = 0;
+		m_passes.at(p).last = 0.0;
+		m_passes.at(p).frameSum = 0.0;
+		m_passes.at(p).inFrame = false;
+	}
+	for (size_t f = 0; f < LATENCY; f++)
+	{
+		m_frames[f].pending = false;
+		m_frames[f].used = 0;
+		m_frames[f].records.clear();
+	}
+	// a frame left open is dropped: its scopes end without measuring
+	m_openRecords.clear();
+	m_inFrame = false;
+	m_droppedFrames = 0;
+}
+
+GpuProfiler& GpuProfiler::shared()
+{
+	static GpuProfiler profiler;
+	return profiler;
+}
+
+void GpuProfiler::release()
+{
+	for (size_t f = 0; f < LATENCY; f++)
+	{
+		if (!m_frames[f].queries.empty())
+		{
+			GLCall(glDeleteQueries((GLsizei)m_frames[f].queries.size(), m_frames[f].queries.data()));
+		}
+		m_frames[f].queries.clear();
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+/* stl */
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+
+#include "ErrorHandling.h"
+
+
+//! GPU time of a named pass, over the last frames measured.
+struct GpuPassTiming
+{
+	std::string name;
+	int         depth;      // 0 for the whole frame, 1 for the passes in it...
+	double      lastMs;
+	double      averageMs;
+	double      minMs;
+	double      maxMs;
+	size_t      samples;    // frames in the statistics
+};
+
+//! Measures the GPU time of named scopes with GL_TIMESTAMP queries.
+/*!
+	The results are read back LATENCY frames later, so measuring never stalls the pipeline. Disabled, all the calls
+	return immediately. It must be used from the thread owning the OpenGL context.
+*/
+class GpuProfiler
+{
+public:
+	static const size_t LATENCY = 4;
+	static const size_t STATISTICS_FRAMES = 120;
+
+	GpuProfiler();
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	void setEnabled(bool enabled) { m_enabled = enabled; }
+	bool isEnabled() const        { return m_enabled; }
+
+	//!< Reads the results of LATENCY frames ago and starts measuring a new frame, in the scope "frame".
+	//!< A frame whose results are not ready yet is dropped (see getDroppedFrames) rather than waited for.
+	void beginFrame();
+	void endFrame();
+
+	//!< Puts a timestamp query in the command stream at each end of the scope. Scopes can be nested.
+	void beginScope(const std::string& name);
+	void endScope();
+
+	//!< Statistics of every scope measured so far, in the order they first appeared. The scopes with the same
+	//!< name are summed over the frame, over the last STATISTICS_FRAMES frames.
+	std::vector<GpuPassTiming> getTimings() const;
+	//!< Frames whose results were not ready after LATENCY frames.
+	size_t getDroppedFrames() const { return m_droppedFrames; }
+	//!< Writes a table of the timings.
+	void dump(std::ostream& out) const;
+	//!< Forgets the statistics (the scope names stay), and the frame being measured if any.
+	void reset();
+
+	//!< Profiler used by the engine (shadow maps, demo levels), disabled until setEnabled(true).
+	static GpuProfiler& shared();
+
+private:
+	struct Record
+	{
+		size_t pass;
+		size_t beginQuery;
+		size_t endQuery;
+	};
+
+	struct FrameQueries
+	{
+		std::vector<GLuint> queries;
+		size_t              used = 0;
+		std::vector<Record> records;
+		bool                pending = false;
+	};
+
+	struct PassStatistics
+	{
+		std::string         name;
+		int                 depth;
+		std::vector<double> samples;  // ring of the last STATISTICS_FRAMES frames, in ms
+		size_t              next = 0;
+		double              last = 0.0;
+		double              frameSum = 0.0;
+		bool                inFrame = false;
+	};
+
+	bool                                    m_enabled;
+	bool                                    m_inFrame;
+	size_t                                  m_frame;
+	size_t                                  m_droppedFrames;
+	FrameQueries                            m_frames[LATENCY];
+	std::vector<size_t>                     m_openRecords;
+	std::vector<PassStatistics>             m_passes;
+	std::unordered_map<std::string, size_t> m_passIndex;
+
+	size_t passIndex(const std::string& name, int depth);
+	size_t issueTimestamp(FrameQueries& frame);
+	void   collect(FrameQueries& frame);
+	void   release();
+};
+
+
+//! Scope of the shared GpuProfiler, ended at the end of the C++ scope.
+class GpuScope
+{
+public:
+	explicit GpuScope(const std::string& name) { GpuProfiler::shared().beginScope(name); }
+	~GpuScope() { GpuProfiler::shared().endScope(); }
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+};
@@ -0,0 +1,229 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+
+namespace memory {
+
+	//! Reference to an element of a SlotMap (or of a HandleTable) that survives the deletion of the other elements.
+	/*!
+		index is the slot of the element, generation counts how many times the slot was reused: a handle to a
+		deleted element stays invalid even after its slot is given to a new element.
+	*/
+	struct Handle
+	{
+		uint32_t index;
+		uint32_t generation;
+
+		bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Handle& other) const { return !(*this == other); }
+	};
+
+	//!< Handle that never refers to an element.
+	const Handle INVALID_HANDLE = Handle{ 0xFFFFFFFFu, 0 };
+
+
+	//! Maps handles to the positions of elements kept densely packed with swap-remove (as in SwapArray).
+	/*!
+		The table only tracks positions: the owner keeps one or more arrays where the element of a handle sits
+		at indexOf(handle). insert always gives the position size() - 1, and erase moves the last element into
+		the hole, exactly like SwapArray::deleteElement, so the arrays of the owner follow the same swaps.
+		All the operations are O(1). Free slots are reused in FIFO order, to spread the generations.
+	*/
+	class HandleTable
+	{
+	public:
+		HandleTable(size_t maxElements) : m_slots(maxElements), m_denseToSlot(maxElements), m_size(0)
+		{
+			for (size_t s = 0; s < maxElements; s++)
+			{
+				m_slots[s].dense = (uint32_t)(s + 1); // next free slot
+				m_slots[s].generation = 0;
+			}
+			m_freeHead = 0;
+			m_freeTail = maxElements > 0 ? (uint32_t)(maxElements - 1) : 0;
+		}
+
+		size_t size() const     { return m_size; }
+		size_t capacity() const { return m_slots.size(); }
+
+		//!< Adds free slots until capacity() >= maxElements. Handles and positions stay valid.
+		void reserve(size_t maxElements)
+		{
+			size_t previous = m_slots.size();
+			if (maxElements <= previous)
+			{
+				return;
+			}
+			m_slots.resize(maxElements);
+			m_denseToSlot.resize(maxElements);
+			for (size_t s = previous; s < maxElements; s++)
+			{
+				m_slots[s].dense = (uint32_t)(s + 1); // next free slot
+				m_slots[s].generation = 0;
+			}
+			// the new slots go at the back of the free list
+			if (m_size == previous)
+			{
+				m_freeHead = (uint32_t)previous; // the list was empty
+			}
+			else
+			{
+				m_slots[m_freeTail].dense = (uint32_t)previous;
+			}
+			m_freeTail = (uint32_t)(maxElements - 1);
+		}
+
+		//!< Handle of a new element, placed at position size() - 1.
+		Handle insert()
+		{
+			if (m_size >= m_slots.size())
+			{
+				throw std::out_of_range("System: maximum limit of elements in the system exceeded.");
+			}
+			uint32_t slot = m_freeHead;
+			m_freeHead = m_slots[slot].dense;
+
+			m_slots[slot].dense = (uint32_t)m_size;
+			m_denseToSlot[m_size] = slot;
+			m_size++;
+			return Handle{ slot, m_slots[slot].generation };
+		}
+
+		bool contains(Handle handle) const
+		{
+			return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation
+				&& m_slots[handle.index].dense < m_size && m_denseToSlot[m_slots[handle.index].dense] == handle.index;
+		}
+
+		//!< Position of the element of handle. The handle must be valid (see contains).
+		size_t indexOf(Handle handle) const
+		{
+			if (!contains(handle))
+			{
+				throw std::out_of_range("System: handle refers to a deleted element.");
+			}
+			return m_slots[handle.index].dense;
+		}
+
+		//!< Handle of the element at position index.
+		Handle handleAt(size_t index) const
+		{
+			uint32_t slot = m_denseToSlot[index];
+			return Handle{ slot, m_slots[slot].generation };
+		}
+
+		//!< Forgets the element at position index; the last element takes its position.
+		void eraseAt(size_t index)
+		{
+			if (index >= m_size)
+			{
+				throw std::out_of_range("System: element requested is not active.");
+			}
+			uint32_t slot = m_denseToSlot[index];
+			m_size--;
+
+			// the last element moves into the hole
+			uint32_t lastSlot = m_denseToSlot[m_size];
+			m_denseToSlot[index] = lastSlot;
+			m_slots[lastSlot].dense = (uint32_t)index;
+
+			// the slot goes at the back of the free list, with a new generation
+			m_slots[slot].generation++;
+			m_slots[slot].dense = (uint32_t)m_slots.size();
+			if (m_size + 1 == m_slots.size())
+			{
+				m_freeHead = slot; // the list was empty
+			}
+			else
+			{
+				m_slots[m_freeTail].dense = slot;
+			}
+			m_freeTail = slot;
+		}
+
+	private:
+		struct Slot
+		{
+			uint32_t dense;      // position of the element, or next free slot
+			uint32_t generation;
+		};
+
+		std::vector<Slot>     m_slots;
+		std::vector<uint32_t> m_denseToSlot;
+		size_t                m_size;
+		uint32_t              m_freeHead;
+		uint32_t              m_freeTail;
+	};
+
+
+	//! SwapArray whose elements can also be reached through generational handles.
+	/*!
+		The elements are contiguous (data() can be uploaded as it is), and deleting one moves the last element
+		into its place: positions change, handles do not.
+	*/
+	template <class Element>
+	class SlotMap
+	{
+	public:
+		SlotMap(size_t maxElements) : m_handles(maxElements)
+		{
+			m_elements.resize(maxElements);
+		}
+
+		size_t size() const     { return m_handles.size(); }
+		size_t capacity() const { return m_handles.capacity(); }
+
+		Handle insert(const Element& element)
+		{
+			Handle handle = m_handles.insert();
+			m_elements[m_handles.size() - 1] = element;
+			return handle;
+		}
+
+		bool contains(Handle handle) const { return m_handles.contains(handle); }
+
+		//!< Element of handle, or nullptr if it was deleted.
+		Element* get(Handle handle)
+		{
+			return m_handles.contains(handle) ? &m_elements[m_handles.indexOf(handle)] : nullptr;
+		}
+
+		const Element* get(Handle handle) const
+		{
+			return m_handles.contains(handle) ? &m_elements[m_handles.indexOf(handle)] : nullptr;
+		}
+
+		//!< Deletes the element of handle; returns false if it was already deleted.
+		bool erase(Handle handle)
+		{
+			if (!m_handles.contains(handle))
+			{
+				return false;
+			}
+			eraseAt(m_handles.indexOf(handle));
+			return true;
+		}
+
+		void eraseAt(size_t index)
+		{
+			m_handles.eraseAt(index);
+			std::swap(m_elements[index], m_elements[m_handles.size()]);
+		}
+
+		// dense access, positions in [0, size())
+		Element&       at(size_t index)       { return m_elements[index]; }
+		const Element& at(size_t index) const { return m_elements[index]; }
+		Handle         handleAt(size_t index) const { return m_handles.handleAt(index); }
+		Element*       data()                 { return m_elements.data(); }
+		const Element* data() const           { return m_elements.data(); }
+
+	private:
+		HandleTable          m_handles;
+		std::vector<Element> m_elements;
+	};
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+/* stl */
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+
+//! N copies of a state handed from a producer thread (the simulation) to a consumer thread (the renderer).
+/*!
+	With N = 2 the two threads run in lockstep, the producer writing frame N+1 while the consumer reads frame N.
+	With N = 3 the producer never waits, and the consumer gets the latest state. A slot is never written while it is read.
+*/
+template <class T, size_t N = 2>
+class SnapshotBuffer
+{
+	static_assert(N >= 2, "SnapshotBuffer needs a slot to write while another one is read");
+
+public:
+	SnapshotBuffer() { reset(); }
+
+	SnapshotBuffer(const SnapshotBuffer&) = delete;
+	SnapshotBuffer& operator=(const SnapshotBuffer&) = delete;
+
+	//!< Slot to fill, waiting for one to be free (with N = 2, until the consumer took the previous state). nullptr
+	//!< if the buffer was closed. The slots are reused as they are: clear their containers rather than replace them.
+	T* beginWrite()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		size_t slot = NONE;
+		// with two slots, a published state is never replaced: wait for the consumer to take it
+		m_changed.wait(lock, [this, &slot]()
+		{
+			slot = findFree();
+			return m_closed || (slot != NONE && (N > 2 || m_ready == NONE));
+		});
+		if (m_closed)
+		{
+			return nullptr;
+		}
+		m_states[slot] = WRITING;
+		m_writing = slot;
+		return &m_slots[slot];
+	}
+
+	//!< Hands the slot of beginWrite to the consumer. A published state not taken yet is dropped (only with N > 2).
+	void publish()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_ready != NONE)
+		{
+			m_states[m_ready] = FREE;
+			m_dropped++;
+		}
+		m_states[m_writing] = READY;
+		m_ready = m_writing;
+		m_writing = NONE;
+		m_changed.notify_all();
+	}
+
+	//!< Latest published state, waiting for one. nullptr once the buffer is closed and nothing is left to read.
+	const T* acquire()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_changed.wait(lock, [this]() { return m_closed || m_ready != NONE; });
+		if (m_ready == NONE)
+		{
+			return nullptr;
+		}
+		m_states[m_ready] = READING;
+		m_reading = m_ready;
+		m_ready = NONE;
+		m_changed.notify_all();
+		return &m_slots[m_reading];
+	}
+
+	//!< Gives back the slot of acquire.
+	void release()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_states[m_reading] = FREE;
+		m_reading = NONE;
+		m_changed.notify_all();
+	}
+
+	//!< Wakes up both threads: beginWrite then returns nullptr, and acquire once the last published state was taken.
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_closed = true;
+		m_changed.notify_all();
+	}
+
+	//!< Opens the buffer again. Neither thread may be using it.
+	void reset()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (size_t i = 0; i < N; i++)
+		{
+			m_states[i] = FREE;
+		}
+		m_writing = m_ready = m_reading = NONE;
+		m_closed = false;
+		m_dropped = 0;
+	}
+
+	//!< Number of published states replaced before the consumer took them, since the last reset.
+	size_t getNumDropped() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_dropped;
+	}
+
+private:
+	enum SlotState { FREE, WRITING, READY, READING };
+	static const size_t NONE = (size_t)-1;
+
+	T                       m_slots[N];
+	SlotState               m_states[N];
+	size_t                  m_writing;
+	size_t                  m_ready;
+	size_t                  m_reading;
+	bool                    m_closed;
+	size_t                  m_dropped;
+	mutable std::mutex      m_mutex;
+	std::condition_variable m_changed;  // a slot was freed, published or taken, or the buffer was closed
+
+	size_t findFree() const
+	{
+		for (size_t i = 0; i < N; i++)
+		{
+			if (m_states[i] == FREE)
+			{
+				return i;
+			}
+		}
+		return NONE;
+	}
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <new>
+#include <stdexcept>
+#include <cstdint>
+
+
+namespace memory {
+
+	//! Structure of arrays with the swap-remove semantics of SwapArray, that grows in chunks.
+	/*!
+		Each Ts is a column. The elements live in chunks of CHUNK_SIZE elements; a chunk stores the columns one
+		after the other, every column starting on a ALIGNMENT (64) byte boundary, so that SIMD code can run over
+		column<C>(chunk) with aligned loads.
+		Growing adds a chunk and never moves the existing ones: references and column pointers stay valid while
+		the array grows (e.g. during a frame), and only deleteElement changes what sits at a position.
+		get<C>(i) is unchecked (the hot path); at<C>(i) checks the index and throws std::out_of_range as
+		SwapArray does.
+	*/
+	template <class... Ts>
+	class SoASwapArray
+	{
+		static_assert(sizeof...(Ts) > 0, "SoASwapArray needs at least one column");
+
+	public:
+		static const size_t CHUNK_SIZE  = 1024; // elements per chunk, a power of two
+		static const size_t ALIGNMENT   = 64;   // of every column, one cache line (and an AVX-512 register)
+		static const size_t NUM_COLUMNS = sizeof...(Ts);
+
+		template <size_t C>
+		using Column = typename std::tuple_element<C, std::tuple<Ts...>>::type;
+
+		//!< reserved elements are allocated right away (rounded up to whole chunks).
+		explicit SoASwapArray(size_t reserved = 0) : m_size(0)
+		{
+			computeOffsets(std::index_sequence_for<Ts...>{});
+			reserve(reserved);
+		}
+
+		~SoASwapArray()
+		{
+			for (size_t c = 0; c < m_chunks.size(); c++)
+			{
+				freeChunk(m_chunks[c], std::index_sequence_for<Ts...>{});
+			}
+		}
+
+		SoASwapArray(const SoASwapArray&) = delete;
+		SoASwapArray& operator=(const SoASwapArray&) = delete;
+
+		size_t size() const      { return m_size; }
+		size_t capacity() const  { return m_chunks.size() * CHUNK_SIZE; }
+		size_t numChunks() const { return m_chunks.size(); }
+
+		//!< Adds chunks until capacity() >= elements.
+		void reserve(size_t elements)
+		{
+			while (capacity() < elements)
+			{
+				m_chunks.push_back(allocateChunk(std::index_sequence_for<Ts...>{}));
+			}
+		}
+
+		//!< Appends an element and returns its position.
+		size_t push_back(const Ts&... values)
+		{
+			reserve(m_size + 1);
+			setAll(m_size, std::index_sequence_for<Ts...>{}, values...);
+			return m_size++;
+		}
+
+		//!< Moves the last element into position index, as SwapArray::deleteElement.
+		void deleteElement(size_t index)
+		{
+			if (index >= m_size)
+			{
+				throw std::out_of_range("System: element requested is not active.");
+			}
+			m_size--;
+			if (index != m_size)
+			{
+				swapAll(index, m_size, std::index_sequence_for<Ts...>{});
+			}
+		}
+
+		//!< Forgets all the elements, keeping the chunks.
+		void clear() { m_size = 0; }
+
+		template <size_t C>
+		Column<C>& get(size_t index)
+		{
+			return column<C>(index / CHUNK_SIZE)[index % CHUNK_SIZE];
+		}
+
+		template <size_t C>
+		const Column<C>& get(size_t index) const
+		{
+			return column<C>(index / CHUNK_SIZE)[index % CHUNK_SIZE];
+		}
+
+		template <size_t C>
+		Column<C>& at(size_t index)
+		{
+			if (index >= m_size)
+			{
+				throw std::out_of_range("System: element requested is not active.");
+			}
+			return get<C>(index);
+		}
+
+		template <size_t C>
+		const Column<C>& at(size_t index) const
+		{
+			if (index >= m_size)
+			{
+				throw std::out_of_range("System: element requested is not active.");
+			}
+			return get<C>(index);
+		}
+
+		//!< Start of the column C of a chunk, ALIGNMENT-aligned. The chunk holds the positions [chunk * CHUNK_SIZE, ...).
+		template <size_t C>
+		Column<C>* column(size_t chunk)
+		{
+			return reinterpret_cast<Column<C>*>(m_chunks[chunk] + m_offsets[C]);
+		}
+
+		template <size_t C>
+		const Column<C>* column(size_t chunk) const
+		{
+			return reinterpret_cast<const Column<C>*>(m_chunks[chunk] + m_offsets[C]);
+		}
+
+		//!< Number of live elements in a chunk (CHUNK_SIZE but for the last ones).
+		size_t chunkSize(size_t chunk) const
+		{
+			size_t begin = chunk * CHUNK_SIZE;
+			return (begin >= m_size) ? 0 : ((m_size - begin < CHUNK_SIZE) ? m_size - begin : CHUNK_SIZE);
+		}
+
+		//!< Calls function(firstIndex, count, column pointers...) for each chunk holding live elements.
+		template <class Function>
+		void forEachChunk(Function function)
+		{
+			for (size_t c = 0; c * CHUNK_SIZE < m_size; c++)
+			{
+				callWithColumns(function, c, std::index_sequence_for<Ts...>{});
+			}
+		}
+
+	private:
+		// a chunk is one allocation: its first bytes hold the pointer returned by operator new, then the columns
+		struct Header { void* allocation; };
+
+		template <size_t... C>
+		void computeOffsets(std::index_sequence<C...>)
+		{
+			const size_t sizes[] = { sizeof(Ts)... };
+			size_t offset = 0;
+			for (size_t c = 0; c < NUM_COLUMNS; c++)
+			{
+				m_offsets[c] = offset;
+				offset = roundUp(offset + sizes[c] * CHUNK_SIZE, ALIGNMENT);
+			}
+			m_chunkBytes = offset;
+		}
+
+		template <size_t... C>
+		char* allocateChunk(std::index_sequence<C...>)
+		{
+			// enough room to align the columns and to remember the allocation just before them
+			void* allocation = ::operator new(m_chunkBytes + ALIGNMENT + sizeof(Header));
+			uintptr_t address = reinterpret_cast<uintptr_t>(allocation) + sizeof(Header);
+			char* chunk = reinterpret_cast<char*>(roundUp(address, ALIGNMENT));
+			reinterpret_cast<Header*>(chunk)[-1].allocation = allocation;
+
+			int expand[] = { 0, (constructColumn<C>(chunk), 0)... };
+			(void)expand;
+			return chunk;
+		}
+
+		template <size_t... C>
+		void freeChunk(char* chunk, std::index_sequence<C...>)
+		{
+			int expand[] = { 0, (destroyColumn<C>(chunk), 0)... };
+			(void)expand;
+			::operator delete(reinterpret_cast<Header*>(chunk)[-1].allocation);
+		}
+
+		template <size_t C>
+		void constructColumn(char* chunk)
+		{
+			Column<C>* column = reinterpret_cast<Column<C>*>(chunk + m_offsets[C]);
+			for (size_t i = 0; i < CHUNK_SIZE; i++)
+			{
+				new (column + i) Column<C>();
+			}
+		}
+
+		template <size_t C>
+		void destroyColumn(char* chunk)
+		{
+			typedef Column<C> Type;
+			Type* column = reinterpret_cast<Type*>(chunk + m_offsets[C]);
+			for (size_t i = 0; i < CHUNK_SIZE; i++)
+			{
+				column[i].~Type();
+			}
+		}
+
+		template <size_t... C>
+		void setAll(size_t index, std::index_sequence<C...>, const Ts&... values)
+		{
+			int expand[] = { 0, (get<C>(index) = values, 0)... };
+			(void)expand;
+		}
+
+		template <size_t... C>
+		void swapAll(size_t i, size_t j, std::index_sequence<C...>)
+		{
+			using std::swap;
+			int expand[] = { 0, (swap(get<C>(i), get<C>(j)), 0)... };
+			(void)expand;
+		}
+
+		template <class Function, size_t... C>
+		void callWithColumns(Function& function, size_t chunk, std::index_sequence<C...>)
+		{
+			function(chunk * CHUNK_SIZE, chunkSize(chunk), column<C>(chunk)...);
+		}
+
+		static size_t roundUp(size_t value, size_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		std::vector<char*> m_chunks;
+		size_t             m_offsets[NUM_COLUMNS];
+		size_t             m_chunkBytes;
+		size_t             m_size;
+	};
+
+}
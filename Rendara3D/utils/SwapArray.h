@@ -26,6 +26,12 @@ namespace memory {
 				return activeElements;
 			}
 
+			// get the maximum number of elements.
+			size_t capacity() const
+			{
+				return elements.size();
+			}
+
 			// get the element at position index.
 			Element& at(size_t index)
 			{
@@ -0,0 +1,119 @@
+#include "ThreadPool.h"
+#include "CpuProfiler.h"
+
+
+ThreadPool::ThreadPool(size_t numWorkers)
+{
+	if (numWorkers == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		numWorkers = (hardwareThreads > 1) ? hardwareThreads - 1 : 0;
+	}
+	for (size_t i = 0; i < numWorkers; i++)
+	{
+		m_workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+}
+
+ThreadPool& ThreadPool::shared()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& function)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (chunkSize == 0)
+	{
+		chunkSize = count;
+	}
+	size_t numChunks = (count + chunkSize - 1) / chunkSize;
+	if (numChunks == 1 || m_workers.empty())
+	{
+		for (size_t begin = 0; begin < count; begin += chunkSize)
+		{
+			function(begin, (count - begin < chunkSize) ? count : begin + chunkSize);
+		}
+		return;
+	}
+
+	{
+		// a worker woken late by the previous loop may still be looking at its (exhausted) counter
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this]() { return m_activeWorkers == 0; });
+		m_function  = &function;
+		m_count     = count;
+		m_chunkSize = chunkSize;
+		m_numChunks = numChunks;
+		m_nextChunk = 0;
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	runChunks();
+
+	// the chunks are all taken: wait for the workers still running one
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this]() { return m_activeWorkers == 0; });
+	m_function = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+	CpuProfiler::setThreadName("ThreadPool worker");
+	size_t seenGeneration = 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_wake.wait(lock, [this, seenGeneration]() { return m_stop || m_generation != seenGeneration; });
+		if (m_stop)
+		{
+			return;
+		}
+		seenGeneration = m_generation;
+		m_activeWorkers++;
+
+		lock.unlock();
+		runChunks();
+		lock.lock();
+
+		m_activeWorkers--;
+		if (m_activeWorkers == 0)
+		{
+			m_done.notify_all();
+		}
+	}
+}
+
+void ThreadPool::runChunks()
+{
+	for (;;)
+	{
+		size_t chunk = m_nextChunk.fetch_add(1);
+		if (chunk >= m_numChunks)
+		{
+			return;
+		}
+		size_t begin = chunk * m_chunkSize;
+		size_t end = (m_count - begin < m_chunkSize) ? m_count : begin + m_chunkSize;
+		CPU_PROFILE_SCOPE("ThreadPool chunk");
+		(*m_function)(begin, end);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+/* stl */
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+
+//! Fixed set of worker threads that run the chunks of a parallel loop.
+/*!
+	parallelFor splits [0, count) in chunks of chunkSize elements and returns once all of them were
+	processed. The calling thread takes chunks too, so a pool with no workers simply runs the loop.
+	The chunks are handed out one at a time from an atomic counter, which balances uneven chunks.
+	parallelFor is meant to be called from one thread at a time (the main loop), and the function must
+	not throw.
+*/
+class ThreadPool
+{
+public:
+	//!< numWorkers = 0 uses one worker less than the hardware threads (the caller is the last one).
+	explicit ThreadPool(size_t numWorkers = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//!< Number of threads that run the chunks, the caller included.
+	size_t getNumThreads() const { return m_workers.size() + 1; }
+
+	//!< Calls function(begin, end) for each chunk [begin, end) of [0, count), in parallel.
+	void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& function);
+
+	//!< Pool shared by the engine, created at the first use.
+	static ThreadPool& shared();
+
+private:
+	void workerLoop();
+	void runChunks();
+
+	std::vector<std::thread> m_workers;
+	std::mutex               m_mutex;
+	std::condition_variable  m_wake;   // a new loop was started (or the pool stops)
+	std::condition_variable  m_done;   // the last active worker left the loop
+	size_t                   m_generation = 0;
+	size_t                   m_activeWorkers = 0;
+	bool                     m_stop = false;
+
+	// current loop, written under the mutex before m_generation changes
+	const std::function<void(size_t, size_t)>* m_function = nullptr;
+	size_t                   m_count = 0;
+	size_t                   m_chunkSize = 0;
+	size_t                   m_numChunks = 0;
+	std::atomic<size_t>      m_nextChunk{ 0 };
+};